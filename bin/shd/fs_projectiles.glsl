@@ -0,0 +1,11 @@
+#version 430
+
+layout(location=0) out vec4 out_Color;
+
+uniform vec4 Color;
+
+void main()
+{
+	// Emissive, projectiles are not lit
+	out_Color = Color;
+}
@@ -0,0 +1,45 @@
+#version 430
+
+layout(location=0) in vec3 in_Position;
+
+struct Projectile
+{
+	vec3 origin;
+	uint startTick;
+	vec3 velocity; // units per tick
+	uint endTick;
+};
+
+layout(std430, binding = 0) readonly buffer ProjectileBuffer
+{
+	Projectile data[];
+} projectileBuffer;
+
+uniform mat4 ViewProjection;
+uniform uint Tick;
+uniform float TickFraction;
+
+void main()
+{
+	Projectile projectile = projectileBuffer.data[gl_InstanceID];
+
+	// Expired (the despawn is still on its way), or not launched yet
+	if (int(Tick - projectile.endTick) >= 0 || int(Tick - projectile.startTick) < 0)
+	{
+		gl_Position = vec4(0, 0, 0, 0);
+		return;
+	}
+
+	// Straight flight from the origin, same as ClientLaser::PositionAt
+	float elapsed = float(int(Tick - projectile.startTick)) + TickFraction;
+	vec3 position = projectile.origin + projectile.velocity * elapsed;
+
+	// Mesh +Z along the flight direction (roll does not matter for a bolt)
+	vec3 forward = normalize(projectile.velocity);
+	vec3 up = abs(forward.y) < 0.99f ? vec3(0, 1, 0) : vec3(1, 0, 0);
+	vec3 right = normalize(cross(up, forward));
+	up = cross(forward, right);
+
+	vec3 wPos = position + mat3(right, up, forward) * in_Position;
+	gl_Position = ViewProjection * vec4(wPos, 1.0f);
+}
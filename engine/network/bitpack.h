@@ -0,0 +1,320 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <vec3.hpp>
+#include "gtc/quaternion.hpp"
+
+/*
+* BIT PACKED WIRE FORMAT
+*	- ONLY FOR THE HOT MESSAGES (INPUT AND SHIP UPDATES), EVERYTHING ELSE STAYS FLATBUFFERS
+*	- EVERY DESCRIPTOR ALSO COMPARES TWO VALUES THE WAY THE RECEIVER SEES THEM (Same), REPLICATION BUILDS ITS DIRTY BITS ON THAT
+*	- LAYOUTS ARE DESCRIBED AT COMPILE TIME (FIELD RANGE -> BIT COUNT), NO VTABLES / OFFSETS / PADDING ON THE WIRE
+*	- NEGOTIATED ON CONNECT: THE CLIENT OPENS THE EXTRA ENET CHANNEL, THE SERVER CONFIRMS IN ClientConnectS2C.wire_format
+*	- BIT PACKED MESSAGES TRAVEL ON THEIR OWN CHANNEL SO THE RECEIVER NEVER HAS TO GUESS THE FORMAT
+*	- FLATBUFFERS THE SHIP UPDATES DEPEND ON SHARE THAT CHANNEL BEHIND A TYPE BYTE (Embedded), THE RECEIVER STILL NEVER GUESSES
+*/
+
+namespace BitPack
+{
+
+enum WireFormat : uint8_t
+{
+    WireFormat_FlatBuffers = 0,
+    WireFormat_BitPacked = 1
+};
+
+constexpr uint8_t Channel = 1; //ENet channel of the bit packed messages (0 stays FlatBuffers)
+constexpr uint8_t ChannelCount = 2; //Channels a client opens to offer the bit packed format
+
+//Bits needed to hold every value in [0, maxValue]
+constexpr uint32_t BitsFor(uint64_t maxValue)
+{
+    uint32_t bits = 0;
+    while (maxValue) { bits++; maxValue >>= 1; }
+    return bits;
+}
+
+// ==========================
+// Bit writer / reader (LSB first, little endian words like the rest of the wire format)
+// ==========================
+static_assert(std::endian::native == std::endian::little, "BitPack reads and writes little endian words");
+
+class BitWriter
+{
+public:
+    //Bits collect in a 64 bit accumulator that is stored (never loaded back) after every write
+    void Write(uint64_t value, uint32_t bits)
+    {
+        if (bits > 32)
+        {
+            Write(value & 0xFFFFFFFFu, 32);
+            Write(value >> 32, bits - 32);
+            return;
+        }
+        scratch |= (value & ((uint64_t(1) << bits) - 1)) << scratchBits;
+        scratchBits += bits;
+
+        if (bytes.size() < wordOffset + 8) bytes.resize(wordOffset + 64);
+        std::memcpy(bytes.data() + wordOffset, &scratch, 8);
+        if (scratchBits >= 32)
+        {
+            wordOffset += 4;
+            scratch >>= 32;
+            scratchBits -= 32;
+        }
+    }
+    void Clear() { scratch = 0; scratchBits = 0; wordOffset = 0; }
+
+    const uint8_t* Data() const { return bytes.data(); }
+    size_t Size() const { return wordOffset + ((scratchBits + 7) >> 3); }
+
+private:
+    std::vector<uint8_t> bytes;
+    uint64_t scratch = 0;
+    uint32_t scratchBits = 0;
+    size_t wordOffset = 0; //Byte offset of the accumulators low word
+};
+
+class BitReader
+{
+public:
+    BitReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    uint64_t Read(uint32_t bits)
+    {
+        if (bits > 32)
+        {
+            const uint64_t low = Read(32);
+            return low | (Read(bits - 32) << 32);
+        }
+        if (bitPosition + bits > size * 8)
+        {
+            overflow = true; //Truncated message, every read after this returns 0
+            return 0;
+        }
+
+        const size_t byteIndex = bitPosition >> 3;
+        uint64_t word = 0;
+        if (byteIndex + 8 <= size)
+            std::memcpy(&word, data + byteIndex, 8);
+        else
+            for (size_t i = byteIndex; i < size; i++) word |= uint64_t(data[i]) << ((i - byteIndex) * 8); //Tail, no reads past the packet
+        const uint64_t value = (word >> (bitPosition & 7)) & ((uint64_t(1) << bits) - 1);
+        bitPosition += bits;
+        return value;
+    }
+    bool Ok() const { return !overflow; }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t bitPosition = 0;
+    bool overflow = false;
+};
+
+// ==========================
+// Field descriptors
+// ==========================
+template<uint64_t MAX>
+struct UInt
+{
+    static constexpr uint32_t bits = BitsFor(MAX);
+    static bool Fits(uint64_t value) { return value <= MAX; }
+    static bool Same(uint64_t a, uint64_t b) { return a == b; }
+    static void Write(BitWriter& writer, uint64_t value) { writer.Write(value, bits); }
+    static uint64_t Read(BitReader& reader) { return reader.Read(bits); }
+};
+
+//Float quantized over [MIN, MAX] (whole units) with BITS bits
+template<int MIN, int MAX, uint32_t BITS>
+struct QFloat
+{
+    static_assert(MIN < MAX && BITS > 0 && BITS <= 32, "QFloat needs a range and 1..32 bits");
+    static constexpr uint32_t bits = BITS;
+    static constexpr uint64_t steps = (uint64_t(1) << BITS) - 1;
+    static constexpr float precision = float(MAX - MIN) / float(steps);
+    static constexpr float scale = float(steps) / float(MAX - MIN);
+
+    static bool Fits(float value) { return value >= float(MIN) && value <= float(MAX); }
+    static uint64_t Quantize(float value) { return uint64_t((std::clamp(value, float(MIN), float(MAX)) - float(MIN)) * scale + 0.5f); }
+    static bool Same(float a, float b) { return Quantize(a) == Quantize(b); } //Equal on the wire
+    static void Write(BitWriter& writer, float value) { writer.Write(Quantize(value), BITS); }
+    static float Read(BitReader& reader)
+    {
+        return float(MIN) + float(reader.Read(BITS)) * precision;
+    }
+};
+
+template<typename COMPONENT>
+struct QVec3
+{
+    static constexpr uint32_t bits = COMPONENT::bits * 3;
+    static bool Fits(const glm::vec3& v) { return COMPONENT::Fits(v.x) && COMPONENT::Fits(v.y) && COMPONENT::Fits(v.z); }
+    static bool Same(const glm::vec3& a, const glm::vec3& b)
+    {
+        return COMPONENT::Same(a.x, b.x) && COMPONENT::Same(a.y, b.y) && COMPONENT::Same(a.z, b.z);
+    }
+    static void Write(BitWriter& writer, const glm::vec3& v)
+    {
+        COMPONENT::Write(writer, v.x);
+        COMPONENT::Write(writer, v.y);
+        COMPONENT::Write(writer, v.z);
+    }
+    static glm::vec3 Read(BitReader& reader)
+    {
+        const float x = COMPONENT::Read(reader);
+        const float y = COMPONENT::Read(reader);
+        const float z = COMPONENT::Read(reader);
+        return glm::vec3(x, y, z);
+    }
+};
+
+//Unit quaternion as "smallest three": index of the largest component + the other three (they are within +-1/sqrt(2))
+template<uint32_t BITS>
+struct QQuat
+{
+    static constexpr uint32_t bits = 2 + BITS * 3;
+    static constexpr float limit = 0.70710678f;
+    static constexpr float scale = float((1u << BITS) - 1) / (2.0f * limit);
+    static constexpr float precision = (2.0f * limit) / float((1u << BITS) - 1);
+
+    static bool Fits(const glm::quat&) { return true; }
+    //All fields in one value, laid out like they are written (largest in the low 2 bits, then the three others)
+    static uint64_t Quantize(glm::quat q)
+    {
+        q = glm::normalize(q);
+        const float c[4] = { q.x, q.y, q.z, q.w };
+        uint32_t largest = 0;
+        for (uint32_t i = 1; i < 4; i++)
+            if (std::abs(c[i]) > std::abs(c[largest])) largest = i;
+        const float sign = c[largest] < 0.0f ? -1.0f : 1.0f; //q and -q are the same rotation, send the one with a positive largest
+
+        uint64_t packed = largest;
+        uint32_t shift = 2;
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            if (i == largest) continue;
+            packed |= uint64_t((std::clamp(c[i] * sign, -limit, limit) + limit) * scale + 0.5f) << shift;
+            shift += BITS;
+        }
+        return packed;
+    }
+    static bool Same(const glm::quat& a, const glm::quat& b) { return Quantize(a) == Quantize(b); }
+    static void Write(BitWriter& writer, const glm::quat& q) { writer.Write(Quantize(q), bits); }
+    static glm::quat Read(BitReader& reader)
+    {
+        const uint32_t largest = uint32_t(reader.Read(2));
+        float c[4];
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            if (i == largest) continue;
+            c[i] = float(reader.Read(BITS)) * precision - limit;
+            sum += c[i] * c[i];
+        }
+        c[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+        return glm::normalize(glm::quat(c[3], c[0], c[1], c[2]));
+    }
+};
+
+//Tick numbers are sent as their low 16 bits and rebuilt next to a reference tick the receiver already has
+struct TickStamp
+{
+    static constexpr uint32_t bits = 16;
+    static void Write(BitWriter& writer, uint32_t tick) { writer.Write(tick & 0xFFFFu, bits); }
+    static uint32_t Read(BitReader& reader, uint32_t referenceTick)
+    {
+        const uint16_t low = uint16_t(reader.Read(bits));
+        return referenceTick + int16_t(low - uint16_t(referenceTick)); //Closest tick within +-9 minutes (60hz) of the reference
+    }
+};
+
+//Ship ids carry their zone in the high byte (GameServer::InitZones) and a per zone counter in the low bits,
+//zone 0 (and unzoned servers) pay one bit for it
+struct ShipId
+{
+    using HasZone = UInt<1>;
+    using Zone = UInt<0xFF>;
+    using Local = UInt<0xFFFF>;
+
+    static bool Fits(uint32_t id) { return (id & 0x00FF0000u) == 0; }
+    static bool Same(uint32_t a, uint32_t b) { return a == b; }
+    static void Write(BitWriter& writer, uint32_t id)
+    {
+        const uint32_t zone = id >> 24;
+        HasZone::Write(writer, zone != 0);
+        if (zone != 0) Zone::Write(writer, zone);
+        Local::Write(writer, id & 0xFFFFu);
+    }
+    static uint32_t Read(BitReader& reader)
+    {
+        const uint32_t zone = HasZone::Read(reader) ? uint32_t(Zone::Read(reader)) : 0;
+        return (zone << 24) | uint32_t(Local::Read(reader));
+    }
+};
+
+// ==========================
+// Message layouts
+// ==========================
+enum MessageType : uint8_t
+{
+    MessageType_InputC2S = 0,
+    MessageType_UpdatePlayerS2C = 1,
+    MessageType_FlatBuffers = 2, //Server to client FlatBuffers packet that has to stay in order with the ship updates, see Embedded
+    MessageType_COUNT
+};
+using Type = UInt<MessageType_COUNT - 1>;
+
+//ENet only orders packets within a channel: ship spawns / despawns, join chunks and FlatBuffers fallback updates are the
+//state the bit packed ship updates build on, so for bit packed receivers they travel on Channel too. The type fills the
+//first byte, the packet follows as it would be sent on channel 0 (compressed or not), the receiving transport unwraps it
+struct Embedded
+{
+    static constexpr size_t offset = 1;
+    static constexpr uint8_t header = MessageType_FlatBuffers;
+    static bool Is(const uint8_t* data, size_t size)
+    {
+        return size > offset && (data[0] & ((1u << Type::bits) - 1)) == MessageType_FlatBuffers;
+    }
+};
+
+struct InputC2S
+{
+    using Bitmap = UInt<0x1FF>; //9 input bits (see ShipInput::FromBitmap and the fire bit)
+    using HasShot = UInt<1>;
+    using ShotSeq = UInt<0xFFFFFFFF>; //only present when the fire bit produced a predicted laser
+    using Seq = UInt<0xFFFF>; //echoed back in the senders ship update (latency measurement)
+
+    uint32_t tick = 0; //clients estimate of the server tick
+    uint16_t bitmap = 0;
+    uint32_t shotSeq = 0;
+    uint16_t seq = 0;
+
+    bool Fits() const { return Bitmap::Fits(bitmap); }
+    void Write(BitWriter& writer) const
+    {
+        Type::Write(writer, MessageType_InputC2S);
+        TickStamp::Write(writer, tick);
+        Bitmap::Write(writer, bitmap);
+        HasShot::Write(writer, shotSeq != 0);
+        if (shotSeq != 0) ShotSeq::Write(writer, shotSeq);
+        Seq::Write(writer, seq);
+    }
+    //Type already consumed by the dispatcher
+    bool Read(BitReader& reader, uint32_t referenceTick)
+    {
+        tick = TickStamp::Read(reader, referenceTick);
+        bitmap = uint16_t(Bitmap::Read(reader));
+        shotSeq = HasShot::Read(reader) ? uint32_t(ShotSeq::Read(reader)) : 0;
+        seq = uint16_t(Seq::Read(reader));
+        return reader.Ok();
+    }
+};
+
+//UpdatePlayerS2C is described by the ship schema, see replication.h
+
+} // namespace BitPack
@@ -0,0 +1,239 @@
+#include "config.h"
+#include "checkpoint.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Checkpoint
+{
+
+static uint64_t Checksum(const uint8_t* data, size_t size)
+{
+	uint64_t hash = 0xcbf29ce484222325ull; //FNV-1a
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= data[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static size_t Align(size_t offset)
+{
+	return (offset + Alignment - 1) & ~(Alignment - 1);
+}
+
+#pragma region WRITER
+
+Writer::Writer()
+{
+	image.resize(Align(sizeof(Header)));
+	new (image.data()) Header();
+}
+
+void Writer::AddBytes(SectionType type, uint32_t count, const void* data, size_t size)
+{
+	Header& header = Head();
+	if (header.sectionCount >= Section_Count) return;
+
+	const size_t offset = Align(image.size());
+	image.resize(offset + size);
+	if (size > 0)
+		memcpy(image.data() + offset, data, size);
+
+	Section& section = Head().sections[Head().sectionCount++]; //Head() again, the resize may have moved the image
+	section.type = type;
+	section.count = count;
+	section.offset = offset;
+	section.size = size;
+}
+
+std::vector<uint8_t> Writer::Finish()
+{
+	Head().checksum = Checksum(image.data() + sizeof(Header), image.size() - sizeof(Header));
+	std::vector<uint8_t> finished = std::move(image);
+	image.clear();
+	return finished;
+}
+
+#pragma endregion
+
+#pragma region READER
+
+bool Reader::Open(const uint8_t* bytes, size_t size)
+{
+	data = nullptr;
+	header = nullptr;
+	if (bytes == nullptr || size < sizeof(Header)) return false;
+
+	const Header* head = reinterpret_cast<const Header*>(bytes);
+	if (head->magic != Magic || head->version != Version || head->headerSize != sizeof(Header) || head->sectionCount > Section_Count)
+		return false;
+	for (uint32_t i = 0; i < head->sectionCount; ++i)
+	{
+		const Section& section = head->sections[i];
+		if (section.offset < sizeof(Header) || section.offset % Alignment != 0 || section.offset > size || section.size > size - section.offset)
+			return false;
+	}
+	if (Checksum(bytes + sizeof(Header), size - sizeof(Header)) != head->checksum)
+		return false;
+
+	data = bytes;
+	header = head;
+	return true;
+}
+
+const Section* Reader::Find(SectionType type) const
+{
+	if (header == nullptr) return nullptr;
+	for (uint32_t i = 0; i < header->sectionCount; ++i)
+		if (header->sections[i].type == type) return &header->sections[i];
+	return nullptr;
+}
+
+const uint8_t* Reader::Blob(SectionType type, size_t& size) const
+{
+	const Section* section = Find(type);
+	size = section != nullptr ? size_t(section->size) : 0;
+	return section != nullptr ? data + section->offset : nullptr;
+}
+
+#pragma endregion
+
+#pragma region MAPPING
+
+bool MappedFile::Open(const char* path)
+{
+	Close();
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER length;
+	if (!GetFileSizeEx(handle, &length) || length.QuadPart == 0)
+	{
+		CloseHandle(handle);
+		return false;
+	}
+	HANDLE view = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (view == nullptr)
+	{
+		CloseHandle(handle);
+		return false;
+	}
+	data = static_cast<const uint8_t*>(MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0));
+	file = handle;
+	mapping = view;
+	size = size_t(length.QuadPart);
+	if (data == nullptr)
+	{
+		Close();
+		return false;
+	}
+#else
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+	void* view = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); //The mapping keeps the file alive
+	if (view == MAP_FAILED) return false;
+	data = static_cast<const uint8_t*>(view);
+	size = size_t(info.st_size);
+#endif
+	return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (data != nullptr) UnmapViewOfFile(data);
+	if (mapping != nullptr) CloseHandle(mapping);
+	if (file != nullptr) CloseHandle(file);
+	mapping = nullptr;
+	file = nullptr;
+#else
+	if (data != nullptr) munmap(const_cast<uint8_t*>(data), size);
+#endif
+	data = nullptr;
+	size = 0;
+}
+
+#pragma endregion
+
+#pragma region WRITING
+
+//Owns the background writer, a process that exits without ShutdownServer finishes the write here instead of destroying a joinable thread
+struct BackgroundWriter
+{
+	std::mutex mutex;
+	std::thread thread;
+	std::atomic<bool> writing = false;
+
+	~BackgroundWriter()
+	{
+		if (thread.joinable()) thread.join();
+	}
+};
+static BackgroundWriter writer;
+
+bool Write(const std::string& path, const std::vector<uint8_t>& image)
+{
+	const std::string temp = path + ".tmp";
+	FILE* file = fopen(temp.c_str(), "wb");
+	if (file == nullptr) return false;
+	const bool written = fwrite(image.data(), 1, image.size(), file) == image.size();
+	if (fclose(file) != 0 || !written)
+	{
+		std::remove(temp.c_str());
+		return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temp, path, error); //Replaces the old checkpoint in one step
+	return !error;
+}
+
+bool WriteAsync(const std::string& path, std::vector<uint8_t>&& image)
+{
+	std::lock_guard<std::mutex> lock(writer.mutex);
+	if (writer.writing.load(std::memory_order_acquire)) return false; //Slow disk, the next interval writes a newer state anyway
+	if (writer.thread.joinable()) writer.thread.join();
+
+	writer.writing.store(true, std::memory_order_release);
+	writer.thread = std::thread([path, image = std::move(image)]()
+	{
+		if (!Write(path, image))
+			std::cout << "SERVER: Failed to write checkpoint " << path << "\n";
+		writer.writing.store(false, std::memory_order_release);
+	});
+	return true;
+}
+
+void WaitForWrites()
+{
+	std::lock_guard<std::mutex> lock(writer.mutex);
+	if (writer.thread.joinable()) writer.thread.join();
+}
+
+#pragma endregion
+
+}
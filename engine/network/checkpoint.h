@@ -0,0 +1,178 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+/*
+* SERVER CHECKPOINT
+*	- ONE FILE: HEADER + SECTION TABLE + PLAIN ARRAYS OF FIXED SIZE RECORDS, EVERY SECTION 16 BYTE ALIGNED
+*	- READ THROUGH A READ ONLY MEMORY MAPPING, RECORDS ARE USED IN PLACE (NO PARSING, ONLY A CHECKSUM PASS)
+*	- WRITTEN TO <path>.tmp AND RENAMED OVER THE OLD ONE, A CRASH MID WRITE KEEPS THE PREVIOUS CHECKPOINT
+*	- A VERSION OR LAYOUT CHANGE MAKES OLD FILES INVALID, THE SERVER THEN STARTS EMPTY
+*/
+
+namespace Checkpoint
+{
+	constexpr uint32_t Magic = 0x50434753; //"SGCP"
+	constexpr uint32_t Version = 2; //2: tick based times
+	constexpr size_t Alignment = 16;
+
+	enum SectionType : uint32_t
+	{
+		Section_Ships = 1,
+		Section_Lasers = 2,
+		Section_Respawns = 3,
+		Section_SpawnPoints = 4,
+		Section_Sessions = 5,
+		Section_Asteroids = 6,
+		Section_PhysicsWorld = 7, //Physics::SaveWorld blob
+		Section_Count = 7
+	};
+
+	struct Section
+	{
+		uint32_t type = 0;
+		uint32_t count = 0; //records (bytes for blobs)
+		uint64_t offset = 0; //from the start of the file
+		uint64_t size = 0; //bytes
+	};
+
+	struct Header
+	{
+		uint32_t magic = Magic;
+		uint32_t version = Version;
+		uint32_t headerSize = sizeof(Header); //catches a layout change without a version bump
+		uint32_t sectionCount = 0;
+		uint64_t savedAt = 0; //wall clock (ms since the epoch), only for the log
+		uint64_t checksum = 0; //FNV-1a of everything after the header
+		uint32_t serverTick = 0; //the restored server counts on from here, every saved tick stays valid
+		uint32_t nextClientID = 0;
+		uint32_t laserUUIDCounter = 0;
+		uint32_t playerMeshCollider = 0; //ColliderMeshId, valid when the physics world is restored
+		Section sections[Section_Count];
+	};
+
+	//RECORDS (plain data, written and read as they are in memory)
+	struct ShipRecord
+	{
+		uint32_t id;
+		uint32_t collider; //ColliderId
+		float position[3];
+		float orientation[4]; //w, x, y, z
+		float linearVelocity[3];
+		float currentSpeed;
+		float rotationZ;
+		float rotSmooth[3];
+		float inputCooldown;
+		uint32_t lastInputTimeStamp; //tick
+		uint16_t lastInputBitmap;
+		uint16_t padding;
+	};
+
+	struct LaserRecord
+	{
+		uint32_t uuid;
+		uint32_t ownerID;
+		uint32_t startTime; //tick
+		uint32_t endTime;
+		float origin[3];
+		float position[3];
+		float orientation[4]; //w, x, y, z
+	};
+
+	struct RespawnRecord
+	{
+		uint32_t playerID;
+		uint32_t respawnTick;
+	};
+
+	struct SpawnPointRecord
+	{
+		uint32_t ownerID;
+		uint32_t occupied;
+	};
+
+	struct SessionRecord
+	{
+		uint32_t token;
+		uint32_t playerID;
+	};
+
+	struct AsteroidRecord
+	{
+		uint32_t collider; //ColliderId
+		uint32_t padding[3];
+		float transform[16];
+	};
+
+	//Builds the file image in memory, sections are added in any order
+	class Writer
+	{
+	public:
+		Writer();
+		Header& Head() { return *reinterpret_cast<Header*>(image.data()); }
+
+		template<typename T> void Add(SectionType type, const std::vector<T>& records)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "checkpoint records are copied as raw memory");
+			AddBytes(type, uint32_t(records.size()), records.data(), records.size() * sizeof(T));
+		}
+		void AddBlob(SectionType type, const std::vector<uint8_t>& blob) { AddBytes(type, uint32_t(blob.size()), blob.data(), blob.size()); }
+
+		std::vector<uint8_t> Finish(); //Fills in the checksum, the writer is empty afterwards
+
+	private:
+		void AddBytes(SectionType type, uint32_t count, const void* data, size_t size);
+		std::vector<uint8_t> image;
+	};
+
+	//Read only mapping of a whole file (mmap / MapViewOfFile)
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile() { Close(); }
+
+		bool Open(const char* path);
+		void Close();
+		const uint8_t* Data() const { return data; }
+		size_t Size() const { return size; }
+
+	private:
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+#ifdef _WIN32
+		void* file = nullptr;
+		void* mapping = nullptr;
+#endif
+	};
+
+	//Validates an image and hands out its sections in place
+	class Reader
+	{
+	public:
+		bool Open(const uint8_t* data, size_t size); //False: wrong magic / version / layout, truncated or checksum mismatch
+		const Header& Head() const { return *header; }
+
+		template<typename T> const T* Records(SectionType type, size_t& count) const
+		{
+			const Section* section = Find(type);
+			count = section != nullptr && section->size == uint64_t(section->count) * sizeof(T) ? section->count : 0;
+			return count > 0 ? reinterpret_cast<const T*>(data + section->offset) : nullptr;
+		}
+		const uint8_t* Blob(SectionType type, size_t& size) const;
+
+	private:
+		const Section* Find(SectionType type) const;
+		const uint8_t* data = nullptr;
+		const Header* header = nullptr;
+	};
+
+	bool Write(const std::string& path, const std::vector<uint8_t>& image); //Blocking, temp file + rename
+	bool WriteAsync(const std::string& path, std::vector<uint8_t>&& image); //Background thread, false while the previous write is still running
+	void WaitForWrites();
+}
@@ -1,19 +1,43 @@
 #include "config.h"
 #include "client.h"
+#include "loopback.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstring>
 
 GameClient gameClient = GameClient::Instance();
 
+static Replication::ShipState ShipStateOf(const Player* player, uint16_t intervalMs = 0)
+{
+	Replication::ShipState state;
+	state.intervalMs = intervalMs;
+	state.position = glm::vec3(player->position().x(), player->position().y(), player->position().z());
+	state.velocity = glm::vec3(player->velocity().x(), player->velocity().y(), player->velocity().z());
+	state.orientation = glm::quat(player->direction().x(), player->direction().y(), player->direction().z(), player->direction().w());
+	return state;
+}
+
 void GameClient::Create()
 {
-	//Create the client host
-	client = enet_host_create(nullptr, 1, 1, 0, 0);
+	//Create the client host (a host from an earlier connect is done with)
+	ClientNetwork& network = ClientNetwork::Instance();
+	network.Stop();
+	if (client)
+	{
+		net_instance.ForgetHost(client);
+		enet_host_destroy(client);
+	}
+	peer = nullptr;
+	client = enet_host_create(nullptr, 1, BitPack::ChannelCount, 0, 0);
 	if (!client)
 	{
 		std::cout << "Failed to create ENet Client!\n";
 		return;
 	}
+	net_instance.EnableDecompression(client); //Whatever sv_compression the server runs with
+	network.Start(client);
 
 	isActive = true;
 }
@@ -27,98 +51,277 @@ bool GameClient::ConnectToServer(const char* ip, const uint16_t port )
 	ENetAddress address;
 	enet_address_set_host(&address, ip);
 	address.port = port;
-	peer = enet_host_connect(client, &address, 1, 0);
-	if(!peer)
-	{
-		std::cout << "CLIENT: Failed to establish connection request to peer at: " << address.host
-			<< "; " << port << "\n";
-		return false;
-	}
+	serverAddress = address;
+	resumeDeadline = 0;
+	peer = nullptr; //Reported back by the network thread (Connecting)
+	ClientNetwork::Instance().Connect(address, sessionToken); //A token the server still holds resumes our old player, the extra channel offers the bit packed format
 	
 	std::cout << "CLIENT: Successful initiate connection to ENET Server: Awaiting for server respond to request\n";
 	return true; //Successful connecting to server
 }
 
+bool GameClient::ConnectLoopback()
+{
+	//No ENet host needed, the server lives in this process
+	peer = Loopback::Instance().Peer();
+	Loopback::Instance().Connect();
+	isActive = true;
+
+	std::cout << "CLIENT: Connecting to the local server through the loopback transport\n";
+	return true;
+}
+
 void GameClient::Update()
 {
 	if (!isActive) return;
-	currentTime = Time::Now();
-	
-	ENetEvent event;
-	while (enet_host_service(client, &event, 0) > 0) //Pool
+	currentTime = Now();
+
+	if (peer == Loopback::Instance().Peer())
+	{
+		Loopback& loopback = Loopback::Instance();
+		while (loopback.toClient.Pop(loopbackBuffer))
+			Receive(loopbackBuffer.data(), loopbackBuffer.size(), false, Time::NowUs());
+		loopback.toServer.Flush();
+	}
+
+	//ENet runs on the network thread, everything it received since the last frame (decompressed, with its arrival time)
+	ClientNetEvent event;
+	const uint8_t* payload = nullptr;
+	size_t size = 0;
+	while (client && ClientNetwork::Instance().Poll(event, payload, size))
 	{
 		switch (event.type)
 		{
-		//case ENET_EVENT_TYPE_CONNECT: {
-		//	std::cout << "CLIENT TYPE CONNECT WAS GENERATED\n";
-		//	//Call the respective callback
-		//	//if (OnClientConnect)
-		////	OnClientConnect(event.peer);
-		//	break;
-		//}
-
-		case ENET_EVENT_TYPE_RECEIVE: {
-			OnRecievepacket(event.packet);
+		case ClientNetEvent::Receive: {
+			Receive(payload, size, event.channelID == BitPack::Channel, event.arrivalUs);
 			break;
 		}
 
+		case ClientNetEvent::Connecting: {
+			peer = event.peer;
+			if (!peer)
+				std::cout << "CLIENT: Failed to establish connection request to peer at: " << serverAddress.host
+					<< "; " << serverAddress.port << "\n";
+			break;
 		}
+
+		case ClientNetEvent::Disconnect: {
+			if (peer != Loopback::Instance().Peer())
+				OnConnectionLost();
+			break;
+		}
+		}
+	}
+	currentTime = Now(); //Everything handled above arrived before this
+
+	//Predicted lasers the server never confirmed (we were dead or the shot was rejected)
+	const uint32_t tick = ServerTick();
+	for (auto it = lasers.begin(); it != lasers.end();)
+	{
+		if (it->second.predicted && Tick::Reached(tick, it->second.endTime))
+		{
+			it->second.Hide();
+			it = lasers.erase(it);
+		}
+		else
+			it++;
 	}
+
+	if (recorder.KeyframeDue(currentTime))
+		recorder.AddKeyframe(BuildKeyframe(), currentTime);
+}
+
+void GameClient::Receive(const uint8_t* data, size_t size, bool bitPacked, uint64_t arrivalUs)
+{
+	if (Playing()) return; //The demo owns the world until it is stopped
+	receiveTimeUs = arrivalUs;
+	receiveTime = arrivalUs / 1000;
+	if (recorder.Recording())
+		recorder.Add(bitPacked ? Demo::Record_BitPacked : Demo::Record_Message, data, size, receiveTime);
+	if (bitPacked)
+		OnRecieveBitPacked(data, size);
+	else
+		OnRecievepacket(data);
 }
 
 void GameClient::SendInput(const FlatBufferBuilder& builder)
 {
-	net_instance.SendToServer(this->peer, builder);
+	SendToServer(builder);
+}
+
+void GameClient::SendToServer(const FlatBufferBuilder& builder)
+{
+	if (peer == nullptr) return; //No connection to server
+	if (peer == Loopback::Instance().Peer())
+		net_instance.SendToServer(peer, builder);
+	else
+		ClientNetwork::Instance().Send(0, builder.GetBufferPointer(), builder.GetSize());
+}
+
+void GameClient::SendToServer(const BitPack::BitWriter& writer)
+{
+	//The loopback peer never negotiates the bit packed format
+	if (peer == nullptr || peer == Loopback::Instance().Peer()) return;
+	ClientNetwork::Instance().Send(BitPack::Channel, writer.Data(), writer.Size());
+}
+
+void GameClient::SendInput(uint16_t bitmap, uint32_t shotSeq)
+{
+	//The server drops inputs older than the last one it applied
+	const uint32_t tick = ServerTick();
+	if (lastInputTick == 0 || Tick::Diff(tick, lastInputTick) > 0)
+		lastInputTick = tick;
+
+	const uint16_t seq = nextInputSeq;
+	nextInputSeq = nextInputSeq == 0xFFFF ? 1 : nextInputSeq + 1;
+	SentInput& sent = sentInputs[seq & 0xFF];
+	sent.seq = seq;
+	sent.sentUs = Time::NowUs();
+
+	if (wireFormat != BitPack::WireFormat_BitPacked)
+	{
+		SendInput(packet::InputC2S(lastInputTick, bitmap, shotSeq, seq));
+		return;
+	}
+
+	BitPack::InputC2S input;
+	input.tick = lastInputTick;
+	input.bitmap = bitmap;
+	input.shotSeq = shotSeq;
+	input.seq = seq;
+	bitWriter.Clear();
+	input.Write(bitWriter);
+	SendToServer(bitWriter); //Leaves on the network thread right away, not with the next frame
+}
+
+uint32_t GameClient::ServerTick(float* fraction) const
+{
+	const double elapsed = double(Now() - syncTime) / Tick::Ms;
+	if (fraction != nullptr) *fraction = float(elapsed - std::floor(elapsed));
+	return syncTick + uint32_t(elapsed);
+}
+
+uint32_t GameClient::TickAt(uint64_t time) const
+{
+	return syncTick + uint32_t(int64_t(std::floor(double(int64_t(time - syncTime)) / Tick::Ms)));
+}
+
+void GameClient::SyncTick(uint32_t tick)
+{
+	//A received tick already happened: being behind it means the estimate lost time (delivery delay only ever makes it late),
+	//being far ahead means the server stalled and its ticks fell behind the clock
+	//Judged at the arrival time, how long the message waited for the frame does not count as delivery delay
+	const int32_t drift = Tick::Diff(tick, TickAt(receiveTime));
+	if (drift > 0 || drift < -resyncTicks)
+	{
+		syncTick = tick;
+		syncTime = receiveTime;
+	}
 }
 
 void GameClient::DisconnectFromServer()
 {
-	net_instance.SendToServer(this->peer, this->myPlayerID);
+	if (peer == Loopback::Instance().Peer())
+		net_instance.SendToServer(this->peer, this->myPlayerID);
+	else if (peer != nullptr)
+		ClientNetwork::Instance().Disconnect(this->myPlayerID);
+	sessionToken = 0; //Leaving on purpose, the server drops the player right away
+	resumeDeadline = 0;
 }
 
+void GameClient::OnConnectionLost()
+{
+	peer = nullptr;
+	if (sessionToken == 0) return;
 
-void GameClient::OnRecievepacket(ENetPacket* packet)
+	if (resumeDeadline == 0)
+		resumeDeadline = currentTime + resumeWindow;
+	if (currentTime >= resumeDeadline)
+	{
+		std::cout << "CLIENT: Could not resume the session, giving up\n";
+		sessionToken = 0;
+		resumeDeadline = 0;
+		ClearWorld();
+		return;
+	}
+
+	//Keep the world as it is, the server only sends what changed once we are back
+	std::cout << "CLIENT: Connection lost, reconnecting to resume the session\n";
+	ClientNetwork::Instance().Connect(serverAddress, sessionToken);
+}
+
+void GameClient::ClearWorld()
+{
+	for (auto& [id, ship] : spaceships)
+		ship.RemoveSpaceship();
+	spaceships.clear();
+	shipStates.clear();
+	remoteShipsDirty = true;
+	for (const auto& [id, laser] : lasers)
+		laser.Hide();
+	lasers.clear();
+}
+
+
+void GameClient::OnRecievepacket(const uint8_t* data)
 {
 	//On packet recieved from the server
-	auto wrapper = GetPacketWrapper(packet->data)->UnPack()->packet;
-	switch (wrapper.type)
+	//Tables are read in place from the packet buffer (no object API copy, nothing allocated per packet)
+	const PacketWrapper* wrapper = GetPacketWrapper(data);
+	switch (wrapper->packet_type())
 	{
 		case PacketType_ClientConnectS2C:{
 			std::cout << "CLIENT: Recieved Connect package\n";
-			const auto clientConnectS2C = wrapper.AsClientConnectS2C();
-			this->myPlayerID = clientConnectS2C->uuid;
-			this->serverTime = clientConnectS2C->time;
+			const auto clientConnectS2C = wrapper->packet_as_ClientConnectS2C();
+			resumeDeadline = 0;
+			//Tell the server which dictionary we can decode, until then it compresses without one (nobody to tell in a demo)
+			if (!Playing())
+				SendToServer(packet::ClientHelloC2S(NetworkManager::Compressor().DictionaryID()));
+			if (sessionToken != 0 && clientConnectS2C->session_token() == sessionToken && clientConnectS2C->uuid() == myPlayerID)
+			{
+				//Resumed, report what we kept so the server can send the difference
+				std::vector<uint32_t> keptPlayers, keptLasers;
+				keptPlayers.reserve(spaceships.size());
+				keptLasers.reserve(lasers.size());
+				for (const auto& [id, ship] : spaceships)
+					keptPlayers.push_back(id);
+				for (const auto& [id, laser] : lasers)
+					if (!laser.predicted) keptLasers.push_back(id);
+				if (!Playing())
+					SendToServer(packet::ResumeC2S(keptPlayers, keptLasers));
+				std::cout << "CLIENT: Resumed session as player " << myPlayerID << "\n";
+			}
+			else if (!spaceships.empty() || !lasers.empty())
+				ClearWorld(); //New session, the old world is stale
 
-			//Testing with synchronize time between client and server
-			clientTimeZero = currentTime;
+			this->sessionToken = clientConnectS2C->session_token();
+			this->wireFormat = BitPack::WireFormat(clientConnectS2C->wire_format());
+			this->myPlayerID = clientConnectS2C->uuid();
+			//Clock sync: every server (zone servers too) counts its own ticks
+			syncTick = clientConnectS2C->time();
+			syncTime = receiveTime;
+			lastInputTick = 0;
 
-			std::cout << "CLIENT: Connect package with uuid " << clientConnectS2C->uuid << "\n";
-			std::cout << "CLIENT: Player ID " << myPlayerID << "\n";
+			std::cout << "CLIENT: Connect package with uuid " << clientConnectS2C->uuid() << "\n";
+			std::cout << "CLIENT: Player ID " << myPlayerID << (wireFormat == BitPack::WireFormat_BitPacked ? " (bit packed updates)" : "") << "\n";
 			break;
 		}
 		case PacketType_GameStateS2C: {
 
 			std::cout << "CLIENT: Recieved GAME STATE update\n";
-			auto gameState = wrapper.AsGameStateS2C();
+			auto gameState = wrapper->packet_as_GameStateS2C();
 			//std::cout << "Client spaceship list count before adding: " << spaceships->size() << "\n";
-			for(const auto& player : gameState->players)
+			//Join state arrives in several chunks, skip entities a spawn broadcast already created
+			if (gameState->players()) for(const Player* player : *gameState->players())
+			{
+				if (spaceships.contains(player->uuid())) continue;
+				AddShip(player->uuid(), ShipStateOf(player));
+			}
+
+			if (gameState->lasers()) for (const Laser* laser : *gameState->lasers())
 			{
-				spaceships.emplace(player.uuid(), Game::ClientSpaceship());
-				Game::ClientSpaceship& ship = spaceships.at(player.uuid());
-				ship.id = player.uuid();
-				const Vec3& pos = player.position();
-				const Vec3& vel = player.velocity();
-				const Vec4& orient = player.direction();
-				ship.position = glm::vec3(pos.x(), pos.y(), pos.z());
-				ship.linearVelocity = glm::vec3(vel.x(), vel.y(), vel.z());
-				ship.orientation = glm::quat(orient.x(), orient.y(), orient.z(), orient.w());
-				ship.InitSpaceship();
-				if(spaceships.count(player.uuid()))
-				{
-					std::cout << "Client spaceship with this ID: " << player.uuid() << " is present in the spaceshipMap\n";
-				}
-				else
-					std::cout << "Client spaceship with this ID: " << player.uuid() << " is absent in the spaceshipMap\n";
+				if (lasers.contains(laser->uuid())) continue;
+				SpawnLaser(*laser);
 			}
 			break;
 		}
@@ -127,7 +330,7 @@ void GameClient::OnRecievepacket(ENetPacket* packet)
 		{
 			//Spawn the player we initalized 
 			std::cout << "CLIENT: RECIEVED SPAWNPLAYER PACKAGE\n";
-			auto& player = wrapper.AsSpawnPlayerS2C()->player;
+			const Player* player = wrapper->packet_as_SpawnPlayerS2C()->player();
 
 			// Clean safety check
 			if (spaceships.contains(player->uuid()))
@@ -138,11 +341,12 @@ void GameClient::OnRecievepacket(ENetPacket* packet)
 			}
 
 			spaceships.emplace(player->uuid(), Game::ClientSpaceship(player->uuid()));
+			remoteShipsDirty = true;
 			Game::ClientSpaceship& spaceship = spaceships.at(player->uuid());
-			const Vec3& pos = player->position();
-			const Vec4& orient = player->direction();
-			spaceship.position = glm::vec3(pos.x(), pos.y(), pos.z());
-			spaceship.orientation = glm::quat(orient.x(), orient.y(), orient.z(), orient.w());
+			const Replication::ShipState& state = shipStates[player->uuid()] = ShipStateOf(player);
+			spaceship.position = state.position;
+			spaceship.orientation = state.orientation;
+			spaceship.ResetInterpolation();
 			spaceship.InitSpaceship();
 			std::cout << "CLIENT: spaceships count " << spaceships.size() << "\n";
 			break;
@@ -151,14 +355,11 @@ void GameClient::OnRecievepacket(ENetPacket* packet)
 		case PacketType_UpdatePlayerS2C:
 		{
 			//std::cout << "CLIENT: RECIEVED UpdatePlayerS2C PACKAGE\n";
-			const auto updatePlayer = wrapper.AsUpdatePlayerS2C();
-			auto& player = updatePlayer->player;
-			if (!spaceships.contains(player->uuid())) return;
-			Game::ClientSpaceship& ship = spaceships.at(player->uuid()); 
-			glm::vec3 serverPs(player->position().x(), player->position().y(), player->position().z());
-			glm::quat serverOr(player->direction().x(), player->direction().y(), player->direction().z(), player->direction().w());
-			glm::vec3 serverVe(player->velocity().x(), player->velocity().y(), player->velocity().z());
-			ship.CorrectFromServer(serverPs, serverOr, serverVe,updatePlayer->time); //UpdatePLayer change with currentTime for online test
+			const auto updatePlayer = wrapper->packet_as_UpdatePlayerS2C();
+			const Player* player = updatePlayer->player();
+			ApplyServerUpdate(player->uuid(), ShipStateOf(player, updatePlayer->interval_ms()), updatePlayer->time());
+			if (updatePlayer->input_ack_seq() != 0)
+				OnInputAck(updatePlayer->input_ack_seq(), updatePlayer->input_ack_delay());
 			break;
 		}
 
@@ -167,10 +368,13 @@ void GameClient::OnRecievepacket(ENetPacket* packet)
 			//DESPAWN THE SPACESHIP BASED ON THE ID FROM THE PACKAGE (HANDLES THE BOTH WHEN ITS DESPAWN AND DISSCONNECT)
 			std::cout << "CLIENT: RECIEVED DESPAWNPLAYER PACKAGE\n";
 			
-			const auto despawn = wrapper.AsDespawnPlayerS2C();
-			auto id = despawn->uuid;
+			const auto despawn = wrapper->packet_as_DespawnPlayerS2C();
+			auto id = despawn->uuid();
+			if (!spaceships.contains(id)) break; //Never streamed to us (died while we were joining)
 			spaceships[id].RemoveSpaceship();
 			spaceships.erase(id);
+			remoteShipsDirty = true;
+			shipStates.erase(id);
 			this->myPlayerID - 1; //REMOVE THE PLAYER ID
 			break;
 		}
@@ -178,35 +382,35 @@ void GameClient::OnRecievepacket(ENetPacket* packet)
 		case PacketType_SpawnLaserS2C:
 		{
 			//std::cout << "CLIENT: RECIEVED SPAWN LASER PACKAGE\n";
-			auto& laserPacket = wrapper.AsSpawnLaserS2C()->laser;
-			//Game::ClientLaser laser;
-			glm::vec3 laserPos = glm::vec3(laserPacket->origin().x(), laserPacket->origin().y(), laserPacket->origin().z());
-			glm::quat laserOr = glm::quat(laserPacket->direction().x(), laserPacket->direction().y(), laserPacket->direction().z(), laserPacket->direction().w());
-			lasers[laserPacket->uuid()] = Game::ClientLaser();
-
-			auto& laser = lasers.at(laserPacket->uuid());
-			laser.uuid = laserPacket->uuid();
-			laser.startTime = laserPacket->start_time();
-			laser.endTime = laserPacket->end_time();
-			laser.position = laserPos;
-			laser.orientation = laserOr;
-
-			//Sync the laser with the server
-			const uint64_t packetSentTime = laserPacket->start_time() - serverTime;
-			const uint64_t packetRecievedTime = currentTime - clientTimeZero;
-			laser.serverSentTime = packetSentTime;
-			laser.clientRecievedTime = packetRecievedTime;
-			laser.elapsedTime = (float)(packetRecievedTime - packetSentTime) / 1000.0f;
-
-			laser.transform = glm::translate(laserPos) * glm::mat4_cast(laserOr) * glm::scale(glm::vec3(1.0f));// * modelCorrection;
+			const auto spawnLaser = wrapper->packet_as_SpawnLaserS2C();
+			SpawnLaser(*spawnLaser->laser(), spawnLaser->owner_id(), spawnLaser->shot_seq());
 			break;
 		}
 
 		case PacketType_DespawnLaserS2C:
 		{
 			//std::cout << "CLIENT: RECIEVED DESPAWN LASER PACKAGE\n";
-			const auto despawnLaser = wrapper.AsDespawnLaserS2C();
-			lasers.erase(despawnLaser->uuid);
+			const auto despawnLaser = wrapper->packet_as_DespawnLaserS2C();
+			const auto found = lasers.find(despawnLaser->uuid());
+			if (found == lasers.end()) break;
+			found->second.Hide();
+			lasers.erase(found);
+			break;
+		}
+
+		case PacketType_ZoneRedirectS2C:
+		{
+			//Our ship crossed into another zone, that server already holds our player (resumed like a dropped connection, the world is kept)
+			if (peer == Loopback::Instance().Peer() || Playing()) break;
+			const auto redirect = wrapper->packet_as_ZoneRedirectS2C();
+			serverAddress.host = redirect->host();
+			serverAddress.port = redirect->port();
+			sessionToken = redirect->session_token();
+			resumeDeadline = 0;
+			ClientNetwork::Instance().DisconnectNow();
+			ClientNetwork::Instance().Connect(serverAddress, sessionToken);
+			peer = nullptr;
+			std::cout << "CLIENT: Handed off to the zone server on port " << serverAddress.port << "\n";
 			break;
 		}
 		default:
@@ -214,3 +418,302 @@ void GameClient::OnRecievepacket(ENetPacket* packet)
 	}
 }
 
+void GameClient::OnRecieveBitPacked(const uint8_t* data, size_t size)
+{
+	BitPack::BitReader reader(data, size);
+	switch (BitPack::Type::Read(reader))
+	{
+		case BitPack::MessageType_UpdatePlayerS2C:
+		{
+			Replication::ShipUpdateS2C update;
+			if (!update.Read(reader, ServerTick())) return; //Truncated
+			const auto known = shipStates.find(update.uuid);
+			if (known == shipStates.end()) return; //Not spawned for us (yet)
+			Replication::ShipState state = known->second;
+			Replication::ShipSchema::Copy(state, update.state, update.dirty);
+			ApplyServerUpdate(update.uuid, state, update.tick);
+			if (update.ackSeq != 0)
+				OnInputAck(update.ackSeq, update.ackDelay);
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+void GameClient::ApplyServerUpdate(uint32_t uuid, const Replication::ShipState& state, uint32_t tick)
+{
+	SyncTick(tick);
+	const auto found = spaceships.find(uuid);
+	if (found == spaceships.end()) return;
+	Game::ClientSpaceship& ship = found->second;
+	shipStates[uuid] = state;
+	if (state.intervalMs > 0)
+		ship.interpolator.SetDuration(state.intervalMs / 1000.0f); //Server changes our rate with our link quality
+	ship.CorrectFromServer(state.position, state.orientation, state.velocity, tick);
+}
+
+void GameClient::OnInputAck(uint16_t seq, uint16_t delay)
+{
+	const SentInput& sent = sentInputs[seq & 0xFF];
+	if (sent.seq != seq || Playing()) return; //Overwritten by newer inputs (a demo carries the recording clients acks)
+	latency.inputToAck.Add(receiveTimeUs - sent.sentUs); //Arrival, not when the frame got to it
+	latency.serverDelay.Add(uint64_t(delay) * 100);
+	screenPendingSentUs = sent.sentUs; //The corrected state was just applied, the next presented frame shows it
+}
+
+void GameClient::OnFramePresented()
+{
+	if (screenPendingSentUs == 0) return;
+	latency.inputToScreen.Add(Time::NowUs() - screenPendingSentUs);
+	screenPendingSentUs = 0;
+}
+
+void GameClient::UpdateRemoteShips(float dt)
+{
+	if (remoteShipsDirty || remoteShipsOwner != myPlayerID)
+	{
+		remoteShips.clear();
+		for (auto& [id, ship] : spaceships)
+			if (id != myPlayerID) remoteShips.push_back(&ship);
+		remoteShipsDirty = false;
+		remoteShipsOwner = myPlayerID;
+	}
+	Game::UpdateRemoteShips(remoteShips.data(), remoteShips.size(), dt);
+}
+
+void GameClient::AddShip(uint32_t uuid, const Replication::ShipState& state)
+{
+	spaceships.emplace(uuid, Game::ClientSpaceship());
+	remoteShipsDirty = true;
+	Game::ClientSpaceship& ship = spaceships.at(uuid);
+	shipStates[uuid] = state;
+	ship.id = uuid;
+	ship.position = state.position;
+	ship.linearVelocity = state.velocity;
+	ship.orientation = state.orientation;
+	ship.ResetInterpolation();
+	if (state.intervalMs > 0)
+		ship.interpolator.SetDuration(state.intervalMs / 1000.0f);
+	ship.InitSpaceship();
+}
+
+uint32_t GameClient::SpawnPredictedLaser(const Game::ClientSpaceship& ship)
+{
+	//Same spawn rule as the server, the SpawnLaserS2C echo replaces the local id with the server one
+	const uint32_t shotSeq = nextShotSeq++;
+	const glm::vec3 forward = ship.orientation * glm::vec3(0.0f, 0.0f, 1.0f);
+
+	Game::ClientLaser& laser = lasers[PREDICTED_LASER_BIT | shotSeq];
+	laser.uuid = PREDICTED_LASER_BIT | shotSeq;
+	laser.ownerID = ship.id;
+	laser.shotSeq = shotSeq;
+	laser.predicted = true;
+	laser.startTime = ServerTick();
+	laser.endTime = laser.startTime + LASER_LIFETIME_TICKS;
+	laser.origin = ship.position + forward * 2.0f;
+	laser.orientation = ship.orientation;
+	laser.Show();
+	return shotSeq;
+}
+
+void GameClient::SpawnLaser(const Laser& laserPacket, uint32_t ownerID, uint32_t shotSeq)
+{
+	float fraction = 0.0f;
+	const uint32_t tick = ServerTick(&fraction);
+	Game::ClientLaser laser;
+	laser.uuid = laserPacket.uuid();
+	laser.ownerID = ownerID;
+	laser.shotSeq = shotSeq;
+	laser.startTime = laserPacket.start_time();
+	laser.endTime = laserPacket.end_time();
+	laser.origin = glm::vec3(laserPacket.origin().x(), laserPacket.origin().y(), laserPacket.origin().z());
+	laser.orientation = glm::quat(laserPacket.direction().x(), laserPacket.direction().y(), laserPacket.direction().z(), laserPacket.direction().w());
+
+	//Our own shot, merge with the predicted laser instead of spawning a duplicate
+	const auto predicted = ownerID == myPlayerID && shotSeq != 0 ? lasers.find(PREDICTED_LASER_BIT | shotSeq) : lasers.end();
+	if (predicted != lasers.end())
+	{
+		//Keep the predicted flight path when it agrees with the server (both where they are now), otherwise take the server one
+		const float correctionTolerance = 1.0f;
+		if (glm::length(predicted->second.PositionAt(tick, fraction) - laser.PositionAt(tick, fraction)) < correctionTolerance)
+		{
+			laser.origin = predicted->second.origin;
+			laser.orientation = predicted->second.orientation;
+			laser.startTime = predicted->second.startTime;
+		}
+		predicted->second.Hide();
+		lasers.erase(predicted);
+	}
+
+	//The flight path is all the renderer needs, it fast forwards with the synced clock (the laser left the shooter a trip ago)
+	lasers[laser.uuid] = laser;
+	laser.Show();
+}
+
+bool GameClient::StartRecording(const std::string& path, uint32_t keyframeIntervalMs)
+{
+	if (peer == nullptr || Playing()) return false;
+	if (!recorder.Start(path, currentTime, keyframeIntervalMs))
+	{
+		std::cout << "CLIENT: Could not open demo file " << path << "\n";
+		return false;
+	}
+	recorder.AddKeyframe(BuildKeyframe(), currentTime); //Playback starts here
+	std::cout << "CLIENT: Recording demo to " << path << "\n";
+	return true;
+}
+
+std::vector<uint8_t> GameClient::BuildKeyframe() const
+{
+	std::vector<Demo::ShipRecord> ships;
+	std::vector<Demo::LaserRecord> shots;
+	ships.reserve(shipStates.size());
+	shots.reserve(lasers.size());
+	for (const auto& [id, state] : shipStates)
+	{
+		if (!spaceships.contains(id)) continue;
+		Demo::ShipRecord& record = ships.emplace_back();
+		record.uuid = id;
+		record.intervalMs = state.intervalMs;
+		memcpy(record.position, &state.position[0], sizeof(record.position));
+		memcpy(record.velocity, &state.velocity[0], sizeof(record.velocity));
+		const float orientation[4] = { state.orientation.w, state.orientation.x, state.orientation.y, state.orientation.z };
+		memcpy(record.orientation, orientation, sizeof(record.orientation));
+	}
+	for (const auto& [id, laser] : lasers)
+	{
+		if (laser.predicted) continue; //Ours only until the server confirms it, the confirmation is in the stream
+		Demo::LaserRecord& record = shots.emplace_back();
+		record.uuid = laser.uuid;
+		record.ownerID = laser.ownerID;
+		record.startTime = laser.startTime;
+		record.endTime = laser.endTime;
+		memcpy(record.origin, &laser.origin[0], sizeof(record.origin));
+		const float orientation[4] = { laser.orientation.w, laser.orientation.x, laser.orientation.y, laser.orientation.z };
+		memcpy(record.orientation, orientation, sizeof(record.orientation));
+	}
+
+	Demo::KeyframeHeader header;
+	header.syncTick = syncTick;
+	header.syncAgeMs = uint32_t(currentTime - syncTime);
+	header.playerID = myPlayerID;
+	header.shipCount = uint32_t(ships.size());
+	header.laserCount = uint32_t(shots.size());
+
+	const size_t shipBytes = ships.size() * sizeof(Demo::ShipRecord);
+	const size_t laserBytes = shots.size() * sizeof(Demo::LaserRecord);
+	std::vector<uint8_t> keyframe(sizeof(header) + shipBytes + laserBytes);
+	memcpy(keyframe.data(), &header, sizeof(header));
+	if (shipBytes > 0) memcpy(keyframe.data() + sizeof(header), ships.data(), shipBytes);
+	if (laserBytes > 0) memcpy(keyframe.data() + sizeof(header) + shipBytes, shots.data(), laserBytes);
+	return keyframe;
+}
+
+void GameClient::ApplyKeyframe(const uint8_t* data, size_t size)
+{
+	Demo::KeyframeHeader header;
+	if (size < sizeof(header)) return;
+	memcpy(&header, data, sizeof(header));
+	const size_t shipBytes = size_t(header.shipCount) * sizeof(Demo::ShipRecord);
+	const size_t laserBytes = size_t(header.laserCount) * sizeof(Demo::LaserRecord);
+	if (size != sizeof(header) + shipBytes + laserBytes) return;
+
+	ClearWorld();
+	syncTick = header.syncTick;
+	syncTime = Now() - header.syncAgeMs;
+	myPlayerID = header.playerID;
+
+	const uint8_t* cursor = data + sizeof(header);
+	for (uint32_t i = 0; i < header.shipCount; i++, cursor += sizeof(Demo::ShipRecord))
+	{
+		Demo::ShipRecord record;
+		memcpy(&record, cursor, sizeof(record));
+		Replication::ShipState state;
+		state.intervalMs = uint16_t(record.intervalMs);
+		state.position = glm::vec3(record.position[0], record.position[1], record.position[2]);
+		state.velocity = glm::vec3(record.velocity[0], record.velocity[1], record.velocity[2]);
+		state.orientation = glm::quat(record.orientation[0], record.orientation[1], record.orientation[2], record.orientation[3]);
+		AddShip(record.uuid, state);
+	}
+	for (uint32_t i = 0; i < header.laserCount; i++, cursor += sizeof(Demo::LaserRecord))
+	{
+		Demo::LaserRecord record;
+		memcpy(&record, cursor, sizeof(record));
+		const Laser laser(record.uuid, record.startTime, record.endTime, Vec3(record.origin[0], record.origin[1], record.origin[2]),
+			Vec4(record.orientation[0], record.orientation[1], record.orientation[2], record.orientation[3]));
+		SpawnLaser(laser, record.ownerID);
+	}
+}
+
+bool GameClient::StartPlayback(const std::string& path)
+{
+	if (Recording()) return false;
+	if (!playback.Open(path))
+	{
+		std::cout << "CLIENT: " << path << " is not a playable demo\n";
+		return false;
+	}
+	sessionToken = 0;
+	playbackSpeed = 1.0f;
+	playbackPaused = false;
+	SeekPlayback(0);
+	std::cout << "CLIENT: Playing demo " << path << " (" << playback.DurationMs() / 1000.0f << "s, "
+		<< playback.KeyframeCount() << " keyframes)\n";
+	return true;
+}
+
+void GameClient::StopPlayback()
+{
+	if (!Playing()) return;
+	playback.Close();
+	ClearWorld();
+	sessionToken = 0;
+	myPlayerID = -1;
+}
+
+void GameClient::UpdatePlayback(float dt)
+{
+	if (!Playing() || playbackPaused) return;
+	AdvancePlayback(playbackClock + double(dt) * 1000.0 * std::clamp(playbackSpeed, 0.25f, 16.0f));
+}
+
+void GameClient::SeekPlayback(uint32_t timeMs)
+{
+	if (!Playing()) return;
+	playback.SeekKeyframe(timeMs);
+	Demo::Record keyframe;
+	if (!playback.Peek(keyframe)) return;
+	playbackClock = keyframe.timeMs;
+	currentTime = Now();
+	ApplyKeyframe(keyframe.data, keyframe.size);
+	playback.Skip();
+	AdvancePlayback(timeMs);
+}
+
+void GameClient::AdvancePlayback(double timeMs)
+{
+	//Every record is applied at its own arrival time, the clock sync sees the same timing as the recording client
+	Demo::Record record;
+	while (playback.Peek(record) && record.timeMs <= timeMs)
+	{
+		playbackClock = record.timeMs;
+		currentTime = receiveTime = Now();
+		receiveTimeUs = receiveTime * 1000;
+		switch (record.type)
+		{
+			case Demo::Record_Keyframe:
+				break; //Only seeking restores one, playing through keeps the world (and its interpolation) as it is
+			case Demo::Record_BitPacked:
+				OnRecieveBitPacked(record.data, record.size);
+				break;
+			case Demo::Record_Message:
+				playbackBuffer.assign(record.data, record.data + record.size); //FlatBuffers expects an aligned buffer
+				OnRecievepacket(playbackBuffer.data());
+				break;
+		}
+		playback.Skip();
+	}
+	playbackClock = std::min(timeMs, double(playback.DurationMs()));
+	currentTime = Now();
+}
@@ -3,6 +3,10 @@
 //NEW includes
 #include "enet/enet.h"
 #include "network.h"
+#include "replication.h"
+#include "latency.h"
+#include "demo.h"
+#include "clientnetwork.h"
 #include <unordered_map>
 
 #include "timer.h"
@@ -19,38 +23,108 @@ public:
         return instance;
     }
 
-    void Create();
+    void Create(); //New ENet host, serviced by the client network thread (see clientnetwork.h)
     bool ConnectToServer(const char* ip, const uint16_t port);
+    bool ConnectLoopback(); //Connect to the GameServer running in this process (host), bypasses ENet
     void Update();
     void SendInput(const FlatBufferBuilder& builder);
+    void SendInput(uint16_t bitmap, uint32_t shotSeq = 0); //Stamped with ServerTick(), bit packed when the server agreed to it
     void DisconnectFromServer();
+    uint32_t SpawnPredictedLaser(const Game::ClientSpaceship& ship); //Shows a fired laser now, returns its shot sequence
 
     std::unordered_map<uint32_t, Game::ClientSpaceship> spaceships; //all spaceships
+    std::unordered_map<uint32_t, Replication::ShipState> shipStates; //Last replicated state per ship, bit packed updates only carry the fields that changed
     std::unordered_map<uint32_t, Game::ClientLaser> lasers; //all lasers
     uint32_t myPlayerID = -1; //Player controlled spaceship indentifier
+    void UpdateRemoteShips(float dt); //Every ship but ours, interpolation and render state only (see Game::UpdateRemoteShips)
+    void ClearWorld();
     ENetPeer* GetPeer() const { return peer; }
 
-    //TESTING
-    uint64_t getServerTimeZero() const { return serverTime; }
-    uint64_t GetClientSyncTime()
-    {
-        uint64_t clientNow = serverTime + (Time::Now() - clientTimeZero);
-        return clientNow;
-    }
+    //Estimated current server tick (fraction = part of the next tick already elapsed)
+    uint32_t ServerTick(float* fraction = nullptr) const;
+
+    //INPUT LATENCY (every input carries a sequence, the server echoes the last one it applied in our own ship update)
+    InputLatency latency;
+    void OnFramePresented(); //Once per frame after the swap, closes a pending input to screen measurement
+
+    //DEMOS (the inbound server stream recorded with keyframes, played back without a server)
+    bool StartRecording(const std::string& path, uint32_t keyframeIntervalMs = 5000); //Connected only
+    void StopRecording() { recorder.Stop(); }
+    bool Recording() const { return recorder.Recording(); }
+    bool StartPlayback(const std::string& path); //Live messages are ignored while a demo plays
+    void StopPlayback();
+    void UpdatePlayback(float dt); //Moves the virtual clock dt * playbackSpeed forward and applies what arrived until then
+    void SeekPlayback(uint32_t timeMs); //Nearest keyframe before timeMs, then every message up to it
+    bool Playing() const { return playback.IsOpen(); }
+    uint32_t PlaybackTime() const { return uint32_t(playbackClock); }
+    uint32_t PlaybackDuration() const { return playback.DurationMs(); }
+    float PlaybackRate() const { return Playing() && !playbackPaused ? playbackSpeed : 0.0f; } //Simulation seconds per real second
+    float playbackSpeed = 1.0f; //0.25 - 16
+    bool playbackPaused = false;
+    uint64_t Now() const { return Playing() ? uint64_t(playbackClock) : Time::Now(); } //Local clock (ms), virtual during playback
 
 
 private:
-    ENetHost* client;
-    ENetPeer* peer; //server peer
+    ENetHost* client = nullptr; //Only touched by the network thread while it runs
+    ENetPeer* peer = nullptr; //server peer as the network thread last reported it (Loopback::Peer() when hosting), only compared, never used
+    void SendToServer(const FlatBufferBuilder& builder); //Loopback queue or the network thread
+    void SendToServer(const BitPack::BitWriter& writer);
     bool isActive = false;
+    BitPack::WireFormat wireFormat = BitPack::WireFormat_FlatBuffers; //Agreed in ClientConnectS2C
+    BitPack::BitWriter bitWriter; //Reused for outgoing bit packed messages
+
+    struct SentInput
+    {
+        uint16_t seq = 0;
+        uint64_t sentUs = 0;
+    };
+    SentInput sentInputs[256]; //Send times by seq (ring, an ack older than 256 inputs is not measured)
+    uint16_t nextInputSeq = 1; //0 = no seq
+    uint64_t screenPendingSentUs = 0; //Send time of an acked input whose state is not on screen yet, 0 = none
+    void OnInputAck(uint16_t seq, uint16_t delay); //delay in 0.1ms
+
+    Demo::Recorder recorder;
+    Demo::Player playback;
+    double playbackClock = 0.0; //ms since the recording started
+    std::vector<uint8_t> playbackBuffer; //Aligned copy of a recorded message
+    void Receive(const uint8_t* data, size_t size, bool bitPacked, uint64_t arrivalUs); //Every inbound message, recorded when a demo is running
+    std::vector<uint8_t> BuildKeyframe() const;
+    void ApplyKeyframe(const uint8_t* data, size_t size);
+    void AdvancePlayback(double timeMs);
+    void AddShip(uint32_t uuid, const Replication::ShipState& state);
+
+    //SESSION (reconnects with the token after a drop and resumes the same player)
+    uint32_t sessionToken = 0;
+    ENetAddress serverAddress{};
+    uint64_t resumeDeadline = 0; //local time to give up reconnecting
+    const uint64_t resumeWindow = 10000; //ms, matches the servers default sv_session_grace
 
-    //time (synchronize time elapsed with server)
+    //time (synchronize with the servers tick counter)
     uint64_t currentTime = 0;
-    uint64_t serverTime = 0; //ASSIGNED IN CONNECT BUT NEVER UPDATES THE TIME AFTER
-    uint64_t clientTimeZero = 0; //client Time when it connected to server
-    uint64_t lastUpdate = 0;
+    uint64_t receiveTime = 0; //local time (ms) the message being handled arrived, stamped by the network thread
+    uint64_t receiveTimeUs = 0;
+    uint32_t syncTick = 0; //server tick at syncTime, set on connect and moved forward by newer ticks the server sends
+    uint64_t syncTime = 0; //local time (ms) of syncTick
+    uint32_t lastInputTick = 0; //input stamps never go backwards within a connection
+    const int32_t resyncTicks = 30; //estimate this far ahead of a received tick = the server stalled, sync back
+    void SyncTick(uint32_t tick); //Received at receiveTime
+    uint32_t TickAt(uint64_t time) const; //Estimated server tick at a local time
+
+    //Predicted lasers live in lasers under PREDICTED_LASER_BIT | shotSeq until the server confirms them
+    static constexpr uint32_t PREDICTED_LASER_BIT = 0x80000000u;
+    uint32_t nextShotSeq = 1;
+
+    void OnRecievepacket(const uint8_t* data);
+    void OnRecieveBitPacked(const uint8_t* data, size_t size); //Messages on BitPack::Channel
+    void ApplyServerUpdate(uint32_t uuid, const Replication::ShipState& state, uint32_t tick);
+    std::vector<uint8_t> loopbackBuffer; //Reused receive buffer for the loopback queue
+    void SpawnLaser(const Laser& laserPacket, uint32_t ownerID = 0, uint32_t shotSeq = 0); //Shared by SpawnLaserS2C and the join chunks of GameStateS2C
+    void OnConnectionLost(); //Tries to resume the session instead of dropping the world
 
-    void OnRecievepacket(ENetPacket* packet);
+    //Dense list of the remote ships, rebuilt when ships come or go (map nodes never move, the pointers stay valid until then)
+    std::vector<Game::ClientSpaceship*> remoteShips;
+    bool remoteShipsDirty = true;
+    uint32_t remoteShipsOwner = -1; //myPlayerID the list was built for
 
 };
 
@@ -0,0 +1,214 @@
+#include "config.h"
+#include "clientnetwork.h"
+#include "network.h"
+#include "timer.h"
+
+#include <cstring>
+
+void ClientNetwork::Start(ENetHost* clientHost)
+{
+	Stop();
+	host = clientHost;
+	serverPeer = nullptr;
+	events.Clear();
+	running.store(true, std::memory_order_release);
+	thread = std::thread(&ClientNetwork::Work, this);
+}
+
+void ClientNetwork::Stop()
+{
+	if (!thread.joinable()) return;
+	running.store(false, std::memory_order_release);
+	thread.join();
+	events.Clear();
+	commands.Clear();
+	host = nullptr;
+	serverPeer = nullptr;
+}
+
+#pragma region GAME LOOP
+
+void ClientNetwork::Connect(const ENetAddress& address, enet_uint32 data)
+{
+	ClientNetCommand command;
+	command.type = ClientNetCommand::Connect;
+	command.address = address;
+	command.data = data;
+	Queue(command, nullptr, 0);
+}
+
+void ClientNetwork::Send(enet_uint8 channelID, const uint8_t* data, size_t size)
+{
+	ClientNetCommand command;
+	command.type = ClientNetCommand::Send;
+	command.channelID = channelID;
+	Queue(command, data, size);
+}
+
+void ClientNetwork::Disconnect(enet_uint32 data)
+{
+	ClientNetCommand command;
+	command.type = ClientNetCommand::Disconnect;
+	command.data = data;
+	Queue(command, nullptr, 0);
+}
+
+void ClientNetwork::DisconnectNow()
+{
+	ClientNetCommand command;
+	command.type = ClientNetCommand::DisconnectNow;
+	Queue(command, nullptr, 0);
+}
+
+bool ClientNetwork::Poll(ClientNetEvent& event, const uint8_t*& payload, size_t& size)
+{
+	commands.Flush(); //Sends spilled while the thread was behind (the game loop produces that queue)
+	if (!events.Pop(polled)) return false;
+	memcpy(&event, polled.data(), sizeof(event));
+	payload = polled.data() + sizeof(event);
+	size = polled.size() - sizeof(event);
+	return true;
+}
+
+void ClientNetwork::Queue(const ClientNetCommand& command, const uint8_t* payload, size_t size)
+{
+	if (!Running()) return;
+	commandScratch.resize(sizeof(command) + size);
+	memcpy(commandScratch.data(), &command, sizeof(command));
+	if (size > 0) memcpy(commandScratch.data() + sizeof(command), payload, size);
+	commands.Push(commandScratch.data(), commandScratch.size());
+}
+
+#pragma endregion
+
+#pragma region NETWORK THREAD
+
+void ClientNetwork::Work()
+{
+	ENetEvent event;
+
+	while (running.load(std::memory_order_acquire))
+	{
+		//Everything the game loop queued since the last pass
+		while (commands.Pop(executed))
+		{
+			ClientNetCommand command;
+			memcpy(&command, executed.data(), sizeof(command));
+			Execute(command, executed.data() + sizeof(command), executed.size() - sizeof(command));
+		}
+		events.Flush();
+
+		//Sends go out here, then waits up to 1ms for datagrams and takes every event that is ready
+		int result = enet_host_service(host, &event, 1);
+		while (result > 0)
+		{
+			Forward(event);
+			result = enet_host_service(host, &event, 0);
+		}
+	}
+
+	//Whatever was queued last (a disconnect on the way out)
+	while (commands.Pop(executed))
+	{
+		ClientNetCommand command;
+		memcpy(&command, executed.data(), sizeof(command));
+		Execute(command, executed.data() + sizeof(command), executed.size() - sizeof(command));
+	}
+	enet_host_flush(host);
+}
+
+void ClientNetwork::Execute(const ClientNetCommand& command, const uint8_t* payload, size_t size)
+{
+	switch (command.type)
+	{
+		case ClientNetCommand::Send: {
+			if (serverPeer == nullptr || serverPeer->state != ENET_PEER_STATE_CONNECTED) break;
+			ENetPacket* packet = enet_packet_create(payload, size, ENET_PACKET_FLAG_RELIABLE);
+			if (enet_peer_send(serverPeer, command.channelID, packet) < 0)
+				enet_packet_destroy(packet);
+			break;
+		}
+
+		case ClientNetCommand::Connect: {
+			serverPeer = enet_host_connect(host, &command.address, BitPack::ChannelCount, command.data);
+			ClientNetEvent connecting;
+			connecting.type = ClientNetEvent::Connecting;
+			connecting.arrivalUs = Time::NowUs();
+			connecting.peer = serverPeer;
+			Publish(connecting, nullptr, 0);
+			break;
+		}
+
+		case ClientNetCommand::Disconnect: {
+			if (serverPeer != nullptr) enet_peer_disconnect(serverPeer, command.data);
+			break;
+		}
+
+		case ClientNetCommand::DisconnectNow: {
+			if (serverPeer != nullptr) enet_peer_disconnect_now(serverPeer, 0);
+			serverPeer = nullptr;
+			break;
+		}
+	}
+}
+
+void ClientNetwork::Forward(ENetEvent& event)
+{
+	ClientNetEvent forwarded;
+	forwarded.arrivalUs = Time::NowUs();
+	forwarded.peer = event.peer;
+	forwarded.data = event.data;
+
+	switch (event.type)
+	{
+		case ENET_EVENT_TYPE_RECEIVE: {
+			forwarded.type = ClientNetEvent::Receive;
+			forwarded.channelID = event.channelID;
+			const uint8_t* data = event.packet->data;
+			size_t size = event.packet->dataLength;
+			if (event.channelID == BitPack::Channel && BitPack::Embedded::Is(data, size))
+			{
+				//A FlatBuffers packet kept in order with the ship updates, from here on it is a channel 0 packet
+				data += BitPack::Embedded::offset;
+				size -= BitPack::Embedded::offset;
+				forwarded.channelID = 0;
+			}
+			if (forwarded.channelID != BitPack::Channel && Compression::IsCompressed(data, size))
+			{
+				if (!net_instance.Decompress(data, size, decompressBuffer))
+				{
+					std::cout << "CLIENT: Dropped a compressed packet we cannot read\n";
+					enet_packet_destroy(event.packet);
+					break;
+				}
+				data = decompressBuffer.data();
+				size = decompressBuffer.size();
+			}
+			Publish(forwarded, data, size);
+			enet_packet_destroy(event.packet);
+			break;
+		}
+
+		case ENET_EVENT_TYPE_DISCONNECT: {
+			//Peers we already replaced (zone handoff) disconnect quietly
+			if (event.peer != serverPeer) break;
+			serverPeer = nullptr;
+			forwarded.type = ClientNetEvent::Disconnect;
+			Publish(forwarded, nullptr, 0);
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+void ClientNetwork::Publish(const ClientNetEvent& event, const uint8_t* payload, size_t size)
+{
+	eventScratch.resize(sizeof(event) + size);
+	memcpy(eventScratch.data(), &event, sizeof(event));
+	if (size > 0) memcpy(eventScratch.data() + sizeof(event), payload, size);
+	events.Push(eventScratch.data(), eventScratch.size());
+}
+
+#pragma endregion
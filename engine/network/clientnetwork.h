@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include "enet/enet.h"
+#include "loopback.h"
+
+/*
+* CLIENT NETWORK THREAD
+*	- ONCE STARTED THE CLIENTS ENET HOST IS ONLY EVER TOUCHED BY THIS THREAD (SERVICE, CONNECT, SEND, DISCONNECT, DECOMPRESS)
+*	- EVERY EVENT IS TIMESTAMPED WHEN ENET HANDS IT OUT, NOT WHEN THE GAME LOOP GETS TO IT
+*	- EVENTS GO TO THE GAME LOOP AND SENDS COME BACK THROUGH LOCK FREE QUEUES (LoopbackQueue, ONE PRODUCER / ONE CONSUMER EACH)
+*	- A QUEUED SEND LEAVES WITHIN ~1MS (THE SERVICE WAIT) INSTEAD OF AT THE START OF THE NEXT FRAME
+*/
+
+//Queue entry header, the payload follows it (the size keeps FlatBuffers payloads aligned)
+struct ClientNetEvent
+{
+	enum Type : uint8_t
+	{
+		Receive, //payload = message, decompressed
+		Connecting, //peer = the connection attempt (nullptr: ENet had no free peer)
+		Disconnect //the current server peer dropped or refused us
+	};
+
+	Type type = Receive;
+	enet_uint8 channelID = 0;
+	uint16_t padding = 0;
+	enet_uint32 data = 0;
+	uint64_t arrivalUs = 0; //Time::NowUs when ENet returned the event
+	ENetPeer* peer = nullptr;
+	uint64_t reserved = 0;
+};
+static_assert(sizeof(ClientNetEvent) % 16 == 0, "payloads after the header must stay aligned");
+
+struct ClientNetCommand
+{
+	enum Type : uint8_t { Send, Connect, Disconnect, DisconnectNow };
+
+	Type type = Send;
+	enet_uint8 channelID = 0;
+	uint16_t padding = 0;
+	enet_uint32 data = 0; //Connect / disconnect data
+	ENetAddress address{};
+};
+
+class ClientNetwork
+{
+public:
+	static ClientNetwork& Instance()
+	{
+		static ClientNetwork instance;
+		return instance;
+	}
+
+	~ClientNetwork() { Stop(); }
+
+	void Start(ENetHost* host); //The host belongs to the thread from here on
+	void Stop(); //Joins, the host is the callers again (queued sends are flushed, unread events dropped)
+	bool Running() const { return thread.joinable(); }
+
+	//Game loop (commands work on the thread's current server peer)
+	void Connect(const ENetAddress& address, enet_uint32 data);
+	void Send(enet_uint8 channelID, const uint8_t* data, size_t size);
+	void Disconnect(enet_uint32 data);
+	void DisconnectNow(); //No disconnect event follows
+	bool Poll(ClientNetEvent& event, const uint8_t*& payload, size_t& size); //Next event, the payload stays valid until the next Poll
+
+private:
+	void Work();
+	void Execute(const ClientNetCommand& command, const uint8_t* payload, size_t size);
+	void Forward(ENetEvent& event);
+	void Publish(const ClientNetEvent& event, const uint8_t* payload, size_t size); //Network thread
+	void Queue(const ClientNetCommand& command, const uint8_t* payload, size_t size); //Game loop
+
+	ENetHost* host = nullptr;
+	ENetPeer* serverPeer = nullptr; //Network thread only
+	std::thread thread;
+	std::atomic<bool> running = false;
+
+	LoopbackQueue events; //Network thread -> game loop
+	LoopbackQueue commands; //Game loop -> network thread
+	std::vector<uint8_t> eventScratch; //Network thread, header + payload being pushed
+	std::vector<uint8_t> commandScratch; //Game loop
+	std::vector<uint8_t> polled; //Game loop, entry the last Poll returned
+	std::vector<uint8_t> executed; //Network thread, command being executed
+	std::vector<uint8_t> decompressBuffer; //Network thread
+};
@@ -0,0 +1,486 @@
+#include "config.h"
+#include "compression.h"
+#include "proto.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+namespace Compression
+{
+
+static constexpr uint8_t Codec_LZ = 1;
+static constexpr uint8_t Marker = 0xFF; //Byte 3 of the header, the high byte of a flatbuffer root offset is never 0xFF
+static constexpr size_t MinMatch = 4;
+static constexpr size_t MaxOffset = 0xFFFF;
+static constexpr uint32_t HashBits = 12;
+
+static uint32_t
+Hash4(const uint8_t* p)
+{
+	uint32_t v;
+	std::memcpy(&v, p, 4);
+	return (v * 2654435761u) >> (32 - HashBits);
+}
+
+//The dictionary part of the match table only changes with the dictionary, keep it per thread and copy it for every payload
+struct MatchTable
+{
+	const uint8_t* dictionary = nullptr;
+	size_t dictionarySize = 0;
+	uint32_t primed[1 << HashBits];
+	uint32_t table[1 << HashBits];
+	std::vector<uint8_t> window; //dictionary || payload
+};
+
+static void
+WriteLength(uint8_t*& op, size_t length)
+{
+	while (length >= 255) { *op++ = 255; length -= 255; }
+	*op++ = uint8_t(length);
+}
+
+//------------------------------------------------------------------------------
+/**
+	LZ4 block style: token (literal length << 4 | match length - 4), length extensions of 255 runs,
+	literals, 16 bit offset. Offsets count back over the payload and then into the dictionary.
+	Returns 0 when the output does not fit.
+*/
+size_t
+Compress(const std::vector<uint8_t>& dictionary, const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity)
+{
+	static thread_local MatchTable match;
+
+	const size_t dictionarySize = std::min(dictionary.size(), MaxOffset);
+	const uint8_t* dictionaryStart = dictionary.data() + (dictionary.size() - dictionarySize);
+	if (dictionarySize > 0)
+	{
+		if (match.dictionary != dictionaryStart || match.dictionarySize != dictionarySize)
+		{
+			match.dictionary = dictionaryStart;
+			match.dictionarySize = dictionarySize;
+			std::fill(std::begin(match.primed), std::end(match.primed), UINT32_MAX);
+			for (size_t i = 0; i + MinMatch <= dictionarySize; i++)
+				match.primed[Hash4(dictionaryStart + i)] = uint32_t(i);
+		}
+		std::memcpy(match.table, match.primed, sizeof(match.table));
+	}
+	//Without a dictionary the table keeps the last payloads entries, every candidate is verified below anyway
+
+	match.window.resize(dictionarySize + srcSize);
+	if (dictionarySize > 0) std::memcpy(match.window.data(), dictionaryStart, dictionarySize);
+	std::memcpy(match.window.data() + dictionarySize, src, srcSize);
+
+	const uint8_t* window = match.window.data();
+	const size_t end = dictionarySize + srcSize;
+	uint8_t* op = dst;
+	uint8_t* const opEnd = dst + dstCapacity;
+
+	size_t anchor = dictionarySize;
+	size_t ip = dictionarySize;
+	while (ip + MinMatch <= end)
+	{
+		const uint32_t h = Hash4(window + ip);
+		const uint32_t candidate = match.table[h];
+		match.table[h] = uint32_t(ip);
+		if (candidate >= ip || ip - candidate > MaxOffset || std::memcmp(window + candidate, window + ip, MinMatch) != 0)
+		{
+			ip++;
+			continue;
+		}
+
+		size_t matchLength = MinMatch;
+		while (ip + matchLength < end && window[candidate + matchLength] == window[ip + matchLength]) matchLength++;
+
+		const size_t literals = ip - anchor;
+		if (op + 1 + literals / 255 + 1 + literals + 2 + (matchLength - MinMatch) / 255 + 1 > opEnd) return 0;
+
+		uint8_t* token = op++;
+		*token = uint8_t((std::min<size_t>(literals, 15) << 4) | std::min<size_t>(matchLength - MinMatch, 15));
+		if (literals >= 15) WriteLength(op, literals - 15);
+		std::memcpy(op, window + anchor, literals);
+		op += literals;
+
+		const size_t offset = ip - candidate;
+		*op++ = uint8_t(offset);
+		*op++ = uint8_t(offset >> 8);
+		if (matchLength - MinMatch >= 15) WriteLength(op, matchLength - MinMatch - 15);
+
+		for (size_t i = ip + 1; i + MinMatch <= end && i < ip + matchLength; i += 2) //Sparse insert inside the match, cheap and good enough
+			match.table[Hash4(window + i)] = uint32_t(i);
+		ip += matchLength;
+		anchor = ip;
+	}
+
+	//Last sequence is literals only
+	const size_t literals = end - anchor;
+	if (op + 1 + literals / 255 + 1 + literals > opEnd) return 0;
+	uint8_t* token = op++;
+	*token = uint8_t(std::min<size_t>(literals, 15) << 4);
+	if (literals >= 15) WriteLength(op, literals - 15);
+	std::memcpy(op, window + anchor, literals);
+	op += literals;
+	return size_t(op - dst);
+}
+
+static bool
+ReadLength(const uint8_t*& ip, const uint8_t* ipEnd, size_t& length)
+{
+	uint8_t b;
+	do
+	{
+		if (ip >= ipEnd) return false;
+		b = *ip++;
+		length += b;
+	} while (b == 255);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+	Every read and write is bounds checked, returns 0 on a corrupt payload.
+*/
+size_t
+Decompress(const std::vector<uint8_t>& dictionary, const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+{
+	const size_t dictionarySize = std::min(dictionary.size(), MaxOffset);
+	const uint8_t* dictionaryEnd = dictionary.data() + dictionary.size();
+	const uint8_t* ip = src;
+	const uint8_t* const ipEnd = src + srcSize;
+	uint8_t* op = dst;
+	uint8_t* const opEnd = dst + dstSize;
+
+	while (ip < ipEnd)
+	{
+		const uint8_t token = *ip++;
+		size_t literals = token >> 4;
+		if (literals == 15 && !ReadLength(ip, ipEnd, literals)) return 0;
+		if (size_t(ipEnd - ip) < literals || size_t(opEnd - op) < literals) return 0;
+		std::memcpy(op, ip, literals);
+		ip += literals;
+		op += literals;
+		if (ip == ipEnd) break; //Last sequence
+
+		if (ipEnd - ip < 2) return 0;
+		const size_t offset = size_t(ip[0]) | (size_t(ip[1]) << 8);
+		ip += 2;
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !ReadLength(ip, ipEnd, matchLength)) return 0;
+		matchLength += MinMatch;
+
+		const size_t produced = size_t(op - dst);
+		if (offset == 0 || offset > produced + dictionarySize || size_t(opEnd - op) < matchLength) return 0;
+		if (offset > produced)
+		{
+			//Starts in the dictionary, may run on into the payload
+			const size_t fromDictionary = std::min(offset - produced, matchLength);
+			std::memcpy(op, dictionaryEnd - (offset - produced), fromDictionary);
+			op += fromDictionary;
+			matchLength -= fromDictionary;
+		}
+		for (size_t i = 0; i < matchLength; i++, op++) *op = *(op - offset); //Overlapping copies repeat the pattern
+	}
+	return size_t(op - dst);
+}
+
+uint16_t
+DictionaryID(const std::vector<uint8_t>& dictionary)
+{
+	if (dictionary.empty()) return 0;
+	uint32_t h = 2166136261u; //FNV-1a
+	for (const uint8_t b : dictionary) h = (h ^ b) * 16777619u;
+	const uint16_t id = uint16_t(h ^ (h >> 16));
+	return id == 0 ? 1 : id;
+}
+
+bool
+IsCompressed(const uint8_t* data, size_t size)
+{
+	return size >= HeaderSize && data[3] == Marker;
+}
+
+//------------------------------------------------------------------------------
+/**
+	Cover style selection: the samples are split in one epoch per dictionary segment,
+	every epoch contributes its segment with the most (not yet covered) frequent k-mers.
+	Chosen k-mers are zeroed so later segments pick up different content.
+*/
+std::vector<uint8_t>
+TrainDictionary(const std::vector<std::vector<uint8_t>>& samples, size_t dictionarySize)
+{
+	constexpr size_t K = 8;
+	constexpr size_t SegmentSize = 64;
+
+	auto kmer = [](const uint8_t* p) { uint64_t v; std::memcpy(&v, p, K); return v; };
+
+	//Count in how many samples a k-mer shows up (repeats inside one sample are already handled by the LZ window)
+	std::unordered_map<uint64_t, uint32_t> frequency;
+	std::unordered_map<uint64_t, size_t> lastSample;
+	for (size_t s = 0; s < samples.size(); s++)
+	{
+		const std::vector<uint8_t>& sample = samples[s];
+		for (size_t i = 0; i + K <= sample.size(); i++)
+		{
+			const uint64_t key = kmer(sample.data() + i);
+			auto it = lastSample.find(key);
+			if (it != lastSample.end() && it->second == s) continue;
+			lastSample[key] = s;
+			frequency[key]++;
+		}
+	}
+
+	const size_t segments = std::max<size_t>(1, dictionarySize / SegmentSize);
+	const size_t epochSize = std::max<size_t>(1, samples.size() / segments);
+	std::vector<std::pair<uint64_t, std::vector<uint8_t>>> chosen; //score, segment
+	std::vector<uint64_t> prefix;
+	size_t total = 0;
+
+	for (size_t epoch = 0; epoch * epochSize < samples.size() && total < dictionarySize; epoch++)
+	{
+		uint64_t bestScore = 0;
+		const std::vector<uint8_t>* bestSample = nullptr;
+		size_t bestStart = 0;
+
+		const size_t last = std::min(samples.size(), (epoch + 1) * epochSize);
+		for (size_t s = epoch * epochSize; s < last; s++)
+		{
+			const std::vector<uint8_t>& sample = samples[s];
+			if (sample.size() < SegmentSize) continue;
+			const size_t kmers = sample.size() - K + 1;
+			prefix.assign(kmers + 1, 0);
+			for (size_t i = 0; i < kmers; i++)
+			{
+				auto it = frequency.find(kmer(sample.data() + i));
+				const uint32_t f = it == frequency.end() ? 0 : it->second;
+				prefix[i + 1] = prefix[i] + (f > 1 ? f : 0); //k-mers of a single sample never help
+			}
+			const size_t window = SegmentSize - K + 1;
+			for (size_t start = 0; start + window <= kmers; start++)
+			{
+				const uint64_t score = prefix[start + window] - prefix[start];
+				if (score > bestScore) { bestScore = score; bestSample = &sample; bestStart = start; }
+			}
+		}
+		if (bestSample == nullptr) continue;
+
+		chosen.emplace_back(bestScore, std::vector<uint8_t>(bestSample->begin() + bestStart, bestSample->begin() + bestStart + SegmentSize));
+		for (size_t i = 0; i + K <= SegmentSize; i++)
+			frequency[kmer(bestSample->data() + bestStart + i)] = 0;
+		total += SegmentSize;
+	}
+
+	//Best segments last, they get the shortest offsets (and survive the trim)
+	std::stable_sort(chosen.begin(), chosen.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+	std::vector<uint8_t> dictionary;
+	dictionary.reserve(total);
+	for (const auto& [score, segment] : chosen)
+		dictionary.insert(dictionary.end(), segment.begin(), segment.end());
+	if (dictionary.size() > dictionarySize)
+		dictionary.erase(dictionary.begin(), dictionary.begin() + (dictionary.size() - dictionarySize));
+	return dictionary;
+}
+
+bool
+ReadCapture(const char* path, std::vector<std::vector<uint8_t>>& samples)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == nullptr) return false;
+	uint32_t size;
+	while (fread(&size, sizeof(size), 1, file) == 1)
+	{
+		std::vector<uint8_t> sample(size);
+		if (size > MaxPayload || fread(sample.data(), 1, size, file) != size) break; //Truncated capture, keep what we have
+		samples.push_back(std::move(sample));
+	}
+	fclose(file);
+	return true;
+}
+
+} // namespace Compression
+
+void
+CompressionStats::Reset()
+{
+	for (Entry& e : entries)
+	{
+		e.messages = 0;
+		e.rawBytes = 0;
+		e.compressedBytes = 0;
+		e.compressNs = 0;
+		e.decompressed = 0;
+		e.decompressNs = 0;
+	}
+}
+
+static uint64_t
+NowNs()
+{
+	return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static int
+StatsSlot(const uint8_t* data)
+{
+	const int type = int(Protocol::GetPacketWrapper(data)->packet_type());
+	return std::clamp(type, 0, CompressionStats::DatagramSlot - 1);
+}
+
+bool
+PayloadCompressor::LoadDictionary(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == nullptr) return false;
+	std::vector<uint8_t> loaded;
+	uint8_t chunk[4096];
+	size_t read;
+	while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+		loaded.insert(loaded.end(), chunk, chunk + read);
+	fclose(file);
+
+	dictionary = std::move(loaded);
+	dictionaryID = Compression::DictionaryID(dictionary);
+	std::cout << "NETWORK: Loaded compression dictionary " << path << " (" << dictionary.size() << " bytes, id " << dictionaryID << ")\n";
+	return true;
+}
+
+bool
+PayloadCompressor::Compress(const uint8_t* data, size_t size, bool useDictionary, std::vector<uint8_t>& out)
+{
+	if (size < threshold || size > Compression::MaxPayload) return false;
+
+	static const std::vector<uint8_t> noDictionary;
+	const std::vector<uint8_t>& dict = useDictionary ? dictionary : noDictionary;
+	const uint16_t id = useDictionary ? dictionaryID : 0;
+
+	const uint64_t start = NowNs();
+	out.resize(Compression::HeaderSize + size);
+	const size_t compressed = Compression::Compress(dict, data, size, out.data() + Compression::HeaderSize, size - 1);
+	const bool smaller = compressed != 0 && Compression::HeaderSize + compressed < size;
+
+	CompressionStats::Entry& entry = stats.entries[StatsSlot(data)];
+	entry.messages++;
+	entry.rawBytes += size;
+	entry.compressedBytes += smaller ? Compression::HeaderSize + compressed : size;
+	entry.compressNs += NowNs() - start;
+	if (!smaller) return false;
+
+	out[0] = uint8_t(id);
+	out[1] = uint8_t(id >> 8);
+	out[2] = Compression::Codec_LZ;
+	out[3] = Compression::Marker;
+	out[4] = uint8_t(size);
+	out[5] = uint8_t(size >> 8);
+	out.resize(Compression::HeaderSize + compressed);
+	return true;
+}
+
+bool
+PayloadCompressor::Decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+{
+	if (!Compression::IsCompressed(data, size) || data[2] != Compression::Codec_LZ) return false;
+	const uint16_t id = uint16_t(data[0] | (data[1] << 8));
+	if (id != 0 && id != dictionaryID) return false; //Server used a dictionary we do not have
+
+	static const std::vector<uint8_t> noDictionary;
+	const size_t rawSize = size_t(data[4]) | (size_t(data[5]) << 8);
+	const uint64_t start = NowNs();
+	out.resize(rawSize);
+	if (Compression::Decompress(id != 0 ? dictionary : noDictionary, data + Compression::HeaderSize, size - Compression::HeaderSize, out.data(), rawSize) != rawSize)
+		return false;
+
+	CompressionStats::Entry& entry = stats.entries[StatsSlot(out.data())];
+	entry.decompressed++;
+	entry.decompressNs += NowNs() - start;
+	return true;
+}
+
+bool
+PayloadCompressor::StartCapture(const char* path)
+{
+	StopCapture();
+	capture = fopen(path, "wb");
+	if (capture == nullptr) return false;
+	std::cout << "NETWORK: Capturing sent payloads to " << path << "\n";
+	return true;
+}
+
+void
+PayloadCompressor::StopCapture()
+{
+	if (capture == nullptr) return;
+	fclose(capture);
+	capture = nullptr;
+}
+
+void
+PayloadCompressor::Capture(const uint8_t* data, size_t size)
+{
+	if (capture == nullptr) return;
+	const uint32_t length = uint32_t(size);
+	fwrite(&length, sizeof(length), 1, capture);
+	fwrite(data, 1, size, capture);
+}
+
+// ==========================
+// ENet range coder with stats
+// ==========================
+struct RangeCoderContext
+{
+	void* coder = nullptr;
+	CompressionStats* stats = nullptr;
+	bool decompressOnly = false;
+};
+
+static size_t
+RangeCoderCompress(void* context, const ENetBuffer* inBuffers, size_t inBufferCount, size_t inLimit, enet_uint8* outData, size_t outLimit)
+{
+	RangeCoderContext* ctx = static_cast<RangeCoderContext*>(context);
+	if (ctx->decompressOnly) return 0; //0 = ENet sends the datagram as is
+
+	const uint64_t start = NowNs();
+	const size_t compressed = enet_range_coder_compress(ctx->coder, inBuffers, inBufferCount, inLimit, outData, outLimit);
+	CompressionStats::Entry& entry = ctx->stats->entries[CompressionStats::DatagramSlot];
+	entry.messages++;
+	entry.rawBytes += inLimit;
+	entry.compressedBytes += compressed != 0 ? compressed : inLimit;
+	entry.compressNs += NowNs() - start;
+	return compressed;
+}
+
+static size_t
+RangeCoderDecompress(void* context, const enet_uint8* inData, size_t inLimit, enet_uint8* outData, size_t outLimit)
+{
+	RangeCoderContext* ctx = static_cast<RangeCoderContext*>(context);
+	const uint64_t start = NowNs();
+	const size_t size = enet_range_coder_decompress(ctx->coder, inData, inLimit, outData, outLimit);
+	CompressionStats::Entry& entry = ctx->stats->entries[CompressionStats::DatagramSlot];
+	entry.decompressed++;
+	entry.decompressNs += NowNs() - start;
+	return size;
+}
+
+static void
+RangeCoderDestroy(void* context)
+{
+	RangeCoderContext* ctx = static_cast<RangeCoderContext*>(context);
+	enet_range_coder_destroy(ctx->coder);
+	delete ctx;
+}
+
+void
+InstallRangeCoder(ENetHost* host, CompressionStats* stats, bool decompressOnly)
+{
+	RangeCoderContext* ctx = new RangeCoderContext();
+	ctx->coder = enet_range_coder_create();
+	ctx->stats = stats;
+	ctx->decompressOnly = decompressOnly;
+
+	ENetCompressor compressor;
+	compressor.context = ctx;
+	compressor.compress = RangeCoderCompress;
+	compressor.decompress = RangeCoderDecompress;
+	compressor.destroy = RangeCoderDestroy;
+	enet_host_compress(host, &compressor);
+}
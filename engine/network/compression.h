@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "enet/enet.h"
+
+/*
+* PAYLOAD COMPRESSION
+*	- MODE IS PER HOST: OFF, ENET RANGE CODER (WHOLE DATAGRAMS) OR DICTIONARY LZ (SINGLE PAYLOADS ABOVE A SIZE THRESHOLD)
+*	- DICTIONARY PAYLOADS START WITH A 4 BYTE HEADER ENDING IN 0xFF, A FLATBUFFER ROOT OFFSET NEVER DOES (PACKETS ARE FAR BELOW 16MB)
+*	- THE DICTIONARY IS TRAINED OFFLINE FROM CAPTURED SNAPSHOT TRAFFIC (projects/dicttrainer)
+*	- PAYLOADS ARE ONLY COMPRESSED WITH THE DICTIONARY FOR PEERS THAT REPORTED THE SAME ONE (ClientHelloC2S), OTHERS GET PLAIN LZ
+*/
+
+enum CompressionMode : uint8_t
+{
+	CompressionMode_Off = 0,
+	CompressionMode_RangeCoder = 1,
+	CompressionMode_Dictionary = 2
+};
+
+namespace Compression
+{
+	constexpr const char* DefaultDictionaryPath = "assets/network/snapshot.dict";
+	constexpr size_t HeaderSize = 6; //dictionary id (2), codec (1), marker (1), raw size (2)
+	constexpr size_t MaxPayload = 0xFFFF;
+
+	//LZ block codec with a preset dictionary (matches may reach back into the dictionary)
+	size_t Compress(const std::vector<uint8_t>& dictionary, const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity);
+	size_t Decompress(const std::vector<uint8_t>& dictionary, const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+
+	uint16_t DictionaryID(const std::vector<uint8_t>& dictionary); //0 = no dictionary
+	bool IsCompressed(const uint8_t* data, size_t size);
+
+	//Picks the segments of the samples that repeat the most across samples (most useful ones last, closest to the payload)
+	std::vector<uint8_t> TrainDictionary(const std::vector<std::vector<uint8_t>>& samples, size_t dictionarySize);
+	//Capture files are a list of [uint32 size][payload]
+	bool ReadCapture(const char* path, std::vector<std::vector<uint8_t>>& samples);
+}
+
+//Counters per message type, written by the network threads and read by the UI
+struct CompressionStats
+{
+	static constexpr int Slots = 32; //PacketType values + the datagram row of the range coder
+	static constexpr int DatagramSlot = Slots - 1;
+
+	struct Entry
+	{
+		std::atomic<uint64_t> messages = 0;
+		std::atomic<uint64_t> rawBytes = 0;
+		std::atomic<uint64_t> compressedBytes = 0;
+		std::atomic<uint64_t> compressNs = 0;
+		std::atomic<uint64_t> decompressed = 0;
+		std::atomic<uint64_t> decompressNs = 0;
+	};
+	Entry entries[Slots];
+
+	void Reset();
+};
+
+class PayloadCompressor
+{
+public:
+	bool LoadDictionary(const char* path);
+	const std::vector<uint8_t>& Dictionary() const { return dictionary; }
+	uint16_t DictionaryID() const { return dictionaryID; }
+
+	//Sender side: true when out holds a smaller compressed payload, false to send the input as is
+	bool Compress(const uint8_t* data, size_t size, bool useDictionary, std::vector<uint8_t>& out);
+	//Receiver side: false when the payload is corrupt or needs a dictionary we do not have
+	bool Decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+	bool StartCapture(const char* path);
+	void StopCapture();
+	void Capture(const uint8_t* data, size_t size);
+
+	std::atomic<size_t> threshold = 96; //Smaller payloads are never worth the header (set by the simulation, read by senders)
+	CompressionStats stats;
+
+private:
+	std::vector<uint8_t> dictionary;
+	uint16_t dictionaryID = 0;
+	FILE* capture = nullptr;
+};
+
+//ENet compressor around enet_range_coder_* that records the datagram stats
+void InstallRangeCoder(ENetHost* host, CompressionStats* stats, bool decompressOnly);
@@ -0,0 +1,142 @@
+#include "config.h"
+#include "demo.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace Demo
+{
+
+#pragma region RECORDER
+
+bool Recorder::Start(const std::string& path, uint64_t now, uint32_t keyframeIntervalMs)
+{
+	Stop();
+	file = fopen(path.c_str(), "wb");
+	if (file == nullptr) return false;
+
+	FileHeader header;
+	header.keyframeIntervalMs = keyframeIntervalMs;
+	fwrite(&header, sizeof(header), 1, file);
+	startTime = now;
+	lastTime = 0;
+	nextKeyframe = now; //The caller writes the first keyframe right away
+	keyframeInterval = keyframeIntervalMs;
+	return true;
+}
+
+void Recorder::Stop()
+{
+	if (file == nullptr) return;
+	fclose(file);
+	file = nullptr;
+}
+
+void Recorder::Add(RecordType type, const uint8_t* data, size_t size, uint64_t now)
+{
+	if (file == nullptr) return;
+	lastTime = std::max(lastTime, now > startTime ? uint32_t(now - startTime) : 0u);
+	const uint32_t time = lastTime;
+	const uint32_t length = uint32_t(size);
+	uint8_t header[RecordHeaderSize];
+	memcpy(header, &time, 4);
+	header[4] = type;
+	memcpy(header + 5, &length, 4);
+	fwrite(header, 1, sizeof(header), file);
+	fwrite(data, 1, size, file);
+}
+
+void Recorder::AddKeyframe(const std::vector<uint8_t>& keyframe, uint64_t now)
+{
+	Add(Record_Keyframe, keyframe.data(), keyframe.size(), now);
+	nextKeyframe = now + keyframeInterval;
+}
+
+#pragma endregion
+
+#pragma region PLAYER
+
+bool Player::Open(const std::string& path)
+{
+	Close();
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == nullptr) return false;
+	fseek(file, 0, SEEK_END);
+	const long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	std::vector<uint8_t> loaded(length > 0 ? size_t(length) : 0);
+	const bool read = !loaded.empty() && fread(loaded.data(), 1, loaded.size(), file) == loaded.size();
+	fclose(file);
+
+	FileHeader header;
+	if (!read || loaded.size() < sizeof(header)) return false;
+	memcpy(&header, loaded.data(), sizeof(header));
+	if (header.magic != Magic || header.version != Version) return false;
+
+	bytes = std::move(loaded);
+	Record record;
+	size_t offset = sizeof(FileHeader), end = 0;
+	while (ReadAt(offset, record, end))
+	{
+		if (record.type == Record_Keyframe)
+			keyframes.push_back(offset);
+		duration = record.timeMs;
+		offset = end;
+	}
+	if (offset != bytes.size())
+		std::cout << "DEMO: " << path << " ends in a partial record (recording was cut off), playing up to " << duration << "ms\n";
+	if (keyframes.empty())
+	{
+		Close();
+		return false;
+	}
+	cursor = keyframes.front();
+	return true;
+}
+
+void Player::Close()
+{
+	bytes.clear();
+	keyframes.clear();
+	duration = 0;
+	cursor = 0;
+	next = 0;
+}
+
+bool Player::ReadAt(size_t offset, Record& record, size_t& end) const
+{
+	if (offset + RecordHeaderSize > bytes.size()) return false;
+	uint32_t length = 0;
+	memcpy(&record.timeMs, bytes.data() + offset, 4);
+	record.type = RecordType(bytes[offset + 4]);
+	memcpy(&length, bytes.data() + offset + 5, 4);
+	if (length > bytes.size() - offset - RecordHeaderSize) return false;
+	record.data = bytes.data() + offset + RecordHeaderSize;
+	record.size = length;
+	end = offset + RecordHeaderSize + length;
+	return true;
+}
+
+bool Player::Peek(Record& record) const
+{
+	return ReadAt(cursor, record, next);
+}
+
+void Player::SeekKeyframe(uint32_t timeMs)
+{
+	if (keyframes.empty()) return;
+	//Keyframe times only grow, the last one not after the target
+	Record record;
+	size_t end = 0;
+	auto found = std::upper_bound(keyframes.begin(), keyframes.end(), timeMs, [&](uint32_t time, size_t offset)
+	{
+		ReadAt(offset, record, end);
+		return time < record.timeMs;
+	});
+	cursor = found == keyframes.begin() ? keyframes.front() : *(found - 1);
+}
+
+#pragma endregion
+
+}
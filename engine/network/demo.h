@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*
+* CLIENT DEMO FILES
+*	- THE INBOUND SERVER STREAM AS THE CLIENT SAW IT: EVERY MESSAGE (DECOMPRESSED) WITH ITS LOCAL ARRIVAL TIME
+*	- A KEYFRAME (THE CLIENTS WHOLE WORLD AS PLAIN RECORDS) AT THE START AND EVERY keyframeIntervalMs, PLAYBACK CAN START AT ANY OF THEM
+*	- SEEKING = RESTORE THE LAST KEYFRAME BEFORE THE TARGET, THEN APPLY THE MESSAGES UP TO IT WITHOUT RENDERING
+*	- PLAYBACK RUNS ON A VIRTUAL CLOCK (GameClient::Now), SPEED ONLY SCALES HOW FAST THAT CLOCK MOVES
+*/
+
+namespace Demo
+{
+	constexpr uint32_t Magic = 0x4D444753; //"SGDM"
+	constexpr uint32_t Version = 1;
+
+	enum RecordType : uint8_t
+	{
+		Record_Message = 0, //FlatBuffers PacketWrapper
+		Record_BitPacked = 1, //BitPack::Channel message
+		Record_Keyframe = 2 //KeyframeHeader + ShipRecords + LaserRecords
+	};
+
+	struct FileHeader
+	{
+		uint32_t magic = Magic;
+		uint32_t version = Version;
+		uint32_t keyframeIntervalMs = 0;
+		uint32_t reserved = 0;
+	};
+
+	//On disk every record is: uint32 time (ms since the recording started), uint8 RecordType, uint32 size, payload
+	constexpr size_t RecordHeaderSize = 9;
+
+	struct Record
+	{
+		uint32_t timeMs = 0;
+		RecordType type = Record_Message;
+		const uint8_t* data = nullptr;
+		uint32_t size = 0;
+	};
+
+	//KEYFRAME RECORDS (plain data, written and read as they are in memory)
+	struct KeyframeHeader
+	{
+		uint32_t syncTick; //the clients clock sync (GameClient::syncTick, syncAgeMs before the keyframe)
+		uint32_t syncAgeMs;
+		uint32_t playerID; //the recording clients own ship
+		uint32_t shipCount;
+		uint32_t laserCount;
+	};
+
+	struct ShipRecord
+	{
+		uint32_t uuid;
+		uint32_t intervalMs;
+		float position[3];
+		float velocity[3];
+		float orientation[4]; //w, x, y, z
+	};
+
+	struct LaserRecord
+	{
+		uint32_t uuid;
+		uint32_t ownerID;
+		uint32_t startTime; //tick
+		uint32_t endTime;
+		float origin[3];
+		float orientation[4]; //w, x, y, z
+	};
+
+	class Recorder
+	{
+	public:
+		~Recorder() { Stop(); }
+
+		bool Start(const std::string& path, uint64_t now, uint32_t keyframeIntervalMs);
+		void Stop();
+		bool Recording() const { return file != nullptr; }
+
+		void Add(RecordType type, const uint8_t* data, size_t size, uint64_t now);
+		bool KeyframeDue(uint64_t now) const { return file != nullptr && now >= nextKeyframe; }
+		void AddKeyframe(const std::vector<uint8_t>& keyframe, uint64_t now);
+
+	private:
+		FILE* file = nullptr;
+		uint64_t startTime = 0;
+		uint64_t nextKeyframe = 0;
+		uint32_t lastTime = 0; //Record times never go backwards (arrival stamps can trail the frame clock a little)
+		uint32_t keyframeInterval = 0;
+	};
+
+	//Whole file in memory, keyframes indexed on open
+	class Player
+	{
+	public:
+		bool Open(const std::string& path); //False: missing, wrong magic / version or truncated
+		void Close();
+		bool IsOpen() const { return !bytes.empty(); }
+
+		uint32_t DurationMs() const { return duration; }
+		size_t KeyframeCount() const { return keyframes.size(); }
+
+		bool Peek(Record& record) const; //Record at the cursor, false at the end
+		void Skip() { cursor = next; }
+		void SeekKeyframe(uint32_t timeMs); //Cursor to the last keyframe at or before timeMs (the first one when there is none)
+
+	private:
+		bool ReadAt(size_t offset, Record& record, size_t& end) const;
+
+		std::vector<uint8_t> bytes;
+		std::vector<size_t> keyframes; //offsets, in time order
+		uint32_t duration = 0;
+		size_t cursor = 0;
+		mutable size_t next = 0; //end of the record Peek returned
+	};
+}
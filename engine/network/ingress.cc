@@ -0,0 +1,288 @@
+#include "config.h"
+#include "ingress.h"
+
+#include <iostream>
+
+bool Ingress::Start(uint16_t port, int workerCount, size_t peersPerHost, size_t channelLimit)
+{
+	Stop();
+
+	ENetAddress address;
+	address.host = ENET_HOST_ANY;
+	address.port = port;
+
+	for (int i = 0; i < workerCount; ++i)
+	{
+		ENetHost* host = enet_host_create_shared(&address, peersPerHost, channelLimit, 0, 0, 1);
+		if (host == nullptr)
+		{
+			std::cout << "INGRESS: Failed to open host " << i << " on port " << port << " with SO_REUSEPORT\n";
+			for (auto& worker : workers)
+				enet_host_destroy(worker->host);
+			workers.clear();
+			return false;
+		}
+		workers.push_back(std::make_unique<IngressWorker>(host));
+	}
+
+	running.store(true, std::memory_order_release);
+	for (auto& worker : workers)
+		worker->thread = std::thread(&Ingress::Work, this, std::ref(*worker));
+
+	std::cout << "INGRESS: " << workers.size() << " hosts share port " << port << "\n";
+	return true;
+}
+
+void Ingress::Stop()
+{
+	if (workers.empty()) return;
+
+	running.store(false, std::memory_order_release);
+	for (auto& worker : workers)
+		if (worker->thread.joinable()) worker->thread.join();
+
+	//The workers are gone, their hosts can be torn down from here
+	for (auto& worker : workers)
+	{
+		net_instance.ForgetHost(worker->host);
+		enet_host_destroy(worker->host);
+	}
+	workers.clear();
+	connectIDs.clear();
+}
+
+bool Ingress::Owns(const ENetHost* host) const
+{
+	return WorkerOf(host) != nullptr;
+}
+
+IngressWorker* Ingress::WorkerOf(const ENetHost* host) const
+{
+	if (host == nullptr) return nullptr;
+	for (const auto& worker : workers)
+		if (worker->host == host) return worker.get();
+	return nullptr;
+}
+
+#pragma region SIMULATION THREAD
+
+void Ingress::Drain(std::vector<IngressEvent>& out)
+{
+	const size_t first = out.size();
+	for (auto& worker : workers)
+	{
+		std::lock_guard<std::mutex> lock(worker->eventMutex);
+		for (IngressEvent& event : worker->events)
+			out.push_back(std::move(event));
+		worker->events.clear();
+	}
+
+	//Sends are only queued for connections the simulation knows about
+	for (size_t i = first; i < out.size(); ++i)
+	{
+		if (out[i].type == ENET_EVENT_TYPE_CONNECT)
+			connectIDs[out[i].peer] = out[i].connectID;
+		else if (out[i].type == ENET_EVENT_TYPE_DISCONNECT)
+			connectIDs.erase(out[i].peer);
+	}
+}
+
+void Ingress::Send(ENetPeer* peer, enet_uint8 channelID, const uint8_t* data, size_t size, PacketStream stream)
+{
+	IngressWorker* worker = WorkerOf(peer->host);
+	const auto found = connectIDs.find(peer);
+	if (worker == nullptr || found == connectIDs.end()) return;
+
+	IngressCommand command;
+	command.type = IngressCommand::Send;
+	command.peer = peer;
+	command.connectID = found->second;
+	command.channelID = channelID;
+	command.stream = stream;
+	command.payload.assign(data, data + size);
+	Queue(*worker, std::move(command));
+}
+
+void Ingress::Broadcast(const uint8_t* data, size_t size, PacketPriority priority, PacketStream stream)
+{
+	//Every worker builds its own packets, ENet packet reference counts are not shared across threads
+	for (auto& worker : workers)
+	{
+		IngressCommand command;
+		command.type = IngressCommand::Broadcast;
+		command.argument = priority;
+		command.stream = stream;
+		command.payload.assign(data, data + size);
+		Queue(*worker, std::move(command));
+	}
+}
+
+void Ingress::DisconnectNow(ENetPeer* peer)
+{
+	IngressWorker* worker = WorkerOf(peer->host);
+	const auto found = connectIDs.find(peer);
+	if (worker == nullptr || found == connectIDs.end()) return;
+
+	IngressCommand command;
+	command.type = IngressCommand::DisconnectNow;
+	command.peer = peer;
+	command.connectID = found->second;
+	connectIDs.erase(found);
+	Queue(*worker, std::move(command));
+}
+
+void Ingress::SetCompression(CompressionMode mode)
+{
+	for (auto& worker : workers)
+	{
+		IngressCommand command;
+		command.type = IngressCommand::SetCompression;
+		command.argument = mode;
+		Queue(*worker, std::move(command));
+	}
+}
+
+PeerStats Ingress::Stats(ENetPeer* peer, size_t limit)
+{
+	outstandingLimit.store(limit, std::memory_order_relaxed);
+
+	IngressWorker* worker = WorkerOf(peer->host);
+	if (worker == nullptr) return PeerStats();
+	std::lock_guard<std::mutex> lock(worker->statsMutex);
+	const auto found = worker->stats.find(peer);
+	return found != worker->stats.end() ? found->second : PeerStats();
+}
+
+void Ingress::Queue(IngressWorker& worker, IngressCommand&& command)
+{
+	std::lock_guard<std::mutex> lock(worker.commandMutex);
+	worker.commands.push_back(std::move(command));
+}
+
+#pragma endregion
+
+#pragma region WORKER THREADS
+
+void Ingress::Work(IngressWorker& worker)
+{
+	std::vector<IngressCommand> pending;
+	std::vector<IngressEvent> forwarded;
+	ENetEvent event;
+
+	while (running.load(std::memory_order_acquire))
+	{
+		//Everything the simulation queued since the last pass (swapped so the lock is only held for the swap)
+		{
+			std::lock_guard<std::mutex> lock(worker.commandMutex);
+			pending.swap(worker.commands);
+		}
+		for (IngressCommand& command : pending)
+			Execute(worker, command);
+		pending.clear();
+
+		//Sends go out here, then waits up to 1ms for datagrams and takes every event that is ready
+		int result = enet_host_service(worker.host, &event, 1);
+		while (result > 0)
+		{
+			Forward(event, forwarded);
+			result = enet_host_service(worker.host, &event, 0);
+		}
+
+		//Stats first, the simulation reads them as soon as it sees a connect
+		Publish(worker);
+		if (!forwarded.empty())
+		{
+			std::lock_guard<std::mutex> lock(worker.eventMutex);
+			for (IngressEvent& forwardedEvent : forwarded)
+				worker.events.push_back(std::move(forwardedEvent));
+			forwarded.clear();
+		}
+	}
+
+	enet_host_flush(worker.host);
+}
+
+void Ingress::Execute(IngressWorker& worker, IngressCommand& command)
+{
+	switch (command.type)
+	{
+		case IngressCommand::Send: {
+			//The slot may belong to a newer connection by now
+			if (command.peer->state != ENET_PEER_STATE_CONNECTED || command.peer->connectID != command.connectID) break;
+			net_instance.SendPacket(command.peer, command.channelID, command.payload.data(), command.payload.size(), PacketStream(command.stream));
+			break;
+		}
+
+		case IngressCommand::Broadcast: {
+			net_instance.BroadcastOnHost(worker.host, command.payload.data(), command.payload.size(), PacketPriority(command.argument), PacketStream(command.stream));
+			break;
+		}
+
+		case IngressCommand::DisconnectNow: {
+			if (command.peer->connectID != command.connectID) break;
+			enet_peer_disconnect_now(command.peer, 0);
+			break;
+		}
+
+		case IngressCommand::SetCompression: {
+			net_instance.InstallCompression(worker.host, CompressionMode(command.argument));
+			break;
+		}
+	}
+}
+
+void Ingress::Forward(ENetEvent& event, std::vector<IngressEvent>& out)
+{
+	IngressEvent forwarded;
+	forwarded.type = event.type;
+	forwarded.peer = event.peer;
+	forwarded.data = event.data;
+
+	switch (event.type)
+	{
+		case ENET_EVENT_TYPE_CONNECT: {
+			forwarded.connectID = event.peer->connectID;
+			break;
+		}
+
+		case ENET_EVENT_TYPE_RECEIVE: {
+			const uint8_t* data = event.packet->data;
+			const size_t size = event.packet->dataLength;
+			forwarded.channelID = event.channelID;
+
+			//FlatBuffers are verified here so a malformed packet never reaches the simulation (bit packed readers bound check themselves)
+			if (event.channelID != BitPack::Channel)
+			{
+				Verifier verifier(data, size);
+				if (!VerifyPacketWrapperBuffer(verifier))
+				{
+					std::cout << "INGRESS: Dropped malformed packet (" << size << " bytes) from peer " << event.peer->incomingPeerID << "\n";
+					enet_packet_destroy(event.packet);
+					return;
+				}
+			}
+			forwarded.payload.assign(data, data + size);
+			enet_packet_destroy(event.packet);
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	out.push_back(std::move(forwarded));
+}
+
+void Ingress::Publish(IngressWorker& worker)
+{
+	const size_t limit = outstandingLimit.load(std::memory_order_relaxed);
+	std::lock_guard<std::mutex> lock(worker.statsMutex);
+	worker.stats.clear();
+	for (ENetPeer* peer = worker.host->peers; peer < &worker.host->peers[worker.host->peerCount]; ++peer)
+	{
+		if (peer->state != ENET_PEER_STATE_CONNECTED) continue;
+		worker.stats[peer] = NetworkManager::ReadStats(peer, limit);
+	}
+}
+
+#pragma endregion
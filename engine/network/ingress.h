@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "enet/enet.h"
+#include "network.h"
+
+/*
+* INGRESS WORKERS (sv_ingress_workers > 0, linux)
+*	- K ENET HOSTS BOUND TO THE SAME PORT WITH SO_REUSEPORT, THE KERNEL HASHES EVERY CLIENT ADDRESS ONTO ONE OF THEM
+*	- A HOST IS ONLY EVER TOUCHED BY ITS OWN WORKER THREAD (SERVICE, DECOMPRESS, SEND, DISCONNECT, PEER STATS)
+*	- WORKERS VERIFY INCOMING FLATBUFFERS AND FORWARD THE EVENTS TO THE SIMULATION THREAD
+*	- THE SIMULATION THREAD QUEUES ITS SENDS BACK TO THE WORKER OWNING THE PEER
+*/
+
+struct IngressEvent
+{
+	ENetEventType type = ENET_EVENT_TYPE_NONE;
+	ENetPeer* peer = nullptr;
+	enet_uint32 data = 0; //Connect / disconnect data
+	enet_uint32 connectID = 0; //Connect only, sends are checked against it so a reused peer slot never gets an old clients packets
+	enet_uint8 channelID = 0;
+	std::vector<uint8_t> payload;
+};
+
+struct IngressCommand
+{
+	enum Type : uint8_t { Send, Broadcast, DisconnectNow, SetCompression };
+
+	Type type = Send;
+	ENetPeer* peer = nullptr;
+	enet_uint32 connectID = 0;
+	enet_uint8 channelID = 0;
+	uint8_t argument = 0; //PacketPriority (Broadcast) / CompressionMode (SetCompression)
+	uint8_t stream = 0; //PacketStream (Send / Broadcast)
+	std::vector<uint8_t> payload;
+};
+
+class IngressWorker
+{
+public:
+	IngressWorker(ENetHost* host) : host(host) {}
+
+	ENetHost* host;
+	std::thread thread;
+
+	//Worker -> simulation
+	std::mutex eventMutex;
+	std::vector<IngressEvent> events;
+
+	//Simulation -> worker
+	std::mutex commandMutex;
+	std::vector<IngressCommand> commands;
+
+	//Last published link state of every connected peer of the host
+	std::mutex statsMutex;
+	std::unordered_map<ENetPeer*, PeerStats> stats;
+};
+
+class Ingress
+{
+public:
+	static Ingress& Instance()
+	{
+		static Ingress instance;
+		return instance;
+	}
+
+	~Ingress() { Stop(); }
+
+	bool Start(uint16_t port, int workerCount, size_t peersPerHost, size_t channelLimit); //False (nothing running) when a host can not share the port
+	void Stop(); //Joins the workers and destroys their hosts
+	bool Running() const { return !workers.empty(); }
+	bool Owns(const ENetHost* host) const;
+	ENetHost* PrimaryHost() const { return workers.empty() ? nullptr : workers.front()->host; }
+	size_t WorkerCount() const { return workers.size(); }
+
+	//Simulation thread
+	void Drain(std::vector<IngressEvent>& out); //Appends every forwarded event, in order per worker
+	void Send(ENetPeer* peer, enet_uint8 channelID, const uint8_t* data, size_t size, PacketStream stream = PacketStream_Default);
+	void Broadcast(const uint8_t* data, size_t size, PacketPriority priority, PacketStream stream = PacketStream_Default);
+	void DisconnectNow(ENetPeer* peer);
+	void SetCompression(CompressionMode mode);
+	PeerStats Stats(ENetPeer* peer, size_t outstandingLimit);
+
+private:
+	void Work(IngressWorker& worker);
+	void Execute(IngressWorker& worker, IngressCommand& command);
+	void Forward(ENetEvent& event, std::vector<IngressEvent>& out);
+	void Publish(IngressWorker& worker);
+	IngressWorker* WorkerOf(const ENetHost* host) const;
+	void Queue(IngressWorker& worker, IngressCommand&& command);
+
+	std::vector<std::unique_ptr<IngressWorker>> workers;
+	std::atomic<bool> running = false;
+	std::atomic<size_t> outstandingLimit = 0; //Workers stop counting a peers queue past this (sv_backlog_hard)
+	std::unordered_map<ENetPeer*, enet_uint32> connectIDs; //Simulation side, connections it has seen the connect of
+};
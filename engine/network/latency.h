@@ -0,0 +1,59 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+/*
+* LATENCY HISTOGRAMS
+*	- 1MS BUCKETS UP TO Buckets - 1 MS, THE LAST BUCKET HOLDS EVERYTHING ABOVE
+*	- ADDING A SAMPLE IS ONE INCREMENT, NOTHING IS ALLOCATED OR SORTED
+*	- PERCENTILES ARE READ FROM THE BUCKETS (UPPER EDGE, 1MS RESOLUTION), MEAN AND MAX ARE EXACT
+*/
+
+struct LatencyHistogram
+{
+    static constexpr int Buckets = 251;
+
+    uint32_t counts[Buckets] = {};
+    uint64_t samples = 0;
+    uint64_t totalUs = 0;
+    uint64_t maxUs = 0;
+
+    void Add(uint64_t us)
+    {
+        counts[std::min<uint64_t>(us / 1000, Buckets - 1)]++;
+        samples++;
+        totalUs += us;
+        maxUs = std::max(maxUs, us);
+    }
+    double MeanMs() const { return samples ? double(totalUs) / double(samples) / 1000.0 : 0.0; }
+    double MaxMs() const { return double(maxUs) / 1000.0; }
+    //p in [0, 1]
+    double PercentileMs(double p) const
+    {
+        if (samples == 0) return 0.0;
+        const uint64_t rank = std::max<uint64_t>(1, uint64_t(p * double(samples) + 0.5));
+        uint64_t seen = 0;
+        for (int i = 0; i < Buckets; i++)
+        {
+            seen += counts[i];
+            if (seen >= rank) return i == Buckets - 1 ? MaxMs() : double(i + 1);
+        }
+        return MaxMs();
+    }
+    void Reset() { *this = LatencyHistogram(); }
+};
+
+//Client side view of how long an input takes, see GameClient::SendInput / OnInputAck / OnFramePresented
+struct InputLatency
+{
+    LatencyHistogram inputToAck; //input sent -> the server update echoing it received (network both ways + server delay)
+    LatencyHistogram serverDelay; //input received by the server -> the update carrying its ack sent (tick + snapshot wait)
+    LatencyHistogram inputToScreen; //input sent -> first frame presented after the acked state was applied
+
+    void Reset()
+    {
+        inputToAck.Reset();
+        serverDelay.Reset();
+        inputToScreen.Reset();
+    }
+};
@@ -0,0 +1,91 @@
+#include "config.h"
+#include "loopback.h"
+
+#include <cstring>
+
+void LoopbackQueue::Push(const uint8_t* data, size_t size)
+{
+	Flush();
+	if (!overflow.empty() || !TryPush(data, size))
+		overflow.emplace_back(data, data + size); //Keep the order, the consumer is behind
+}
+
+void LoopbackQueue::Flush()
+{
+	while (!overflow.empty() && TryPush(overflow.front().data(), overflow.front().size()))
+		overflow.pop_front();
+}
+
+bool LoopbackQueue::TryPush(const uint8_t* data, size_t size)
+{
+	const size_t t = tail.load(std::memory_order_relaxed);
+	if (t - head.load(std::memory_order_acquire) == Capacity)
+		return false; //Full
+
+	slots[t & (Capacity - 1)].assign(data, data + size);
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+bool LoopbackQueue::Pop(std::vector<uint8_t>& out)
+{
+	const size_t h = head.load(std::memory_order_relaxed);
+	if (h == tail.load(std::memory_order_acquire))
+		return false; //Empty
+
+	out.swap(slots[h & (Capacity - 1)]);
+	head.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+void LoopbackQueue::Clear()
+{
+	head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+Loopback::Loopback()
+{
+	std::memset(&peer, 0, sizeof(peer));
+	peer.incomingPeerID = PeerID;
+	peer.outgoingPeerID = PeerID;
+	peer.state = ENET_PEER_STATE_CONNECTED;
+	peer.mtu = ENET_HOST_DEFAULT_MTU;
+	peer.packetThrottle = ENET_PEER_PACKET_THROTTLE_SCALE;
+	peer.packetThrottleLimit = ENET_PEER_PACKET_THROTTLE_SCALE;
+}
+
+void Loopback::Connect()
+{
+	toClient.Clear(); //Leftovers of an earlier session
+	disconnectRequested.store(false, std::memory_order_release);
+	connectRequested.store(true, std::memory_order_release);
+}
+
+void Loopback::Disconnect()
+{
+	disconnectRequested.store(true, std::memory_order_release);
+}
+
+bool Loopback::ConsumeConnect()
+{
+	if (!connectRequested.exchange(false, std::memory_order_acq_rel))
+		return false;
+	toServer.Clear();
+	connected.store(true, std::memory_order_release);
+	return true;
+}
+
+bool Loopback::ConsumeDisconnect()
+{
+	if (!disconnectRequested.exchange(false, std::memory_order_acq_rel))
+		return false;
+	connected.store(false, std::memory_order_release);
+	return true;
+}
+
+void Loopback::Reset()
+{
+	connected.store(false, std::memory_order_release);
+	connectRequested.store(false, std::memory_order_release);
+	disconnectRequested.store(false, std::memory_order_release);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include "enet/enet.h"
+
+/*
+* LOOPBACK TRANSPORT
+*	- USED WHEN THE CLIENT AND THE SERVER RUN IN THE SAME PROCESS (HOST)
+*	- FINISHED FLATBUFFER BUFFERS ARE HANDED OVER THROUGH LOCK FREE QUEUES (NO ENET, NO SOCKET, NO SYSCALL)
+*	- REMOTE PEERS STAY ON ENET
+*/
+
+//Single producer / single consumer ring of finished packets (in order, lossless)
+class LoopbackQueue
+{
+public:
+	void Push(const uint8_t* data, size_t size); //Producer thread only
+	void Flush(); //Producer thread only, moves spilled packets into the ring when there is space again
+	bool Pop(std::vector<uint8_t>& out); //Consumer thread only, swaps the slot buffer into out
+	void Clear(); //Consumer thread only
+
+private:
+	bool TryPush(const uint8_t* data, size_t size);
+
+	static constexpr size_t Capacity = 4096; //Must be a power of two
+	std::array<std::vector<uint8_t>, Capacity> slots; //Slot buffers keep their capacity between packets
+	std::atomic<size_t> head = 0; //Next slot to read (consumer)
+	std::atomic<size_t> tail = 0; //Next slot to write (producer)
+	std::deque<std::vector<uint8_t>> overflow; //Producer side spill while the ring is full
+};
+
+class Loopback
+{
+public:
+	static Loopback& Instance()
+	{
+		static Loopback instance;
+		return instance;
+	}
+
+	static constexpr uint16_t PeerID = 0xFFFF; //Outside of the ENet peer id range (max 0xFFF)
+
+	Loopback();
+
+	//Stand in peer for the local player, never handed to any enet_* function
+	ENetPeer* Peer() { return &peer; }
+
+	//Client side
+	void Connect();
+	void Disconnect();
+
+	//Server side
+	bool ConsumeConnect();
+	bool ConsumeDisconnect();
+	bool IsConnected() const { return connected.load(std::memory_order_acquire); }
+	void Reset(); //Server shut down
+
+	LoopbackQueue toServer; //Client (render thread) -> server thread
+	LoopbackQueue toClient; //Server thread -> client (render thread)
+
+private:
+	ENetPeer peer;
+	std::atomic<bool> connectRequested = false;
+	std::atomic<bool> disconnectRequested = false;
+	std::atomic<bool> connected = false; //Server accepted the local client (broadcasts include it)
+};
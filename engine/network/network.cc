@@ -1,9 +1,12 @@
 #include "config.h"
 #include "network.h"
+#include "loopback.h"
+#include "ingress.h"
+#include "../projects/spacegame/code/spaceship.h"
 
 using namespace Protocol;
 
-NetworkManager net_instance = NetworkManager::Instance();
+NetworkManager& net_instance = NetworkManager::Instance();
 
 NetworkManager::NetworkManager()
 {
@@ -12,6 +15,9 @@ NetworkManager::NetworkManager()
 	}
 	std::cout << "Successful initalize ENET NETWORK\n";
 
+	//Optional, without it payloads are only compressed against themselves
+	Compressor().LoadDictionary(Compression::DefaultDictionaryPath);
+
 }
 
 NetworkManager::~NetworkManager()
@@ -22,38 +28,305 @@ NetworkManager::~NetworkManager()
 void NetworkManager::SendToServer(ENetPeer* peer,const FlatBufferBuilder& builder)
 {
 	if (peer == nullptr) return; //No connection to server
+	if (peer == Loopback::Instance().Peer())
+	{
+		Loopback::Instance().toServer.Push(builder.GetBufferPointer(), builder.GetSize());
+		return;
+	}
 	ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_RELIABLE);
 	enet_peer_send(peer,0,packet);
 }
 
+void NetworkManager::SendToServer(ENetPeer* peer, const BitPack::BitWriter& writer)
+{
+	//The loopback peer never negotiates the bit packed format
+	if (peer == nullptr || peer == Loopback::Instance().Peer()) return;
+	ENetPacket* packet = enet_packet_create(writer.Data(), writer.Size(), ENET_PACKET_FLAG_RELIABLE);
+	enet_peer_send(peer, BitPack::Channel, packet);
+}
+
 void NetworkManager::SendToServer(ENetPeer* peer, uint32_t id)
 {
 	//Currently the program uses peer->incomingPeerId so id are for custom id management 
+	if (peer == nullptr) return;
+	if (peer == Loopback::Instance().Peer())
+	{
+		Loopback::Instance().Disconnect();
+		return;
+	}
 	enet_peer_disconnect(peer,id);
 }
 
-void NetworkManager::SendToClient(ENetPeer* peer, const FlatBufferBuilder& builder)
+void NetworkManager::SendToClient(ENetPeer* peer, const FlatBufferBuilder& builder, PacketStream stream)
 {
 	if (peer == nullptr) return;
-	ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_RELIABLE);
-	enet_peer_send(peer, 0, packet);
+	if (peer == Loopback::Instance().Peer())
+	{
+		Loopback::Instance().toClient.Push(builder.GetBufferPointer(), builder.GetSize());
+		return;
+	}
+	Compressor().Capture(builder.GetBufferPointer(), builder.GetSize());
+	if (Ingress::Instance().Owns(peer->host))
+		Ingress::Instance().Send(peer, 0, builder.GetBufferPointer(), builder.GetSize(), stream);
+	else
+		SendPacket(peer, 0, builder.GetBufferPointer(), builder.GetSize(), stream);
+}
+
+void NetworkManager::SendToClient(ENetPeer* peer, const BitPack::BitWriter& writer)
+{
+	if (peer == nullptr || peer == Loopback::Instance().Peer()) return;
+	if (Ingress::Instance().Owns(peer->host))
+		Ingress::Instance().Send(peer, BitPack::Channel, writer.Data(), writer.Size());
+	else
+		SendPacket(peer, BitPack::Channel, writer.Data(), writer.Size());
+}
+
+void NetworkManager::SendPacket(ENetPeer* peer, enet_uint8 channelID, const uint8_t* data, size_t size, PacketStream stream)
+{
+	//Only FlatBuffers go through the dictionary codec (on channel 0, or embedded on the bit packed channel)
+	if (channelID == 0 && ShipsOnBitPackChannel(peer, stream))
+	{
+		enet_peer_send(peer, BitPack::Channel, CreatePacket(data, size, ModeOf(peer->host), HasDictionary(peer), true));
+		return;
+	}
+	ENetPacket* packet = channelID == 0 ?
+		CreatePacket(data, size, ModeOf(peer->host), HasDictionary(peer)) :
+		enet_packet_create(data, size, ENET_PACKET_FLAG_RELIABLE);
+	enet_peer_send(peer, channelID, packet);
 }
 
-void NetworkManager::Broadcast(ENetHost* serverHost, const FlatBufferBuilder& builder)
+void NetworkManager::Broadcast(ENetHost* serverHost, const FlatBufferBuilder& builder, PacketPriority priority, PacketStream stream)
 {
 	if (serverHost == nullptr) return;
-	ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_RELIABLE);
-	enet_host_broadcast(serverHost, 0, packet);
+	Compressor().Capture(builder.GetBufferPointer(), builder.GetSize());
+
+	//Ingress hosts all get it, each worker sends to its own peers
+	if (Ingress::Instance().Owns(serverHost))
+		Ingress::Instance().Broadcast(builder.GetBufferPointer(), builder.GetSize(), priority, stream);
+	else
+		BroadcastOnHost(serverHost, builder.GetBufferPointer(), builder.GetSize(), priority, stream);
+
+	//The hosts own player is not an ENet peer
+	if (Loopback::Instance().IsConnected())
+		Loopback::Instance().toClient.Push(builder.GetBufferPointer(), builder.GetSize());
+}
+
+void NetworkManager::BroadcastOnHost(ENetHost* host, const uint8_t* data, size_t size, PacketPriority priority, PacketStream stream)
+{
+	//Same as enet_host_broadcast, but peers can be skipped and peers with / without our dictionary (or the bit packed channel) get different payloads
+	const CompressionMode mode = ModeOf(host);
+	ENetPacket* packets[2][2] = { { nullptr, nullptr }, { nullptr, nullptr } };
+	for (ENetPeer* peer = host->peers; peer < &host->peers[host->peerCount]; ++peer)
+	{
+		if (peer->state != ENET_PEER_STATE_CONNECTED) continue;
+		if (SkipsBroadcast(peer, priority)) continue;
+		const bool useDictionary = mode == CompressionMode_Dictionary && HasDictionary(peer);
+		const bool embedded = ShipsOnBitPackChannel(peer, stream);
+		ENetPacket*& packet = packets[embedded][useDictionary];
+		if (packet == nullptr)
+			packet = CreatePacket(data, size, mode, useDictionary, embedded);
+		enet_peer_send(peer, embedded ? BitPack::Channel : 0, packet);
+	}
+	for (auto& variants : packets)
+		for (ENetPacket* packet : variants)
+			if (packet != nullptr && packet->referenceCount == 0) enet_packet_destroy(packet);
+}
+
+size_t NetworkManager::OutstandingBytes(const ENetPeer* peer, size_t limit)
+{
+	size_t bytes = peer->reliableDataInTransit;
+	ENetList* queue = const_cast<ENetList*>(&peer->outgoingCommands);
+	for (ENetListIterator it = enet_list_begin(queue); it != enet_list_end(queue) && bytes <= limit; it = enet_list_next(it))
+	{
+		const ENetOutgoingCommand* command = reinterpret_cast<const ENetOutgoingCommand*>(it);
+		bytes += command->fragmentLength;
+	}
+	return bytes;
+}
+
+void NetworkManager::SetPeerCongested(ENetPeer* peer, bool congested)
+{
+	std::lock_guard<std::mutex> lock(peerStateMutex);
+	if (congested)
+		congestedPeers.insert(peer);
+	else
+		congestedPeers.erase(peer);
+}
+
+void NetworkManager::SetPeerBroadcasts(ENetPeer* peer, bool receives)
+{
+	std::lock_guard<std::mutex> lock(peerStateMutex);
+	if (receives)
+		mutedPeers.erase(peer);
+	else
+		mutedPeers.insert(peer);
+}
+
+void NetworkManager::SetPeerBitPacked(ENetPeer* peer, bool bitPacked)
+{
+	std::lock_guard<std::mutex> lock(peerStateMutex);
+	if (bitPacked)
+		bitPackedPeers.insert(peer);
+	else
+		bitPackedPeers.erase(peer);
+}
+
+PeerStats NetworkManager::Stats(ENetPeer* peer, size_t outstandingLimit)
+{
+	if (Ingress::Instance().Owns(peer->host))
+		return Ingress::Instance().Stats(peer, outstandingLimit);
+	if (peer == Loopback::Instance().Peer())
+	{
+		PeerStats stats; //In process, nothing queues up and there is no ENet state
+		stats.mtu = peer->mtu;
+		return stats;
+	}
+	return ReadStats(peer, outstandingLimit);
+}
+
+PeerStats NetworkManager::ReadStats(const ENetPeer* peer, size_t outstandingLimit)
+{
+	PeerStats stats;
+	stats.roundTripTime = peer->roundTripTime;
+	stats.packetThrottle = peer->packetThrottle;
+	stats.packetLoss = peer->packetLoss;
+	stats.mtu = peer->mtu;
+	stats.channelCount = peer->channelCount;
+	stats.outstandingBytes = OutstandingBytes(peer, outstandingLimit);
+	return stats;
+}
+
+void NetworkManager::DisconnectNow(ENetPeer* peer)
+{
+	if (peer == nullptr || peer == Loopback::Instance().Peer()) return;
+	if (Ingress::Instance().Owns(peer->host))
+		Ingress::Instance().DisconnectNow(peer);
+	else
+		enet_peer_disconnect_now(peer, 0);
+}
+
+PayloadCompressor& NetworkManager::Compressor()
+{
+	static PayloadCompressor compressor;
+	return compressor;
+}
+
+void NetworkManager::SetCompression(ENetHost* host, CompressionMode mode)
+{
+	if (host == nullptr) return;
+	if (Ingress::Instance().Owns(host))
+		Ingress::Instance().SetCompression(mode);
+	else
+		InstallCompression(host, mode);
+	std::cout << "NETWORK: Compression " << (mode == CompressionMode_Off ? "off" : mode == CompressionMode_RangeCoder ? "range coder" : "dictionary")
+		<< (mode == CompressionMode_Dictionary && Compressor().DictionaryID() == 0 ? " (no dictionary loaded, plain LZ)" : "") << "\n";
+}
+
+void NetworkManager::InstallCompression(ENetHost* host, CompressionMode mode)
+{
+	{
+		std::lock_guard<std::mutex> lock(peerStateMutex);
+		compressionModes[host] = mode;
+	}
+	if (mode == CompressionMode_RangeCoder)
+		InstallRangeCoder(host, &Compressor().stats, false);
+	else
+		EnableDecompression(host); //Stop compressing datagrams but still read them
+}
+
+void NetworkManager::EnableDecompression(ENetHost* host)
+{
+	if (host == nullptr) return;
+	InstallRangeCoder(host, &Compressor().stats, true);
+}
+
+void NetworkManager::SetPeerDictionary(ENetPeer* peer, uint16_t dictionaryID)
+{
+	std::lock_guard<std::mutex> lock(peerStateMutex);
+	peerDictionaries[peer] = dictionaryID;
+}
+
+void NetworkManager::ForgetPeer(ENetPeer* peer)
+{
+	std::lock_guard<std::mutex> lock(peerStateMutex);
+	peerDictionaries.erase(peer);
+	congestedPeers.erase(peer);
+	mutedPeers.erase(peer);
+	bitPackedPeers.erase(peer);
+}
+
+void NetworkManager::ForgetHost(ENetHost* host)
+{
+	std::lock_guard<std::mutex> lock(peerStateMutex);
+	compressionModes.erase(host);
+	for (auto it = peerDictionaries.begin(); it != peerDictionaries.end();)
+		it = it->first->host == host ? peerDictionaries.erase(it) : std::next(it);
+	for (auto it = congestedPeers.begin(); it != congestedPeers.end();)
+		it = (*it)->host == host ? congestedPeers.erase(it) : std::next(it);
+	for (auto it = mutedPeers.begin(); it != mutedPeers.end();)
+		it = (*it)->host == host ? mutedPeers.erase(it) : std::next(it);
+	for (auto it = bitPackedPeers.begin(); it != bitPackedPeers.end();)
+		it = (*it)->host == host ? bitPackedPeers.erase(it) : std::next(it);
+}
+
+bool NetworkManager::Decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+{
+	return Compressor().Decompress(data, size, out);
+}
+
+ENetPacket* NetworkManager::CreatePacket(const uint8_t* data, size_t size, CompressionMode mode, bool useDictionary, bool embedded)
+{
+	static thread_local std::vector<uint8_t> compressBuffer; //One per sending thread (server or ingress worker)
+	if (mode == CompressionMode_Dictionary && Compressor().Compress(data, size, useDictionary, compressBuffer))
+	{
+		data = compressBuffer.data();
+		size = compressBuffer.size();
+	}
+	if (!embedded)
+		return enet_packet_create(data, size, ENET_PACKET_FLAG_RELIABLE);
+
+	ENetPacket* packet = enet_packet_create(nullptr, BitPack::Embedded::offset + size, ENET_PACKET_FLAG_RELIABLE);
+	packet->data[0] = BitPack::Embedded::header;
+	std::memcpy(packet->data + BitPack::Embedded::offset, data, size);
+	return packet;
+}
+
+bool NetworkManager::ShipsOnBitPackChannel(ENetPeer* peer, PacketStream stream) const
+{
+	if (stream != PacketStream_Ships) return false;
+	std::lock_guard<std::mutex> lock(peerStateMutex);
+	return bitPackedPeers.contains(peer);
+}
+
+CompressionMode NetworkManager::ModeOf(const ENetHost* host) const
+{
+	std::lock_guard<std::mutex> lock(peerStateMutex);
+	const auto found = compressionModes.find(host);
+	return found != compressionModes.end() ? found->second : CompressionMode_Off;
+}
+
+bool NetworkManager::HasDictionary(ENetPeer* peer) const
+{
+	if (Compressor().DictionaryID() == 0) return false;
+	std::lock_guard<std::mutex> lock(peerStateMutex);
+	const auto found = peerDictionaries.find(peer);
+	return found != peerDictionaries.end() && found->second == Compressor().DictionaryID();
+}
+
+bool NetworkManager::SkipsBroadcast(ENetPeer* peer, PacketPriority priority) const
+{
+	std::lock_guard<std::mutex> lock(peerStateMutex);
+	return mutedPeers.contains(peer) || (priority == PacketPriority_Low && congestedPeers.contains(peer));
 }
 
 
 namespace packet
 {
 	//Server to client
-	FlatBufferBuilder ClienConnectsS2C(const uint32_t senderID, unsigned long long serverTime)
+	FlatBufferBuilder ClienConnectsS2C(const uint32_t senderID, const uint32_t tick, const uint32_t sessionToken, const uint8_t wireFormat)
 	{
 		FlatBufferBuilder fbb;
-		const auto clientConnect = CreateClientConnectS2C(fbb, senderID, serverTime);
+		const auto clientConnect = CreateClientConnectS2C(fbb, senderID, tick, sessionToken, wireFormat);
 		const auto wrapper = CreatePacketWrapper(fbb, PacketType_ClientConnectS2C, clientConnect.Union());
 		fbb.Finish(wrapper);
 		return fbb;
@@ -86,28 +359,28 @@ namespace packet
 		return fbb;
 	}
 
-	FlatBufferBuilder UpdatePlayerS2C(const uint64_t timeMs, const Player* player)
+	FlatBufferBuilder UpdatePlayerS2C(const uint32_t tick, const Player* player, const uint16_t intervalMs, const uint16_t inputAckSeq, const uint16_t inputAckDelay)
 	{
 		FlatBufferBuilder fbb;
-		const auto updateP = CreateUpdatePlayerS2C(fbb, timeMs, player);
+		const auto updateP = CreateUpdatePlayerS2C(fbb, tick, player, intervalMs, inputAckSeq, inputAckDelay);
 		const auto wrapper = CreatePacketWrapper(fbb, PacketType_UpdatePlayerS2C, updateP.Union());
 		fbb.Finish(wrapper);
 		return fbb;
 	}
 
-	FlatBufferBuilder TeleportPlayerS2C(const uint64_t timeMs, const Player* player)
+	FlatBufferBuilder TeleportPlayerS2C(const uint32_t tick, const Player* player)
 	{
 		FlatBufferBuilder fbb;
-		const auto teleP = CreateTeleportPlayerS2C(fbb, timeMs, player);
+		const auto teleP = CreateTeleportPlayerS2C(fbb, tick, player);
 		const auto wrapper = CreatePacketWrapper(fbb, PacketType_TeleportPlayerS2C, teleP.Union());
 		fbb.Finish(wrapper);
 		return fbb; 
 	}
 
-	FlatBufferBuilder SpawnLaserS2C(const Laser* laser)
+	FlatBufferBuilder SpawnLaserS2C(const Laser* laser, const uint32_t ownerID, const uint32_t shotSeq)
 	{
 		FlatBufferBuilder fbb;
-		const auto spawnL = CreateSpawnLaserS2C(fbb, laser);
+		const auto spawnL = CreateSpawnLaserS2C(fbb, laser, ownerID, shotSeq);
 		const auto wrapper = CreatePacketWrapper(fbb, PacketType_SpawnLaserS2C, spawnL.Union());
 		fbb.Finish(wrapper);
 		return fbb;
@@ -140,11 +413,40 @@ namespace packet
 		return fbb;
 	}
 
+	FlatBufferBuilder ZoneRedirectS2C(const ENetAddress& address, const uint32_t sessionToken)
+	{
+		FlatBufferBuilder fbb;
+		const auto redirect = CreateZoneRedirectS2C(fbb, address.host, address.port, sessionToken);
+		const auto wrapper = CreatePacketWrapper(fbb, PacketType_ZoneRedirectS2C, redirect.Union());
+		fbb.Finish(wrapper);
+		return fbb;
+	}
+
+	//Zone to zone
+	FlatBufferBuilder ZoneHandoffZ2Z(const Player& player, const uint32_t sessionToken, const Game::ServerSpaceship& ship, const uint32_t inputTick, const std::vector<Laser>& lasers)
+	{
+		FlatBufferBuilder fbb;
+		const auto handoff = CreateZoneHandoffZ2ZDirect(fbb, &player, sessionToken, ship.currentSpeed, ship.rotationZ,
+			ship.rotXSmooth, ship.rotYSmooth, ship.rotZSmooth, ship.lastInputBitmap, inputTick, ship.inputCooldown, &lasers);
+		const auto wrapper = CreatePacketWrapper(fbb, PacketType_ZoneHandoffZ2Z, handoff.Union());
+		fbb.Finish(wrapper);
+		return fbb;
+	}
+
+	FlatBufferBuilder ZoneGhostsZ2Z(const uint32_t tick, const std::vector<Player>& players)
+	{
+		FlatBufferBuilder fbb;
+		const auto ghosts = CreateZoneGhostsZ2ZDirect(fbb, tick, &players);
+		const auto wrapper = CreatePacketWrapper(fbb, PacketType_ZoneGhostsZ2Z, ghosts.Union());
+		fbb.Finish(wrapper);
+		return fbb;
+	}
+
 	//Client to Server
-	FlatBufferBuilder InputC2S(uint64 timeMs, uint16 bitmap)
+	FlatBufferBuilder InputC2S(uint32 tick, uint16 bitmap, uint32 shotSeq, uint16 inputSeq)
 	{
 		FlatBufferBuilder fbb;
-		const auto input = CreateInputC2S(fbb,timeMs,bitmap);
+		const auto input = CreateInputC2S(fbb,tick,bitmap,shotSeq,inputSeq);
 		const auto wrapper = CreatePacketWrapper(fbb, PacketType_InputC2S, input.Union());
 		fbb.Finish(wrapper);
 		return fbb;
@@ -158,4 +460,22 @@ namespace packet
 		fbb.Finish(wrapper);
 		return fbb;
 	}
+
+	FlatBufferBuilder ClientHelloC2S(const uint16_t dictionaryID)
+	{
+		FlatBufferBuilder fbb;
+		const auto hello = CreateClientHelloC2S(fbb, dictionaryID);
+		const auto wrapper = CreatePacketWrapper(fbb, PacketType_ClientHelloC2S, hello.Union());
+		fbb.Finish(wrapper);
+		return fbb;
+	}
+
+	FlatBufferBuilder ResumeC2S(const std::vector<uint32_t>& players, const std::vector<uint32_t>& lasers)
+	{
+		FlatBufferBuilder fbb;
+		const auto resume = CreateResumeC2SDirect(fbb, &players, &lasers);
+		const auto wrapper = CreatePacketWrapper(fbb, PacketType_ResumeC2S, resume.Union());
+		fbb.Finish(wrapper);
+		return fbb;
+	}
 }
\ No newline at end of file
@@ -3,11 +3,52 @@
 #include "proto.h"
 #include "enet/enet.h"
 #include "flatbuffers/flatbuffers.h"
+#include "bitpack.h"
+#include "compression.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
 
 using namespace flatbuffers;
 
 using namespace Protocol;
 
+namespace Game
+{
+	struct ServerSpaceship;
+}
+
+enum PacketPriority : uint8_t
+{
+	PacketPriority_Normal = 0,
+	PacketPriority_Low = 1 //Dropped for peers that are backed up (cosmetic, short lived events)
+};
+
+//Channel a FlatBuffers packet takes to a receiver that negotiated the bit packed format
+enum PacketStream : uint8_t
+{
+	PacketStream_Default = 0, //Channel 0
+	PacketStream_Ships = 1 //State the bit packed ship updates build on, in order with them on BitPack::Channel (see BitPack::Embedded)
+};
+
+//ENet connect data of a spectator relay subscribing to the servers spectator stream (never handed out as a session token)
+constexpr enet_uint32 SpectatorConnectData = 0x53504543; //"SPEC"
+
+//ENet connect data of a neighbouring zone server linking up (low byte = the connecting zone id, see GameServer zones)
+constexpr enet_uint32 ZoneConnectData = 0x5A4F4E00; //"ZON"
+constexpr enet_uint32 ZoneConnectMask = 0xFFFFFF00;
+
+//Link state of a peer as the simulation sees it (copied from the ENet peer, or published by its ingress worker)
+struct PeerStats
+{
+	enet_uint32 roundTripTime = 0; //ms
+	enet_uint32 packetThrottle = ENET_PEER_PACKET_THROTTLE_SCALE;
+	enet_uint32 packetLoss = 0; //ENET_PEER_PACKET_LOSS_SCALE = 100%
+	enet_uint32 mtu = ENET_HOST_DEFAULT_MTU;
+	size_t channelCount = 0;
+	size_t outstandingBytes = 0; //See OutstandingBytes
+};
+
 class NetworkManager
 {
 public:
@@ -29,26 +70,75 @@ public:
 
 	void SendToServer(ENetPeer* peer, const FlatBufferBuilder& builder);
 	void SendToServer(ENetPeer* peer, uint32_t id); //For now disconnect request event C2S
-	void SendToClient(ENetPeer*, const FlatBufferBuilder& builder); //In server find the client with the ID we want to send to
-	void Broadcast(ENetHost* serverHost, const FlatBufferBuilder& builder); //Only server broadcast to all connected players
+	void SendToServer(ENetPeer* peer, const BitPack::BitWriter& writer); //Bit packed hot messages (only after the server agreed)
+	void SendToClient(ENetPeer*, const FlatBufferBuilder& builder, PacketStream stream = PacketStream_Default); //In server find the client with the ID we want to send to
+	void SendToClient(ENetPeer*, const BitPack::BitWriter& writer); //Bit packed hot messages (only negotiated ENet peers)
+	void Broadcast(ENetHost* serverHost, const FlatBufferBuilder& builder, PacketPriority priority = PacketPriority_Normal, PacketStream stream = PacketStream_Default); //Only server broadcast to all connected players (and the loopback player)
+	void SetPeerBitPacked(ENetPeer* peer, bool bitPacked); //PacketStream_Ships packets go on BitPack::Channel for it
+
+	//BACKPRESSURE (reliable data a peer has not acknowledged yet + what is still queued for it)
+	static size_t OutstandingBytes(const ENetPeer* peer, size_t limit); //Stops counting past limit, cost stays bounded for huge queues
+	void SetPeerCongested(ENetPeer* peer, bool congested); //Low priority broadcasts skip congested peers
+	void SetPeerBroadcasts(ENetPeer* peer, bool receives); //Server links (zones) only get what is sent to them directly
+
+	//PEER ACCESS THAT WORKS FOR INGRESS PEERS TOO (their ENet state belongs to the worker thread, see ingress.h)
+	PeerStats Stats(ENetPeer* peer, size_t outstandingLimit);
+	static PeerStats ReadStats(const ENetPeer* peer, size_t outstandingLimit); //Thread owning the peers host only
+	void DisconnectNow(ENetPeer* peer); //No disconnect event follows
+
+	//THREAD OWNING THE HOST (the server thread, or the ingress worker of the host)
+	void SendPacket(ENetPeer* peer, enet_uint8 channelID, const uint8_t* data, size_t size, PacketStream stream = PacketStream_Default);
+	void BroadcastOnHost(ENetHost* host, const uint8_t* data, size_t size, PacketPriority priority, PacketStream stream = PacketStream_Default);
+	void InstallCompression(ENetHost* host, CompressionMode mode);
+
+	//COMPRESSION (per host, see compression.h)
+	void SetCompression(ENetHost* host, CompressionMode mode);
+	void EnableDecompression(ENetHost* host); //Client hosts read every mode a server may pick
+	void SetPeerDictionary(ENetPeer* peer, uint16_t dictionaryID); //Reported by the client in ClientHelloC2S
+	void ForgetPeer(ENetPeer* peer);
+	void ForgetHost(ENetHost* host); //Before enet_host_destroy
+	bool Decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out); //Payloads Compression::IsCompressed says are ours
+	static PayloadCompressor& Compressor(); //Shared by every copy of the manager (holds atomics and the capture file)
+
+private:
+	ENetPacket* CreatePacket(const uint8_t* data, size_t size, CompressionMode mode, bool useDictionary, bool embedded = false);
+	bool ShipsOnBitPackChannel(ENetPeer* peer, PacketStream stream) const;
+	CompressionMode ModeOf(const ENetHost* host) const;
+	bool HasDictionary(ENetPeer* peer) const;
+	bool SkipsBroadcast(ENetPeer* peer, PacketPriority priority) const;
+
+	//Read by the ingress workers while the simulation changes them
+	mutable std::mutex peerStateMutex;
+	std::unordered_map<const ENetHost*, CompressionMode> compressionModes;
+	std::unordered_map<ENetPeer*, uint16_t> peerDictionaries;
+	std::unordered_set<ENetPeer*> congestedPeers;
+	std::unordered_set<ENetPeer*> mutedPeers; //No broadcasts at all
+	std::unordered_set<ENetPeer*> bitPackedPeers; //Negotiated the bit packed format, see PacketStream
 };
 
-extern NetworkManager net_instance;
+extern NetworkManager& net_instance;
 
 namespace packet {
 	//Server To Client packet
-	FlatBufferBuilder ClienConnectsS2C(const uint32_t senderID, unsigned long long timeMs); //server time ms
+	FlatBufferBuilder ClienConnectsS2C(const uint32_t senderID, const uint32_t tick, const uint32_t sessionToken = 0, const uint8_t wireFormat = 0); //current server tick (the clients clock sync), token to resume the session after a drop, agreed BitPack::WireFormat
 	FlatBufferBuilder GameStateS2C(const std::vector<Player>& players, const std::vector<Laser>& lasers); //const vector of laser should be implemented here also
 	FlatBufferBuilder SpawnPlayerS2C(const Player* player);
 	FlatBufferBuilder DespawnPlayerS2C(const uint32_t playerID);
-	FlatBufferBuilder UpdatePlayerS2C(const uint64_t timeMs, const Player* player); //server time when it was sent back to client
-	FlatBufferBuilder TeleportPlayerS2C(const uint64_t timeMs, const Player* player); //server time when it was sent back
-	FlatBufferBuilder SpawnLaserS2C(const Laser* laser);
+	FlatBufferBuilder UpdatePlayerS2C(const uint32_t tick, const Player* player, const uint16_t intervalMs = 0, const uint16_t inputAckSeq = 0, const uint16_t inputAckDelay = 0); //server tick of the state, intervalMs = receivers current snapshot interval, ack of the receivers last input (delay in 0.1ms)
+	FlatBufferBuilder TeleportPlayerS2C(const uint32_t tick, const Player* player); //server tick of the state
+	FlatBufferBuilder SpawnLaserS2C(const Laser* laser, const uint32_t ownerID = 0, const uint32_t shotSeq = 0); //shotSeq echoes the shooters InputC2S
 	FlatBufferBuilder DespawnLaserS2C(const uint32_t laserID);
 	FlatBufferBuilder CollisionS2C(uint32_t entity1ID, uint32_t entity2ID);
 	FlatBufferBuilder TextS2C(const std::string& text);
+	FlatBufferBuilder ZoneRedirectS2C(const ENetAddress& address, const uint32_t sessionToken); //ship left this zone, reconnect there with the token
+
+	// Zone to zone.
+	FlatBufferBuilder ZoneHandoffZ2Z(const Player& player, const uint32_t sessionToken, const Game::ServerSpaceship& ship, const uint32_t inputTick, const std::vector<Laser>& lasers); //ticks relative to the senders current tick
+	FlatBufferBuilder ZoneGhostsZ2Z(const uint32_t tick, const std::vector<Player>& players); //border ships, read only on the receiver
 
 	// Client to server.
-	FlatBufferBuilder InputC2S(uint64 timeMs, uint16 bitmap);
+	FlatBufferBuilder InputC2S(uint32 tick, uint16 bitmap, uint32 shotSeq = 0, uint16 inputSeq = 0); //shotSeq identifies a locally predicted laser, inputSeq is echoed for latency measurement
 	FlatBufferBuilder TextC2S(const std::string& text);
+	FlatBufferBuilder ClientHelloC2S(const uint16_t dictionaryID); //compression dictionary the client has (0 = none)
+	FlatBufferBuilder ResumeC2S(const std::vector<uint32_t>& players, const std::vector<uint32_t>& lasers); //entities the client still has after a reconnect
 }
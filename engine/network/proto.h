@@ -75,6 +75,26 @@ struct TextC2S;
 struct TextC2SBuilder;
 struct TextC2ST;
 
+struct ResumeC2S;
+struct ResumeC2SBuilder;
+struct ResumeC2ST;
+
+struct ClientHelloC2S;
+struct ClientHelloC2SBuilder;
+struct ClientHelloC2ST;
+
+struct ZoneHandoffZ2Z;
+struct ZoneHandoffZ2ZBuilder;
+struct ZoneHandoffZ2ZT;
+
+struct ZoneGhostsZ2Z;
+struct ZoneGhostsZ2ZBuilder;
+struct ZoneGhostsZ2ZT;
+
+struct ZoneRedirectS2C;
+struct ZoneRedirectS2CBuilder;
+struct ZoneRedirectS2CT;
+
 enum PacketType : uint8_t {
   PacketType_NONE = 0,
   PacketType_InputC2S = 1,
@@ -89,11 +109,16 @@ enum PacketType : uint8_t {
   PacketType_DespawnLaserS2C = 10,
   PacketType_CollisionS2C = 11,
   PacketType_TextS2C = 12,
+  PacketType_ResumeC2S = 13,
+  PacketType_ClientHelloC2S = 14,
+  PacketType_ZoneHandoffZ2Z = 15,
+  PacketType_ZoneGhostsZ2Z = 16,
+  PacketType_ZoneRedirectS2C = 17,
   PacketType_MIN = PacketType_NONE,
-  PacketType_MAX = PacketType_TextS2C
+  PacketType_MAX = PacketType_ZoneRedirectS2C
 };
 
-inline const PacketType (&EnumValuesPacketType())[13] {
+inline const PacketType (&EnumValuesPacketType())[18] {
   static const PacketType values[] = {
     PacketType_NONE,
     PacketType_InputC2S,
@@ -107,13 +132,18 @@ inline const PacketType (&EnumValuesPacketType())[13] {
     PacketType_SpawnLaserS2C,
     PacketType_DespawnLaserS2C,
     PacketType_CollisionS2C,
-    PacketType_TextS2C
+    PacketType_TextS2C,
+    PacketType_ResumeC2S,
+    PacketType_ClientHelloC2S,
+    PacketType_ZoneHandoffZ2Z,
+    PacketType_ZoneGhostsZ2Z,
+    PacketType_ZoneRedirectS2C
   };
   return values;
 }
 
 inline const char * const *EnumNamesPacketType() {
-  static const char * const names[14] = {
+  static const char * const names[19] = {
     "NONE",
     "InputC2S",
     "TextC2S",
@@ -127,13 +157,18 @@ inline const char * const *EnumNamesPacketType() {
     "DespawnLaserS2C",
     "CollisionS2C",
     "TextS2C",
+    "ResumeC2S",
+    "ClientHelloC2S",
+    "ZoneHandoffZ2Z",
+    "ZoneGhostsZ2Z",
+    "ZoneRedirectS2C",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNamePacketType(PacketType e) {
-  if (::flatbuffers::IsOutRange(e, PacketType_NONE, PacketType_TextS2C)) return "";
+  if (::flatbuffers::IsOutRange(e, PacketType_NONE, PacketType_ZoneRedirectS2C)) return "";
   const size_t index = static_cast<size_t>(e);
   return EnumNamesPacketType()[index];
 }
@@ -190,6 +225,26 @@ template<> struct PacketTypeTraits<Protocol::TextS2C> {
   static const PacketType enum_value = PacketType_TextS2C;
 };
 
+template<> struct PacketTypeTraits<Protocol::ResumeC2S> {
+  static const PacketType enum_value = PacketType_ResumeC2S;
+};
+
+template<> struct PacketTypeTraits<Protocol::ClientHelloC2S> {
+  static const PacketType enum_value = PacketType_ClientHelloC2S;
+};
+
+template<> struct PacketTypeTraits<Protocol::ZoneHandoffZ2Z> {
+  static const PacketType enum_value = PacketType_ZoneHandoffZ2Z;
+};
+
+template<> struct PacketTypeTraits<Protocol::ZoneGhostsZ2Z> {
+  static const PacketType enum_value = PacketType_ZoneGhostsZ2Z;
+};
+
+template<> struct PacketTypeTraits<Protocol::ZoneRedirectS2C> {
+  static const PacketType enum_value = PacketType_ZoneRedirectS2C;
+};
+
 template<typename T> struct PacketTypeUnionTraits {
   static const PacketType enum_value = PacketType_NONE;
 };
@@ -242,6 +297,26 @@ template<> struct PacketTypeUnionTraits<Protocol::TextS2CT> {
   static const PacketType enum_value = PacketType_TextS2C;
 };
 
+template<> struct PacketTypeUnionTraits<Protocol::ResumeC2ST> {
+  static const PacketType enum_value = PacketType_ResumeC2S;
+};
+
+template<> struct PacketTypeUnionTraits<Protocol::ClientHelloC2ST> {
+  static const PacketType enum_value = PacketType_ClientHelloC2S;
+};
+
+template<> struct PacketTypeUnionTraits<Protocol::ZoneHandoffZ2ZT> {
+  static const PacketType enum_value = PacketType_ZoneHandoffZ2Z;
+};
+
+template<> struct PacketTypeUnionTraits<Protocol::ZoneGhostsZ2ZT> {
+  static const PacketType enum_value = PacketType_ZoneGhostsZ2Z;
+};
+
+template<> struct PacketTypeUnionTraits<Protocol::ZoneRedirectS2CT> {
+  static const PacketType enum_value = PacketType_ZoneRedirectS2C;
+};
+
 struct PacketTypeUnion {
   PacketType type;
   void *value;
@@ -368,6 +443,46 @@ struct PacketTypeUnion {
     return type == PacketType_TextS2C ?
       reinterpret_cast<const Protocol::TextS2CT *>(value) : nullptr;
   }
+  Protocol::ResumeC2ST *AsResumeC2S() {
+    return type == PacketType_ResumeC2S ?
+      reinterpret_cast<Protocol::ResumeC2ST *>(value) : nullptr;
+  }
+  const Protocol::ResumeC2ST *AsResumeC2S() const {
+    return type == PacketType_ResumeC2S ?
+      reinterpret_cast<const Protocol::ResumeC2ST *>(value) : nullptr;
+  }
+  Protocol::ClientHelloC2ST *AsClientHelloC2S() {
+    return type == PacketType_ClientHelloC2S ?
+      reinterpret_cast<Protocol::ClientHelloC2ST *>(value) : nullptr;
+  }
+  const Protocol::ClientHelloC2ST *AsClientHelloC2S() const {
+    return type == PacketType_ClientHelloC2S ?
+      reinterpret_cast<const Protocol::ClientHelloC2ST *>(value) : nullptr;
+  }
+  Protocol::ZoneHandoffZ2ZT *AsZoneHandoffZ2Z() {
+    return type == PacketType_ZoneHandoffZ2Z ?
+      reinterpret_cast<Protocol::ZoneHandoffZ2ZT *>(value) : nullptr;
+  }
+  const Protocol::ZoneHandoffZ2ZT *AsZoneHandoffZ2Z() const {
+    return type == PacketType_ZoneHandoffZ2Z ?
+      reinterpret_cast<const Protocol::ZoneHandoffZ2ZT *>(value) : nullptr;
+  }
+  Protocol::ZoneGhostsZ2ZT *AsZoneGhostsZ2Z() {
+    return type == PacketType_ZoneGhostsZ2Z ?
+      reinterpret_cast<Protocol::ZoneGhostsZ2ZT *>(value) : nullptr;
+  }
+  const Protocol::ZoneGhostsZ2ZT *AsZoneGhostsZ2Z() const {
+    return type == PacketType_ZoneGhostsZ2Z ?
+      reinterpret_cast<const Protocol::ZoneGhostsZ2ZT *>(value) : nullptr;
+  }
+  Protocol::ZoneRedirectS2CT *AsZoneRedirectS2C() {
+    return type == PacketType_ZoneRedirectS2C ?
+      reinterpret_cast<Protocol::ZoneRedirectS2CT *>(value) : nullptr;
+  }
+  const Protocol::ZoneRedirectS2CT *AsZoneRedirectS2C() const {
+    return type == PacketType_ZoneRedirectS2C ?
+      reinterpret_cast<const Protocol::ZoneRedirectS2CT *>(value) : nullptr;
+  }
 };
 
 bool VerifyPacketType(::flatbuffers::Verifier &verifier, const void *obj, PacketType type);
@@ -458,38 +573,28 @@ FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) Vec4 FLATBUFFERS_FINAL_CLASS {
 };
 FLATBUFFERS_STRUCT_END(Vec4, 16);
 
-FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(8) Laser FLATBUFFERS_FINAL_CLASS {
+FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) Laser FLATBUFFERS_FINAL_CLASS {
  private:
   uint32_t uuid_;
-  int32_t padding0__;
-  uint64_t start_time_;
-  uint64_t end_time_;
+  uint32_t start_time_;
+  uint32_t end_time_;
   Protocol::Vec3 origin_;
   Protocol::Vec4 direction_;
-  int32_t padding1__;
 
  public:
   Laser()
       : uuid_(0),
-        padding0__(0),
         start_time_(0),
         end_time_(0),
         origin_(),
-        direction_(),
-        padding1__(0) {
-    (void)padding0__;
-    (void)padding1__;
+        direction_() {
   }
-  Laser(uint32_t _uuid, uint64_t _start_time, uint64_t _end_time, const Protocol::Vec3 &_origin, const Protocol::Vec4 &_direction)
+  Laser(uint32_t _uuid, uint32_t _start_time, uint32_t _end_time, const Protocol::Vec3 &_origin, const Protocol::Vec4 &_direction)
       : uuid_(::flatbuffers::EndianScalar(_uuid)),
-        padding0__(0),
         start_time_(::flatbuffers::EndianScalar(_start_time)),
         end_time_(::flatbuffers::EndianScalar(_end_time)),
         origin_(_origin),
-        direction_(_direction),
-        padding1__(0) {
-    (void)padding0__;
-    (void)padding1__;
+        direction_(_direction) {
   }
   uint32_t uuid() const {
     return ::flatbuffers::EndianScalar(uuid_);
@@ -497,16 +602,16 @@ FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(8) Laser FLATBUFFERS_FINAL_CLASS {
   void mutate_uuid(uint32_t _uuid) {
     ::flatbuffers::WriteScalar(&uuid_, _uuid);
   }
-  uint64_t start_time() const {
+  uint32_t start_time() const {
     return ::flatbuffers::EndianScalar(start_time_);
   }
-  void mutate_start_time(uint64_t _start_time) {
+  void mutate_start_time(uint32_t _start_time) {
     ::flatbuffers::WriteScalar(&start_time_, _start_time);
   }
-  uint64_t end_time() const {
+  uint32_t end_time() const {
     return ::flatbuffers::EndianScalar(end_time_);
   }
-  void mutate_end_time(uint64_t _end_time) {
+  void mutate_end_time(uint32_t _end_time) {
     ::flatbuffers::WriteScalar(&end_time_, _end_time);
   }
   const Protocol::Vec3 &origin() const {
@@ -522,7 +627,7 @@ FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(8) Laser FLATBUFFERS_FINAL_CLASS {
     return direction_;
   }
 };
-FLATBUFFERS_STRUCT_END(Laser, 56);
+FLATBUFFERS_STRUCT_END(Laser, 40);
 
 FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) Player FLATBUFFERS_FINAL_CLASS {
  private:
@@ -635,6 +740,21 @@ struct PacketWrapper FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   const Protocol::TextS2C *packet_as_TextS2C() const {
     return packet_type() == Protocol::PacketType_TextS2C ? static_cast<const Protocol::TextS2C *>(packet()) : nullptr;
   }
+  const Protocol::ResumeC2S *packet_as_ResumeC2S() const {
+    return packet_type() == Protocol::PacketType_ResumeC2S ? static_cast<const Protocol::ResumeC2S *>(packet()) : nullptr;
+  }
+  const Protocol::ClientHelloC2S *packet_as_ClientHelloC2S() const {
+    return packet_type() == Protocol::PacketType_ClientHelloC2S ? static_cast<const Protocol::ClientHelloC2S *>(packet()) : nullptr;
+  }
+  const Protocol::ZoneHandoffZ2Z *packet_as_ZoneHandoffZ2Z() const {
+    return packet_type() == Protocol::PacketType_ZoneHandoffZ2Z ? static_cast<const Protocol::ZoneHandoffZ2Z *>(packet()) : nullptr;
+  }
+  const Protocol::ZoneGhostsZ2Z *packet_as_ZoneGhostsZ2Z() const {
+    return packet_type() == Protocol::PacketType_ZoneGhostsZ2Z ? static_cast<const Protocol::ZoneGhostsZ2Z *>(packet()) : nullptr;
+  }
+  const Protocol::ZoneRedirectS2C *packet_as_ZoneRedirectS2C() const {
+    return packet_type() == Protocol::PacketType_ZoneRedirectS2C ? static_cast<const Protocol::ZoneRedirectS2C *>(packet()) : nullptr;
+  }
   void *mutable_packet() {
     return GetPointer<void *>(VT_PACKET);
   }
@@ -698,6 +818,26 @@ template<> inline const Protocol::TextS2C *PacketWrapper::packet_as<Protocol::Te
   return packet_as_TextS2C();
 }
 
+template<> inline const Protocol::ResumeC2S *PacketWrapper::packet_as<Protocol::ResumeC2S>() const {
+  return packet_as_ResumeC2S();
+}
+
+template<> inline const Protocol::ClientHelloC2S *PacketWrapper::packet_as<Protocol::ClientHelloC2S>() const {
+  return packet_as_ClientHelloC2S();
+}
+
+template<> inline const Protocol::ZoneHandoffZ2Z *PacketWrapper::packet_as<Protocol::ZoneHandoffZ2Z>() const {
+  return packet_as_ZoneHandoffZ2Z();
+}
+
+template<> inline const Protocol::ZoneGhostsZ2Z *PacketWrapper::packet_as<Protocol::ZoneGhostsZ2Z>() const {
+  return packet_as_ZoneGhostsZ2Z();
+}
+
+template<> inline const Protocol::ZoneRedirectS2C *PacketWrapper::packet_as<Protocol::ZoneRedirectS2C>() const {
+  return packet_as_ZoneRedirectS2C();
+}
+
 struct PacketWrapperBuilder {
   typedef PacketWrapper Table;
   ::flatbuffers::FlatBufferBuilder &fbb_;
@@ -734,7 +874,9 @@ inline ::flatbuffers::Offset<PacketWrapper> CreatePacketWrapper(
 struct ClientConnectS2CT : public ::flatbuffers::NativeTable {
   typedef ClientConnectS2C TableType;
   uint32_t uuid = 0;
-  uint64_t time = 0;
+  uint32_t time = 0;
+  uint32_t session_token = 0;
+  uint8_t wire_format = 0;
 };
 
 struct ClientConnectS2C FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
@@ -742,7 +884,9 @@ struct ClientConnectS2C FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   typedef ClientConnectS2CBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_UUID = 4,
-    VT_TIME = 6
+    VT_TIME = 6,
+    VT_SESSION_TOKEN = 8,
+    VT_WIRE_FORMAT = 10
   };
   uint32_t uuid() const {
     return GetField<uint32_t>(VT_UUID, 0);
@@ -750,16 +894,30 @@ struct ClientConnectS2C FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   bool mutate_uuid(uint32_t _uuid = 0) {
     return SetField<uint32_t>(VT_UUID, _uuid, 0);
   }
-  uint64_t time() const {
-    return GetField<uint64_t>(VT_TIME, 0);
+  uint32_t time() const {
+    return GetField<uint32_t>(VT_TIME, 0);
   }
-  bool mutate_time(uint64_t _time = 0) {
-    return SetField<uint64_t>(VT_TIME, _time, 0);
+  bool mutate_time(uint32_t _time = 0) {
+    return SetField<uint32_t>(VT_TIME, _time, 0);
+  }
+  uint32_t session_token() const {
+    return GetField<uint32_t>(VT_SESSION_TOKEN, 0);
+  }
+  bool mutate_session_token(uint32_t _session_token = 0) {
+    return SetField<uint32_t>(VT_SESSION_TOKEN, _session_token, 0);
+  }
+  uint8_t wire_format() const {
+    return GetField<uint8_t>(VT_WIRE_FORMAT, 0);
+  }
+  bool mutate_wire_format(uint8_t _wire_format = 0) {
+    return SetField<uint8_t>(VT_WIRE_FORMAT, _wire_format, 0);
   }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<uint32_t>(verifier, VT_UUID, 4) &&
-           VerifyField<uint64_t>(verifier, VT_TIME, 8) &&
+           VerifyField<uint32_t>(verifier, VT_TIME, 4) &&
+           VerifyField<uint32_t>(verifier, VT_SESSION_TOKEN, 4) &&
+           VerifyField<uint8_t>(verifier, VT_WIRE_FORMAT, 1) &&
            verifier.EndTable();
   }
   ClientConnectS2CT *UnPack(const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
@@ -774,8 +932,14 @@ struct ClientConnectS2CBuilder {
   void add_uuid(uint32_t uuid) {
     fbb_.AddElement<uint32_t>(ClientConnectS2C::VT_UUID, uuid, 0);
   }
-  void add_time(uint64_t time) {
-    fbb_.AddElement<uint64_t>(ClientConnectS2C::VT_TIME, time, 0);
+  void add_time(uint32_t time) {
+    fbb_.AddElement<uint32_t>(ClientConnectS2C::VT_TIME, time, 0);
+  }
+  void add_session_token(uint32_t session_token) {
+    fbb_.AddElement<uint32_t>(ClientConnectS2C::VT_SESSION_TOKEN, session_token, 0);
+  }
+  void add_wire_format(uint8_t wire_format) {
+    fbb_.AddElement<uint8_t>(ClientConnectS2C::VT_WIRE_FORMAT, wire_format, 0);
   }
   explicit ClientConnectS2CBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
@@ -791,10 +955,14 @@ struct ClientConnectS2CBuilder {
 inline ::flatbuffers::Offset<ClientConnectS2C> CreateClientConnectS2C(
     ::flatbuffers::FlatBufferBuilder &_fbb,
     uint32_t uuid = 0,
-    uint64_t time = 0) {
+    uint32_t time = 0,
+    uint32_t session_token = 0,
+    uint8_t wire_format = 0) {
   ClientConnectS2CBuilder builder_(_fbb);
+  builder_.add_session_token(session_token);
   builder_.add_time(time);
   builder_.add_uuid(uuid);
+  builder_.add_wire_format(wire_format);
   return builder_.Finish();
 }
 
@@ -999,8 +1167,11 @@ inline ::flatbuffers::Offset<DespawnPlayerS2C> CreateDespawnPlayerS2C(
 
 struct UpdatePlayerS2CT : public ::flatbuffers::NativeTable {
   typedef UpdatePlayerS2C TableType;
-  uint64_t time = 0;
+  uint32_t time = 0;
   std::unique_ptr<Protocol::Player> player{};
+  uint16_t interval_ms = 0;
+  uint16_t input_ack_seq = 0;
+  uint16_t input_ack_delay = 0;
   UpdatePlayerS2CT() = default;
   UpdatePlayerS2CT(const UpdatePlayerS2CT &o);
   UpdatePlayerS2CT(UpdatePlayerS2CT&&) FLATBUFFERS_NOEXCEPT = default;
@@ -1012,13 +1183,16 @@ struct UpdatePlayerS2C FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   typedef UpdatePlayerS2CBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_TIME = 4,
-    VT_PLAYER = 6
+    VT_PLAYER = 6,
+    VT_INTERVAL_MS = 8,
+    VT_INPUT_ACK_SEQ = 10,
+    VT_INPUT_ACK_DELAY = 12
   };
-  uint64_t time() const {
-    return GetField<uint64_t>(VT_TIME, 0);
+  uint32_t time() const {
+    return GetField<uint32_t>(VT_TIME, 0);
   }
-  bool mutate_time(uint64_t _time = 0) {
-    return SetField<uint64_t>(VT_TIME, _time, 0);
+  bool mutate_time(uint32_t _time = 0) {
+    return SetField<uint32_t>(VT_TIME, _time, 0);
   }
   const Protocol::Player *player() const {
     return GetStruct<const Protocol::Player *>(VT_PLAYER);
@@ -1026,10 +1200,31 @@ struct UpdatePlayerS2C FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   Protocol::Player *mutable_player() {
     return GetStruct<Protocol::Player *>(VT_PLAYER);
   }
+  uint16_t interval_ms() const {
+    return GetField<uint16_t>(VT_INTERVAL_MS, 0);
+  }
+  bool mutate_interval_ms(uint16_t _interval_ms = 0) {
+    return SetField<uint16_t>(VT_INTERVAL_MS, _interval_ms, 0);
+  }
+  uint16_t input_ack_seq() const {
+    return GetField<uint16_t>(VT_INPUT_ACK_SEQ, 0);
+  }
+  bool mutate_input_ack_seq(uint16_t _input_ack_seq = 0) {
+    return SetField<uint16_t>(VT_INPUT_ACK_SEQ, _input_ack_seq, 0);
+  }
+  uint16_t input_ack_delay() const {
+    return GetField<uint16_t>(VT_INPUT_ACK_DELAY, 0);
+  }
+  bool mutate_input_ack_delay(uint16_t _input_ack_delay = 0) {
+    return SetField<uint16_t>(VT_INPUT_ACK_DELAY, _input_ack_delay, 0);
+  }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
-           VerifyField<uint64_t>(verifier, VT_TIME, 8) &&
+           VerifyField<uint32_t>(verifier, VT_TIME, 4) &&
            VerifyField<Protocol::Player>(verifier, VT_PLAYER, 4) &&
+           VerifyField<uint16_t>(verifier, VT_INTERVAL_MS, 2) &&
+           VerifyField<uint16_t>(verifier, VT_INPUT_ACK_SEQ, 2) &&
+           VerifyField<uint16_t>(verifier, VT_INPUT_ACK_DELAY, 2) &&
            verifier.EndTable();
   }
   UpdatePlayerS2CT *UnPack(const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
@@ -1041,12 +1236,21 @@ struct UpdatePlayerS2CBuilder {
   typedef UpdatePlayerS2C Table;
   ::flatbuffers::FlatBufferBuilder &fbb_;
   ::flatbuffers::uoffset_t start_;
-  void add_time(uint64_t time) {
-    fbb_.AddElement<uint64_t>(UpdatePlayerS2C::VT_TIME, time, 0);
+  void add_time(uint32_t time) {
+    fbb_.AddElement<uint32_t>(UpdatePlayerS2C::VT_TIME, time, 0);
   }
   void add_player(const Protocol::Player *player) {
     fbb_.AddStruct(UpdatePlayerS2C::VT_PLAYER, player);
   }
+  void add_interval_ms(uint16_t interval_ms) {
+    fbb_.AddElement<uint16_t>(UpdatePlayerS2C::VT_INTERVAL_MS, interval_ms, 0);
+  }
+  void add_input_ack_seq(uint16_t input_ack_seq) {
+    fbb_.AddElement<uint16_t>(UpdatePlayerS2C::VT_INPUT_ACK_SEQ, input_ack_seq, 0);
+  }
+  void add_input_ack_delay(uint16_t input_ack_delay) {
+    fbb_.AddElement<uint16_t>(UpdatePlayerS2C::VT_INPUT_ACK_DELAY, input_ack_delay, 0);
+  }
   explicit UpdatePlayerS2CBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -1060,11 +1264,17 @@ struct UpdatePlayerS2CBuilder {
 
 inline ::flatbuffers::Offset<UpdatePlayerS2C> CreateUpdatePlayerS2C(
     ::flatbuffers::FlatBufferBuilder &_fbb,
-    uint64_t time = 0,
-    const Protocol::Player *player = nullptr) {
+    uint32_t time = 0,
+    const Protocol::Player *player = nullptr,
+    uint16_t interval_ms = 0,
+    uint16_t input_ack_seq = 0,
+    uint16_t input_ack_delay = 0) {
   UpdatePlayerS2CBuilder builder_(_fbb);
-  builder_.add_time(time);
   builder_.add_player(player);
+  builder_.add_time(time);
+  builder_.add_input_ack_delay(input_ack_delay);
+  builder_.add_input_ack_seq(input_ack_seq);
+  builder_.add_interval_ms(interval_ms);
   return builder_.Finish();
 }
 
@@ -1072,7 +1282,7 @@ inline ::flatbuffers::Offset<UpdatePlayerS2C> CreateUpdatePlayerS2C(
 
 struct TeleportPlayerS2CT : public ::flatbuffers::NativeTable {
   typedef TeleportPlayerS2C TableType;
-  uint64_t time = 0;
+  uint32_t time = 0;
   std::unique_ptr<Protocol::Player> player{};
   TeleportPlayerS2CT() = default;
   TeleportPlayerS2CT(const TeleportPlayerS2CT &o);
@@ -1087,11 +1297,11 @@ struct TeleportPlayerS2C FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table
     VT_TIME = 4,
     VT_PLAYER = 6
   };
-  uint64_t time() const {
-    return GetField<uint64_t>(VT_TIME, 0);
+  uint32_t time() const {
+    return GetField<uint32_t>(VT_TIME, 0);
   }
-  bool mutate_time(uint64_t _time = 0) {
-    return SetField<uint64_t>(VT_TIME, _time, 0);
+  bool mutate_time(uint32_t _time = 0) {
+    return SetField<uint32_t>(VT_TIME, _time, 0);
   }
   const Protocol::Player *player() const {
     return GetStruct<const Protocol::Player *>(VT_PLAYER);
@@ -1101,7 +1311,7 @@ struct TeleportPlayerS2C FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table
   }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
-           VerifyField<uint64_t>(verifier, VT_TIME, 8) &&
+           VerifyField<uint32_t>(verifier, VT_TIME, 4) &&
            VerifyField<Protocol::Player>(verifier, VT_PLAYER, 4) &&
            verifier.EndTable();
   }
@@ -1114,8 +1324,8 @@ struct TeleportPlayerS2CBuilder {
   typedef TeleportPlayerS2C Table;
   ::flatbuffers::FlatBufferBuilder &fbb_;
   ::flatbuffers::uoffset_t start_;
-  void add_time(uint64_t time) {
-    fbb_.AddElement<uint64_t>(TeleportPlayerS2C::VT_TIME, time, 0);
+  void add_time(uint32_t time) {
+    fbb_.AddElement<uint32_t>(TeleportPlayerS2C::VT_TIME, time, 0);
   }
   void add_player(const Protocol::Player *player) {
     fbb_.AddStruct(TeleportPlayerS2C::VT_PLAYER, player);
@@ -1133,11 +1343,11 @@ struct TeleportPlayerS2CBuilder {
 
 inline ::flatbuffers::Offset<TeleportPlayerS2C> CreateTeleportPlayerS2C(
     ::flatbuffers::FlatBufferBuilder &_fbb,
-    uint64_t time = 0,
+    uint32_t time = 0,
     const Protocol::Player *player = nullptr) {
   TeleportPlayerS2CBuilder builder_(_fbb);
-  builder_.add_time(time);
   builder_.add_player(player);
+  builder_.add_time(time);
   return builder_.Finish();
 }
 
@@ -1146,6 +1356,8 @@ inline ::flatbuffers::Offset<TeleportPlayerS2C> CreateTeleportPlayerS2C(
 struct SpawnLaserS2CT : public ::flatbuffers::NativeTable {
   typedef SpawnLaserS2C TableType;
   std::unique_ptr<Protocol::Laser> laser{};
+  uint32_t owner_id = 0;
+  uint32_t shot_seq = 0;
   SpawnLaserS2CT() = default;
   SpawnLaserS2CT(const SpawnLaserS2CT &o);
   SpawnLaserS2CT(SpawnLaserS2CT&&) FLATBUFFERS_NOEXCEPT = default;
@@ -1156,7 +1368,9 @@ struct SpawnLaserS2C FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   typedef SpawnLaserS2CT NativeTableType;
   typedef SpawnLaserS2CBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
-    VT_LASER = 4
+    VT_LASER = 4,
+    VT_OWNER_ID = 6,
+    VT_SHOT_SEQ = 8
   };
   const Protocol::Laser *laser() const {
     return GetStruct<const Protocol::Laser *>(VT_LASER);
@@ -1164,9 +1378,23 @@ struct SpawnLaserS2C FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   Protocol::Laser *mutable_laser() {
     return GetStruct<Protocol::Laser *>(VT_LASER);
   }
+  uint32_t owner_id() const {
+    return GetField<uint32_t>(VT_OWNER_ID, 0);
+  }
+  bool mutate_owner_id(uint32_t _owner_id = 0) {
+    return SetField<uint32_t>(VT_OWNER_ID, _owner_id, 0);
+  }
+  uint32_t shot_seq() const {
+    return GetField<uint32_t>(VT_SHOT_SEQ, 0);
+  }
+  bool mutate_shot_seq(uint32_t _shot_seq = 0) {
+    return SetField<uint32_t>(VT_SHOT_SEQ, _shot_seq, 0);
+  }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
-           VerifyField<Protocol::Laser>(verifier, VT_LASER, 8) &&
+           VerifyField<Protocol::Laser>(verifier, VT_LASER, 4) &&
+           VerifyField<uint32_t>(verifier, VT_OWNER_ID, 4) &&
+           VerifyField<uint32_t>(verifier, VT_SHOT_SEQ, 4) &&
            verifier.EndTable();
   }
   SpawnLaserS2CT *UnPack(const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
@@ -1181,6 +1409,12 @@ struct SpawnLaserS2CBuilder {
   void add_laser(const Protocol::Laser *laser) {
     fbb_.AddStruct(SpawnLaserS2C::VT_LASER, laser);
   }
+  void add_owner_id(uint32_t owner_id) {
+    fbb_.AddElement<uint32_t>(SpawnLaserS2C::VT_OWNER_ID, owner_id, 0);
+  }
+  void add_shot_seq(uint32_t shot_seq) {
+    fbb_.AddElement<uint32_t>(SpawnLaserS2C::VT_SHOT_SEQ, shot_seq, 0);
+  }
   explicit SpawnLaserS2CBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -1194,9 +1428,13 @@ struct SpawnLaserS2CBuilder {
 
 inline ::flatbuffers::Offset<SpawnLaserS2C> CreateSpawnLaserS2C(
     ::flatbuffers::FlatBufferBuilder &_fbb,
-    const Protocol::Laser *laser = nullptr) {
+    const Protocol::Laser *laser = nullptr,
+    uint32_t owner_id = 0,
+    uint32_t shot_seq = 0) {
   SpawnLaserS2CBuilder builder_(_fbb);
   builder_.add_laser(laser);
+  builder_.add_shot_seq(shot_seq);
+  builder_.add_owner_id(owner_id);
   return builder_.Finish();
 }
 
@@ -1393,8 +1631,10 @@ inline ::flatbuffers::Offset<TextS2C> CreateTextS2CDirect(
 
 struct InputC2ST : public ::flatbuffers::NativeTable {
   typedef InputC2S TableType;
-  uint64_t time = 0;
+  uint32_t time = 0;
   uint16_t bitmap = 0;
+  uint32_t shot_seq = 0;
+  uint16_t input_seq = 0;
 };
 
 struct InputC2S FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
@@ -1402,13 +1642,15 @@ struct InputC2S FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   typedef InputC2SBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_TIME = 4,
-    VT_BITMAP = 6
+    VT_BITMAP = 6,
+    VT_SHOT_SEQ = 8,
+    VT_INPUT_SEQ = 10
   };
-  uint64_t time() const {
-    return GetField<uint64_t>(VT_TIME, 0);
+  uint32_t time() const {
+    return GetField<uint32_t>(VT_TIME, 0);
   }
-  bool mutate_time(uint64_t _time = 0) {
-    return SetField<uint64_t>(VT_TIME, _time, 0);
+  bool mutate_time(uint32_t _time = 0) {
+    return SetField<uint32_t>(VT_TIME, _time, 0);
   }
   uint16_t bitmap() const {
     return GetField<uint16_t>(VT_BITMAP, 0);
@@ -1416,10 +1658,24 @@ struct InputC2S FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   bool mutate_bitmap(uint16_t _bitmap = 0) {
     return SetField<uint16_t>(VT_BITMAP, _bitmap, 0);
   }
+  uint32_t shot_seq() const {
+    return GetField<uint32_t>(VT_SHOT_SEQ, 0);
+  }
+  bool mutate_shot_seq(uint32_t _shot_seq = 0) {
+    return SetField<uint32_t>(VT_SHOT_SEQ, _shot_seq, 0);
+  }
+  uint16_t input_seq() const {
+    return GetField<uint16_t>(VT_INPUT_SEQ, 0);
+  }
+  bool mutate_input_seq(uint16_t _input_seq = 0) {
+    return SetField<uint16_t>(VT_INPUT_SEQ, _input_seq, 0);
+  }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
-           VerifyField<uint64_t>(verifier, VT_TIME, 8) &&
+           VerifyField<uint32_t>(verifier, VT_TIME, 4) &&
            VerifyField<uint16_t>(verifier, VT_BITMAP, 2) &&
+           VerifyField<uint32_t>(verifier, VT_SHOT_SEQ, 4) &&
+           VerifyField<uint16_t>(verifier, VT_INPUT_SEQ, 2) &&
            verifier.EndTable();
   }
   InputC2ST *UnPack(const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
@@ -1431,12 +1687,18 @@ struct InputC2SBuilder {
   typedef InputC2S Table;
   ::flatbuffers::FlatBufferBuilder &fbb_;
   ::flatbuffers::uoffset_t start_;
-  void add_time(uint64_t time) {
-    fbb_.AddElement<uint64_t>(InputC2S::VT_TIME, time, 0);
+  void add_time(uint32_t time) {
+    fbb_.AddElement<uint32_t>(InputC2S::VT_TIME, time, 0);
   }
   void add_bitmap(uint16_t bitmap) {
     fbb_.AddElement<uint16_t>(InputC2S::VT_BITMAP, bitmap, 0);
   }
+  void add_shot_seq(uint32_t shot_seq) {
+    fbb_.AddElement<uint32_t>(InputC2S::VT_SHOT_SEQ, shot_seq, 0);
+  }
+  void add_input_seq(uint16_t input_seq) {
+    fbb_.AddElement<uint16_t>(InputC2S::VT_INPUT_SEQ, input_seq, 0);
+  }
   explicit InputC2SBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -1450,10 +1712,14 @@ struct InputC2SBuilder {
 
 inline ::flatbuffers::Offset<InputC2S> CreateInputC2S(
     ::flatbuffers::FlatBufferBuilder &_fbb,
-    uint64_t time = 0,
-    uint16_t bitmap = 0) {
+    uint32_t time = 0,
+    uint16_t bitmap = 0,
+    uint32_t shot_seq = 0,
+    uint16_t input_seq = 0) {
   InputC2SBuilder builder_(_fbb);
+  builder_.add_shot_seq(shot_seq);
   builder_.add_time(time);
+  builder_.add_input_seq(input_seq);
   builder_.add_bitmap(bitmap);
   return builder_.Finish();
 }
@@ -1525,6 +1791,537 @@ inline ::flatbuffers::Offset<TextC2S> CreateTextC2SDirect(
 
 ::flatbuffers::Offset<TextC2S> CreateTextC2S(::flatbuffers::FlatBufferBuilder &_fbb, const TextC2ST *_o, const ::flatbuffers::rehasher_function_t *_rehasher = nullptr);
 
+struct ResumeC2ST : public ::flatbuffers::NativeTable {
+  typedef ResumeC2S TableType;
+  std::vector<uint32_t> players{};
+  std::vector<uint32_t> lasers{};
+};
+
+struct ResumeC2S FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
+  typedef ResumeC2ST NativeTableType;
+  typedef ResumeC2SBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_PLAYERS = 4,
+    VT_LASERS = 6
+  };
+  const ::flatbuffers::Vector<uint32_t> *players() const {
+    return GetPointer<const ::flatbuffers::Vector<uint32_t> *>(VT_PLAYERS);
+  }
+  ::flatbuffers::Vector<uint32_t> *mutable_players() {
+    return GetPointer<::flatbuffers::Vector<uint32_t> *>(VT_PLAYERS);
+  }
+  const ::flatbuffers::Vector<uint32_t> *lasers() const {
+    return GetPointer<const ::flatbuffers::Vector<uint32_t> *>(VT_LASERS);
+  }
+  ::flatbuffers::Vector<uint32_t> *mutable_lasers() {
+    return GetPointer<::flatbuffers::Vector<uint32_t> *>(VT_LASERS);
+  }
+  bool Verify(::flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_PLAYERS) &&
+           verifier.VerifyVector(players()) &&
+           VerifyOffset(verifier, VT_LASERS) &&
+           verifier.VerifyVector(lasers()) &&
+           verifier.EndTable();
+  }
+  ResumeC2ST *UnPack(const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(ResumeC2ST *_o, const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static ::flatbuffers::Offset<ResumeC2S> Pack(::flatbuffers::FlatBufferBuilder &_fbb, const ResumeC2ST* _o, const ::flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct ResumeC2SBuilder {
+  typedef ResumeC2S Table;
+  ::flatbuffers::FlatBufferBuilder &fbb_;
+  ::flatbuffers::uoffset_t start_;
+  void add_players(::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> players) {
+    fbb_.AddOffset(ResumeC2S::VT_PLAYERS, players);
+  }
+  void add_lasers(::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> lasers) {
+    fbb_.AddOffset(ResumeC2S::VT_LASERS, lasers);
+  }
+  explicit ResumeC2SBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ::flatbuffers::Offset<ResumeC2S> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = ::flatbuffers::Offset<ResumeC2S>(end);
+    return o;
+  }
+};
+
+inline ::flatbuffers::Offset<ResumeC2S> CreateResumeC2S(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    ::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> players = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> lasers = 0) {
+  ResumeC2SBuilder builder_(_fbb);
+  builder_.add_lasers(lasers);
+  builder_.add_players(players);
+  return builder_.Finish();
+}
+
+inline ::flatbuffers::Offset<ResumeC2S> CreateResumeC2SDirect(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<uint32_t> *players = nullptr,
+    const std::vector<uint32_t> *lasers = nullptr) {
+  auto players__ = players ? _fbb.CreateVector<uint32_t>(*players) : 0;
+  auto lasers__ = lasers ? _fbb.CreateVector<uint32_t>(*lasers) : 0;
+  return Protocol::CreateResumeC2S(
+      _fbb,
+      players__,
+      lasers__);
+}
+
+::flatbuffers::Offset<ResumeC2S> CreateResumeC2S(::flatbuffers::FlatBufferBuilder &_fbb, const ResumeC2ST *_o, const ::flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
+struct ClientHelloC2ST : public ::flatbuffers::NativeTable {
+  typedef ClientHelloC2S TableType;
+  uint16_t dictionary_id = 0;
+};
+
+struct ClientHelloC2S FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
+  typedef ClientHelloC2ST NativeTableType;
+  typedef ClientHelloC2SBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DICTIONARY_ID = 4
+  };
+  uint16_t dictionary_id() const {
+    return GetField<uint16_t>(VT_DICTIONARY_ID, 0);
+  }
+  bool mutate_dictionary_id(uint16_t _dictionary_id = 0) {
+    return SetField<uint16_t>(VT_DICTIONARY_ID, _dictionary_id, 0);
+  }
+  bool Verify(::flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint16_t>(verifier, VT_DICTIONARY_ID, 2) &&
+           verifier.EndTable();
+  }
+  ClientHelloC2ST *UnPack(const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(ClientHelloC2ST *_o, const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static ::flatbuffers::Offset<ClientHelloC2S> Pack(::flatbuffers::FlatBufferBuilder &_fbb, const ClientHelloC2ST* _o, const ::flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct ClientHelloC2SBuilder {
+  typedef ClientHelloC2S Table;
+  ::flatbuffers::FlatBufferBuilder &fbb_;
+  ::flatbuffers::uoffset_t start_;
+  void add_dictionary_id(uint16_t dictionary_id) {
+    fbb_.AddElement<uint16_t>(ClientHelloC2S::VT_DICTIONARY_ID, dictionary_id, 0);
+  }
+  explicit ClientHelloC2SBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ::flatbuffers::Offset<ClientHelloC2S> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = ::flatbuffers::Offset<ClientHelloC2S>(end);
+    return o;
+  }
+};
+
+inline ::flatbuffers::Offset<ClientHelloC2S> CreateClientHelloC2S(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    uint16_t dictionary_id = 0) {
+  ClientHelloC2SBuilder builder_(_fbb);
+  builder_.add_dictionary_id(dictionary_id);
+  return builder_.Finish();
+}
+
+::flatbuffers::Offset<ClientHelloC2S> CreateClientHelloC2S(::flatbuffers::FlatBufferBuilder &_fbb, const ClientHelloC2ST *_o, const ::flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
+struct ZoneHandoffZ2ZT : public ::flatbuffers::NativeTable {
+  typedef ZoneHandoffZ2Z TableType;
+  std::unique_ptr<Protocol::Player> player{};
+  uint32_t session_token = 0;
+  float current_speed = 0;
+  float rotation_z = 0;
+  float rot_x_smooth = 0;
+  float rot_y_smooth = 0;
+  float rot_z_smooth = 0;
+  uint16_t input_bitmap = 0;
+  uint32_t input_time = 0;
+  float input_cooldown = 0;
+  std::vector<Protocol::Laser> lasers{};
+  ZoneHandoffZ2ZT() = default;
+  ZoneHandoffZ2ZT(const ZoneHandoffZ2ZT &o);
+  ZoneHandoffZ2ZT(ZoneHandoffZ2ZT&&) FLATBUFFERS_NOEXCEPT = default;
+  ZoneHandoffZ2ZT &operator=(ZoneHandoffZ2ZT o) FLATBUFFERS_NOEXCEPT;
+};
+
+struct ZoneHandoffZ2Z FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
+  typedef ZoneHandoffZ2ZT NativeTableType;
+  typedef ZoneHandoffZ2ZBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_PLAYER = 4,
+    VT_SESSION_TOKEN = 6,
+    VT_CURRENT_SPEED = 8,
+    VT_ROTATION_Z = 10,
+    VT_ROT_X_SMOOTH = 12,
+    VT_ROT_Y_SMOOTH = 14,
+    VT_ROT_Z_SMOOTH = 16,
+    VT_INPUT_BITMAP = 18,
+    VT_INPUT_TIME = 20,
+    VT_INPUT_COOLDOWN = 22,
+    VT_LASERS = 24
+  };
+  const Protocol::Player *player() const {
+    return GetStruct<const Protocol::Player *>(VT_PLAYER);
+  }
+  Protocol::Player *mutable_player() {
+    return GetStruct<Protocol::Player *>(VT_PLAYER);
+  }
+  uint32_t session_token() const {
+    return GetField<uint32_t>(VT_SESSION_TOKEN, 0);
+  }
+  bool mutate_session_token(uint32_t _session_token = 0) {
+    return SetField<uint32_t>(VT_SESSION_TOKEN, _session_token, 0);
+  }
+  float current_speed() const {
+    return GetField<float>(VT_CURRENT_SPEED, 0);
+  }
+  bool mutate_current_speed(float _current_speed = 0) {
+    return SetField<float>(VT_CURRENT_SPEED, _current_speed, 0);
+  }
+  float rotation_z() const {
+    return GetField<float>(VT_ROTATION_Z, 0);
+  }
+  bool mutate_rotation_z(float _rotation_z = 0) {
+    return SetField<float>(VT_ROTATION_Z, _rotation_z, 0);
+  }
+  float rot_x_smooth() const {
+    return GetField<float>(VT_ROT_X_SMOOTH, 0);
+  }
+  bool mutate_rot_x_smooth(float _rot_x_smooth = 0) {
+    return SetField<float>(VT_ROT_X_SMOOTH, _rot_x_smooth, 0);
+  }
+  float rot_y_smooth() const {
+    return GetField<float>(VT_ROT_Y_SMOOTH, 0);
+  }
+  bool mutate_rot_y_smooth(float _rot_y_smooth = 0) {
+    return SetField<float>(VT_ROT_Y_SMOOTH, _rot_y_smooth, 0);
+  }
+  float rot_z_smooth() const {
+    return GetField<float>(VT_ROT_Z_SMOOTH, 0);
+  }
+  bool mutate_rot_z_smooth(float _rot_z_smooth = 0) {
+    return SetField<float>(VT_ROT_Z_SMOOTH, _rot_z_smooth, 0);
+  }
+  uint16_t input_bitmap() const {
+    return GetField<uint16_t>(VT_INPUT_BITMAP, 0);
+  }
+  bool mutate_input_bitmap(uint16_t _input_bitmap = 0) {
+    return SetField<uint16_t>(VT_INPUT_BITMAP, _input_bitmap, 0);
+  }
+  uint32_t input_time() const {
+    return GetField<uint32_t>(VT_INPUT_TIME, 0);
+  }
+  bool mutate_input_time(uint32_t _input_time = 0) {
+    return SetField<uint32_t>(VT_INPUT_TIME, _input_time, 0);
+  }
+  float input_cooldown() const {
+    return GetField<float>(VT_INPUT_COOLDOWN, 0);
+  }
+  bool mutate_input_cooldown(float _input_cooldown = 0) {
+    return SetField<float>(VT_INPUT_COOLDOWN, _input_cooldown, 0);
+  }
+  const ::flatbuffers::Vector<const Protocol::Laser *> *lasers() const {
+    return GetPointer<const ::flatbuffers::Vector<const Protocol::Laser *> *>(VT_LASERS);
+  }
+  ::flatbuffers::Vector<const Protocol::Laser *> *mutable_lasers() {
+    return GetPointer<::flatbuffers::Vector<const Protocol::Laser *> *>(VT_LASERS);
+  }
+  bool Verify(::flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<Protocol::Player>(verifier, VT_PLAYER, 4) &&
+           VerifyField<uint32_t>(verifier, VT_SESSION_TOKEN, 4) &&
+           VerifyField<float>(verifier, VT_CURRENT_SPEED, 4) &&
+           VerifyField<float>(verifier, VT_ROTATION_Z, 4) &&
+           VerifyField<float>(verifier, VT_ROT_X_SMOOTH, 4) &&
+           VerifyField<float>(verifier, VT_ROT_Y_SMOOTH, 4) &&
+           VerifyField<float>(verifier, VT_ROT_Z_SMOOTH, 4) &&
+           VerifyField<uint16_t>(verifier, VT_INPUT_BITMAP, 2) &&
+           VerifyField<uint32_t>(verifier, VT_INPUT_TIME, 4) &&
+           VerifyField<float>(verifier, VT_INPUT_COOLDOWN, 4) &&
+           VerifyOffset(verifier, VT_LASERS) &&
+           verifier.VerifyVector(lasers()) &&
+           verifier.EndTable();
+  }
+  ZoneHandoffZ2ZT *UnPack(const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(ZoneHandoffZ2ZT *_o, const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static ::flatbuffers::Offset<ZoneHandoffZ2Z> Pack(::flatbuffers::FlatBufferBuilder &_fbb, const ZoneHandoffZ2ZT* _o, const ::flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct ZoneHandoffZ2ZBuilder {
+  typedef ZoneHandoffZ2Z Table;
+  ::flatbuffers::FlatBufferBuilder &fbb_;
+  ::flatbuffers::uoffset_t start_;
+  void add_player(const Protocol::Player *player) {
+    fbb_.AddStruct(ZoneHandoffZ2Z::VT_PLAYER, player);
+  }
+  void add_session_token(uint32_t session_token) {
+    fbb_.AddElement<uint32_t>(ZoneHandoffZ2Z::VT_SESSION_TOKEN, session_token, 0);
+  }
+  void add_current_speed(float current_speed) {
+    fbb_.AddElement<float>(ZoneHandoffZ2Z::VT_CURRENT_SPEED, current_speed, 0);
+  }
+  void add_rotation_z(float rotation_z) {
+    fbb_.AddElement<float>(ZoneHandoffZ2Z::VT_ROTATION_Z, rotation_z, 0);
+  }
+  void add_rot_x_smooth(float rot_x_smooth) {
+    fbb_.AddElement<float>(ZoneHandoffZ2Z::VT_ROT_X_SMOOTH, rot_x_smooth, 0);
+  }
+  void add_rot_y_smooth(float rot_y_smooth) {
+    fbb_.AddElement<float>(ZoneHandoffZ2Z::VT_ROT_Y_SMOOTH, rot_y_smooth, 0);
+  }
+  void add_rot_z_smooth(float rot_z_smooth) {
+    fbb_.AddElement<float>(ZoneHandoffZ2Z::VT_ROT_Z_SMOOTH, rot_z_smooth, 0);
+  }
+  void add_input_bitmap(uint16_t input_bitmap) {
+    fbb_.AddElement<uint16_t>(ZoneHandoffZ2Z::VT_INPUT_BITMAP, input_bitmap, 0);
+  }
+  void add_input_time(uint32_t input_time) {
+    fbb_.AddElement<uint32_t>(ZoneHandoffZ2Z::VT_INPUT_TIME, input_time, 0);
+  }
+  void add_input_cooldown(float input_cooldown) {
+    fbb_.AddElement<float>(ZoneHandoffZ2Z::VT_INPUT_COOLDOWN, input_cooldown, 0);
+  }
+  void add_lasers(::flatbuffers::Offset<::flatbuffers::Vector<const Protocol::Laser *>> lasers) {
+    fbb_.AddOffset(ZoneHandoffZ2Z::VT_LASERS, lasers);
+  }
+  explicit ZoneHandoffZ2ZBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ::flatbuffers::Offset<ZoneHandoffZ2Z> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = ::flatbuffers::Offset<ZoneHandoffZ2Z>(end);
+    return o;
+  }
+};
+
+inline ::flatbuffers::Offset<ZoneHandoffZ2Z> CreateZoneHandoffZ2Z(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    const Protocol::Player *player = nullptr,
+    uint32_t session_token = 0,
+    float current_speed = 0,
+    float rotation_z = 0,
+    float rot_x_smooth = 0,
+    float rot_y_smooth = 0,
+    float rot_z_smooth = 0,
+    uint16_t input_bitmap = 0,
+    uint32_t input_time = 0,
+    float input_cooldown = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<const Protocol::Laser *>> lasers = 0) {
+  ZoneHandoffZ2ZBuilder builder_(_fbb);
+  builder_.add_lasers(lasers);
+  builder_.add_input_cooldown(input_cooldown);
+  builder_.add_input_time(input_time);
+  builder_.add_rot_z_smooth(rot_z_smooth);
+  builder_.add_rot_y_smooth(rot_y_smooth);
+  builder_.add_rot_x_smooth(rot_x_smooth);
+  builder_.add_rotation_z(rotation_z);
+  builder_.add_current_speed(current_speed);
+  builder_.add_session_token(session_token);
+  builder_.add_player(player);
+  builder_.add_input_bitmap(input_bitmap);
+  return builder_.Finish();
+}
+
+inline ::flatbuffers::Offset<ZoneHandoffZ2Z> CreateZoneHandoffZ2ZDirect(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    const Protocol::Player *player = nullptr,
+    uint32_t session_token = 0,
+    float current_speed = 0,
+    float rotation_z = 0,
+    float rot_x_smooth = 0,
+    float rot_y_smooth = 0,
+    float rot_z_smooth = 0,
+    uint16_t input_bitmap = 0,
+    uint32_t input_time = 0,
+    float input_cooldown = 0,
+    const std::vector<Protocol::Laser> *lasers = nullptr) {
+  auto lasers__ = lasers ? _fbb.CreateVectorOfStructs<Protocol::Laser>(*lasers) : 0;
+  return Protocol::CreateZoneHandoffZ2Z(
+      _fbb,
+      player,
+      session_token,
+      current_speed,
+      rotation_z,
+      rot_x_smooth,
+      rot_y_smooth,
+      rot_z_smooth,
+      input_bitmap,
+      input_time,
+      input_cooldown,
+      lasers__);
+}
+
+::flatbuffers::Offset<ZoneHandoffZ2Z> CreateZoneHandoffZ2Z(::flatbuffers::FlatBufferBuilder &_fbb, const ZoneHandoffZ2ZT *_o, const ::flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
+struct ZoneGhostsZ2ZT : public ::flatbuffers::NativeTable {
+  typedef ZoneGhostsZ2Z TableType;
+  uint32_t time = 0;
+  std::vector<Protocol::Player> players{};
+};
+
+struct ZoneGhostsZ2Z FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
+  typedef ZoneGhostsZ2ZT NativeTableType;
+  typedef ZoneGhostsZ2ZBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_TIME = 4,
+    VT_PLAYERS = 6
+  };
+  uint32_t time() const {
+    return GetField<uint32_t>(VT_TIME, 0);
+  }
+  bool mutate_time(uint32_t _time = 0) {
+    return SetField<uint32_t>(VT_TIME, _time, 0);
+  }
+  const ::flatbuffers::Vector<const Protocol::Player *> *players() const {
+    return GetPointer<const ::flatbuffers::Vector<const Protocol::Player *> *>(VT_PLAYERS);
+  }
+  ::flatbuffers::Vector<const Protocol::Player *> *mutable_players() {
+    return GetPointer<::flatbuffers::Vector<const Protocol::Player *> *>(VT_PLAYERS);
+  }
+  bool Verify(::flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint32_t>(verifier, VT_TIME, 4) &&
+           VerifyOffset(verifier, VT_PLAYERS) &&
+           verifier.VerifyVector(players()) &&
+           verifier.EndTable();
+  }
+  ZoneGhostsZ2ZT *UnPack(const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(ZoneGhostsZ2ZT *_o, const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static ::flatbuffers::Offset<ZoneGhostsZ2Z> Pack(::flatbuffers::FlatBufferBuilder &_fbb, const ZoneGhostsZ2ZT* _o, const ::flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct ZoneGhostsZ2ZBuilder {
+  typedef ZoneGhostsZ2Z Table;
+  ::flatbuffers::FlatBufferBuilder &fbb_;
+  ::flatbuffers::uoffset_t start_;
+  void add_time(uint32_t time) {
+    fbb_.AddElement<uint32_t>(ZoneGhostsZ2Z::VT_TIME, time, 0);
+  }
+  void add_players(::flatbuffers::Offset<::flatbuffers::Vector<const Protocol::Player *>> players) {
+    fbb_.AddOffset(ZoneGhostsZ2Z::VT_PLAYERS, players);
+  }
+  explicit ZoneGhostsZ2ZBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ::flatbuffers::Offset<ZoneGhostsZ2Z> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = ::flatbuffers::Offset<ZoneGhostsZ2Z>(end);
+    return o;
+  }
+};
+
+inline ::flatbuffers::Offset<ZoneGhostsZ2Z> CreateZoneGhostsZ2Z(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t time = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<const Protocol::Player *>> players = 0) {
+  ZoneGhostsZ2ZBuilder builder_(_fbb);
+  builder_.add_players(players);
+  builder_.add_time(time);
+  return builder_.Finish();
+}
+
+inline ::flatbuffers::Offset<ZoneGhostsZ2Z> CreateZoneGhostsZ2ZDirect(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t time = 0,
+    const std::vector<Protocol::Player> *players = nullptr) {
+  auto players__ = players ? _fbb.CreateVectorOfStructs<Protocol::Player>(*players) : 0;
+  return Protocol::CreateZoneGhostsZ2Z(
+      _fbb,
+      time,
+      players__);
+}
+
+::flatbuffers::Offset<ZoneGhostsZ2Z> CreateZoneGhostsZ2Z(::flatbuffers::FlatBufferBuilder &_fbb, const ZoneGhostsZ2ZT *_o, const ::flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
+struct ZoneRedirectS2CT : public ::flatbuffers::NativeTable {
+  typedef ZoneRedirectS2C TableType;
+  uint32_t host = 0;
+  uint16_t port = 0;
+  uint32_t session_token = 0;
+};
+
+struct ZoneRedirectS2C FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
+  typedef ZoneRedirectS2CT NativeTableType;
+  typedef ZoneRedirectS2CBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_HOST = 4,
+    VT_PORT = 6,
+    VT_SESSION_TOKEN = 8
+  };
+  uint32_t host() const {
+    return GetField<uint32_t>(VT_HOST, 0);
+  }
+  bool mutate_host(uint32_t _host = 0) {
+    return SetField<uint32_t>(VT_HOST, _host, 0);
+  }
+  uint16_t port() const {
+    return GetField<uint16_t>(VT_PORT, 0);
+  }
+  bool mutate_port(uint16_t _port = 0) {
+    return SetField<uint16_t>(VT_PORT, _port, 0);
+  }
+  uint32_t session_token() const {
+    return GetField<uint32_t>(VT_SESSION_TOKEN, 0);
+  }
+  bool mutate_session_token(uint32_t _session_token = 0) {
+    return SetField<uint32_t>(VT_SESSION_TOKEN, _session_token, 0);
+  }
+  bool Verify(::flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint32_t>(verifier, VT_HOST, 4) &&
+           VerifyField<uint16_t>(verifier, VT_PORT, 2) &&
+           VerifyField<uint32_t>(verifier, VT_SESSION_TOKEN, 4) &&
+           verifier.EndTable();
+  }
+  ZoneRedirectS2CT *UnPack(const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(ZoneRedirectS2CT *_o, const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static ::flatbuffers::Offset<ZoneRedirectS2C> Pack(::flatbuffers::FlatBufferBuilder &_fbb, const ZoneRedirectS2CT* _o, const ::flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct ZoneRedirectS2CBuilder {
+  typedef ZoneRedirectS2C Table;
+  ::flatbuffers::FlatBufferBuilder &fbb_;
+  ::flatbuffers::uoffset_t start_;
+  void add_host(uint32_t host) {
+    fbb_.AddElement<uint32_t>(ZoneRedirectS2C::VT_HOST, host, 0);
+  }
+  void add_port(uint16_t port) {
+    fbb_.AddElement<uint16_t>(ZoneRedirectS2C::VT_PORT, port, 0);
+  }
+  void add_session_token(uint32_t session_token) {
+    fbb_.AddElement<uint32_t>(ZoneRedirectS2C::VT_SESSION_TOKEN, session_token, 0);
+  }
+  explicit ZoneRedirectS2CBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ::flatbuffers::Offset<ZoneRedirectS2C> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = ::flatbuffers::Offset<ZoneRedirectS2C>(end);
+    return o;
+  }
+};
+
+inline ::flatbuffers::Offset<ZoneRedirectS2C> CreateZoneRedirectS2C(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t host = 0,
+    uint16_t port = 0,
+    uint32_t session_token = 0) {
+  ZoneRedirectS2CBuilder builder_(_fbb);
+  builder_.add_session_token(session_token);
+  builder_.add_host(host);
+  builder_.add_port(port);
+  return builder_.Finish();
+}
+
+::flatbuffers::Offset<ZoneRedirectS2C> CreateZoneRedirectS2C(::flatbuffers::FlatBufferBuilder &_fbb, const ZoneRedirectS2CT *_o, const ::flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
 inline PacketWrapperT *PacketWrapper::UnPack(const ::flatbuffers::resolver_function_t *_resolver) const {
   auto _o = std::unique_ptr<PacketWrapperT>(new PacketWrapperT());
   UnPackTo(_o.get(), _resolver);
@@ -1565,6 +2362,8 @@ inline void ClientConnectS2C::UnPackTo(ClientConnectS2CT *_o, const ::flatbuffer
   (void)_resolver;
   { auto _e = uuid(); _o->uuid = _e; }
   { auto _e = time(); _o->time = _e; }
+  { auto _e = session_token(); _o->session_token = _e; }
+  { auto _e = wire_format(); _o->wire_format = _e; }
 }
 
 inline ::flatbuffers::Offset<ClientConnectS2C> ClientConnectS2C::Pack(::flatbuffers::FlatBufferBuilder &_fbb, const ClientConnectS2CT* _o, const ::flatbuffers::rehasher_function_t *_rehasher) {
@@ -1577,10 +2376,14 @@ inline ::flatbuffers::Offset<ClientConnectS2C> CreateClientConnectS2C(::flatbuff
   struct _VectorArgs { ::flatbuffers::FlatBufferBuilder *__fbb; const ClientConnectS2CT* __o; const ::flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
   auto _uuid = _o->uuid;
   auto _time = _o->time;
+  auto _session_token = _o->session_token;
+  auto _wire_format = _o->wire_format;
   return Protocol::CreateClientConnectS2C(
       _fbb,
       _uuid,
-      _time);
+      _time,
+      _session_token,
+      _wire_format);
 }
 
 inline GameStateS2CT *GameStateS2C::UnPack(const ::flatbuffers::resolver_function_t *_resolver) const {
@@ -1675,12 +2478,18 @@ inline ::flatbuffers::Offset<DespawnPlayerS2C> CreateDespawnPlayerS2C(::flatbuff
 
 inline UpdatePlayerS2CT::UpdatePlayerS2CT(const UpdatePlayerS2CT &o)
       : time(o.time),
-        player((o.player) ? new Protocol::Player(*o.player) : nullptr) {
+        player((o.player) ? new Protocol::Player(*o.player) : nullptr),
+        interval_ms(o.interval_ms),
+        input_ack_seq(o.input_ack_seq),
+        input_ack_delay(o.input_ack_delay) {
 }
 
 inline UpdatePlayerS2CT &UpdatePlayerS2CT::operator=(UpdatePlayerS2CT o) FLATBUFFERS_NOEXCEPT {
   std::swap(time, o.time);
   std::swap(player, o.player);
+  std::swap(interval_ms, o.interval_ms);
+  std::swap(input_ack_seq, o.input_ack_seq);
+  std::swap(input_ack_delay, o.input_ack_delay);
   return *this;
 }
 
@@ -1695,6 +2504,9 @@ inline void UpdatePlayerS2C::UnPackTo(UpdatePlayerS2CT *_o, const ::flatbuffers:
   (void)_resolver;
   { auto _e = time(); _o->time = _e; }
   { auto _e = player(); if (_e) _o->player = std::unique_ptr<Protocol::Player>(new Protocol::Player(*_e)); }
+  { auto _e = interval_ms(); _o->interval_ms = _e; }
+  { auto _e = input_ack_seq(); _o->input_ack_seq = _e; }
+  { auto _e = input_ack_delay(); _o->input_ack_delay = _e; }
 }
 
 inline ::flatbuffers::Offset<UpdatePlayerS2C> UpdatePlayerS2C::Pack(::flatbuffers::FlatBufferBuilder &_fbb, const UpdatePlayerS2CT* _o, const ::flatbuffers::rehasher_function_t *_rehasher) {
@@ -1707,10 +2519,16 @@ inline ::flatbuffers::Offset<UpdatePlayerS2C> CreateUpdatePlayerS2C(::flatbuffer
   struct _VectorArgs { ::flatbuffers::FlatBufferBuilder *__fbb; const UpdatePlayerS2CT* __o; const ::flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
   auto _time = _o->time;
   auto _player = _o->player ? _o->player.get() : nullptr;
+  auto _interval_ms = _o->interval_ms;
+  auto _input_ack_seq = _o->input_ack_seq;
+  auto _input_ack_delay = _o->input_ack_delay;
   return Protocol::CreateUpdatePlayerS2C(
       _fbb,
       _time,
-      _player);
+      _player,
+      _interval_ms,
+      _input_ack_seq,
+      _input_ack_delay);
 }
 
 inline TeleportPlayerS2CT::TeleportPlayerS2CT(const TeleportPlayerS2CT &o)
@@ -1772,6 +2590,8 @@ inline void SpawnLaserS2C::UnPackTo(SpawnLaserS2CT *_o, const ::flatbuffers::res
   (void)_o;
   (void)_resolver;
   { auto _e = laser(); if (_e) _o->laser = std::unique_ptr<Protocol::Laser>(new Protocol::Laser(*_e)); }
+  { auto _e = owner_id(); _o->owner_id = _e; }
+  { auto _e = shot_seq(); _o->shot_seq = _e; }
 }
 
 inline ::flatbuffers::Offset<SpawnLaserS2C> SpawnLaserS2C::Pack(::flatbuffers::FlatBufferBuilder &_fbb, const SpawnLaserS2CT* _o, const ::flatbuffers::rehasher_function_t *_rehasher) {
@@ -1783,9 +2603,13 @@ inline ::flatbuffers::Offset<SpawnLaserS2C> CreateSpawnLaserS2C(::flatbuffers::F
   (void)_o;
   struct _VectorArgs { ::flatbuffers::FlatBufferBuilder *__fbb; const SpawnLaserS2CT* __o; const ::flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
   auto _laser = _o->laser ? _o->laser.get() : nullptr;
+  auto _owner_id = _o->owner_id;
+  auto _shot_seq = _o->shot_seq;
   return Protocol::CreateSpawnLaserS2C(
       _fbb,
-      _laser);
+      _laser,
+      _owner_id,
+      _shot_seq);
 }
 
 inline DespawnLaserS2CT *DespawnLaserS2C::UnPack(const ::flatbuffers::resolver_function_t *_resolver) const {
@@ -1880,6 +2704,8 @@ inline void InputC2S::UnPackTo(InputC2ST *_o, const ::flatbuffers::resolver_func
   (void)_resolver;
   { auto _e = time(); _o->time = _e; }
   { auto _e = bitmap(); _o->bitmap = _e; }
+  { auto _e = shot_seq(); _o->shot_seq = _e; }
+  { auto _e = input_seq(); _o->input_seq = _e; }
 }
 
 inline ::flatbuffers::Offset<InputC2S> InputC2S::Pack(::flatbuffers::FlatBufferBuilder &_fbb, const InputC2ST* _o, const ::flatbuffers::rehasher_function_t *_rehasher) {
@@ -1892,10 +2718,14 @@ inline ::flatbuffers::Offset<InputC2S> CreateInputC2S(::flatbuffers::FlatBufferB
   struct _VectorArgs { ::flatbuffers::FlatBufferBuilder *__fbb; const InputC2ST* __o; const ::flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
   auto _time = _o->time;
   auto _bitmap = _o->bitmap;
+  auto _shot_seq = _o->shot_seq;
+  auto _input_seq = _o->input_seq;
   return Protocol::CreateInputC2S(
       _fbb,
       _time,
-      _bitmap);
+      _bitmap,
+      _shot_seq,
+      _input_seq);
 }
 
 inline TextC2ST *TextC2S::UnPack(const ::flatbuffers::resolver_function_t *_resolver) const {
@@ -1924,6 +2754,207 @@ inline ::flatbuffers::Offset<TextC2S> CreateTextC2S(::flatbuffers::FlatBufferBui
       _text);
 }
 
+inline ResumeC2ST *ResumeC2S::UnPack(const ::flatbuffers::resolver_function_t *_resolver) const {
+  auto _o = std::unique_ptr<ResumeC2ST>(new ResumeC2ST());
+  UnPackTo(_o.get(), _resolver);
+  return _o.release();
+}
+
+inline void ResumeC2S::UnPackTo(ResumeC2ST *_o, const ::flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = players(); if (_e) { _o->players.resize(_e->size()); for (::flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->players[_i] = _e->Get(_i); } } else { _o->players.resize(0); } }
+  { auto _e = lasers(); if (_e) { _o->lasers.resize(_e->size()); for (::flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->lasers[_i] = _e->Get(_i); } } else { _o->lasers.resize(0); } }
+}
+
+inline ::flatbuffers::Offset<ResumeC2S> ResumeC2S::Pack(::flatbuffers::FlatBufferBuilder &_fbb, const ResumeC2ST* _o, const ::flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateResumeC2S(_fbb, _o, _rehasher);
+}
+
+inline ::flatbuffers::Offset<ResumeC2S> CreateResumeC2S(::flatbuffers::FlatBufferBuilder &_fbb, const ResumeC2ST *_o, const ::flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { ::flatbuffers::FlatBufferBuilder *__fbb; const ResumeC2ST* __o; const ::flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _players = _o->players.size() ? _fbb.CreateVector(_o->players) : 0;
+  auto _lasers = _o->lasers.size() ? _fbb.CreateVector(_o->lasers) : 0;
+  return Protocol::CreateResumeC2S(
+      _fbb,
+      _players,
+      _lasers);
+}
+
+inline ClientHelloC2ST *ClientHelloC2S::UnPack(const ::flatbuffers::resolver_function_t *_resolver) const {
+  auto _o = std::unique_ptr<ClientHelloC2ST>(new ClientHelloC2ST());
+  UnPackTo(_o.get(), _resolver);
+  return _o.release();
+}
+
+inline void ClientHelloC2S::UnPackTo(ClientHelloC2ST *_o, const ::flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = dictionary_id(); _o->dictionary_id = _e; }
+}
+
+inline ::flatbuffers::Offset<ClientHelloC2S> ClientHelloC2S::Pack(::flatbuffers::FlatBufferBuilder &_fbb, const ClientHelloC2ST* _o, const ::flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateClientHelloC2S(_fbb, _o, _rehasher);
+}
+
+inline ::flatbuffers::Offset<ClientHelloC2S> CreateClientHelloC2S(::flatbuffers::FlatBufferBuilder &_fbb, const ClientHelloC2ST *_o, const ::flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { ::flatbuffers::FlatBufferBuilder *__fbb; const ClientHelloC2ST* __o; const ::flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _dictionary_id = _o->dictionary_id;
+  return Protocol::CreateClientHelloC2S(
+      _fbb,
+      _dictionary_id);
+}
+
+inline ZoneHandoffZ2ZT::ZoneHandoffZ2ZT(const ZoneHandoffZ2ZT &o)
+      : player((o.player) ? new Protocol::Player(*o.player) : nullptr),
+        session_token(o.session_token),
+        current_speed(o.current_speed),
+        rotation_z(o.rotation_z),
+        rot_x_smooth(o.rot_x_smooth),
+        rot_y_smooth(o.rot_y_smooth),
+        rot_z_smooth(o.rot_z_smooth),
+        input_bitmap(o.input_bitmap),
+        input_time(o.input_time),
+        input_cooldown(o.input_cooldown),
+        lasers(o.lasers) {
+}
+
+inline ZoneHandoffZ2ZT &ZoneHandoffZ2ZT::operator=(ZoneHandoffZ2ZT o) FLATBUFFERS_NOEXCEPT {
+  std::swap(player, o.player);
+  std::swap(session_token, o.session_token);
+  std::swap(current_speed, o.current_speed);
+  std::swap(rotation_z, o.rotation_z);
+  std::swap(rot_x_smooth, o.rot_x_smooth);
+  std::swap(rot_y_smooth, o.rot_y_smooth);
+  std::swap(rot_z_smooth, o.rot_z_smooth);
+  std::swap(input_bitmap, o.input_bitmap);
+  std::swap(input_time, o.input_time);
+  std::swap(input_cooldown, o.input_cooldown);
+  std::swap(lasers, o.lasers);
+  return *this;
+}
+
+inline ZoneHandoffZ2ZT *ZoneHandoffZ2Z::UnPack(const ::flatbuffers::resolver_function_t *_resolver) const {
+  auto _o = std::unique_ptr<ZoneHandoffZ2ZT>(new ZoneHandoffZ2ZT());
+  UnPackTo(_o.get(), _resolver);
+  return _o.release();
+}
+
+inline void ZoneHandoffZ2Z::UnPackTo(ZoneHandoffZ2ZT *_o, const ::flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = player(); if (_e) _o->player = std::unique_ptr<Protocol::Player>(new Protocol::Player(*_e)); }
+  { auto _e = session_token(); _o->session_token = _e; }
+  { auto _e = current_speed(); _o->current_speed = _e; }
+  { auto _e = rotation_z(); _o->rotation_z = _e; }
+  { auto _e = rot_x_smooth(); _o->rot_x_smooth = _e; }
+  { auto _e = rot_y_smooth(); _o->rot_y_smooth = _e; }
+  { auto _e = rot_z_smooth(); _o->rot_z_smooth = _e; }
+  { auto _e = input_bitmap(); _o->input_bitmap = _e; }
+  { auto _e = input_time(); _o->input_time = _e; }
+  { auto _e = input_cooldown(); _o->input_cooldown = _e; }
+  { auto _e = lasers(); if (_e) { _o->lasers.resize(_e->size()); for (::flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->lasers[_i] = *_e->Get(_i); } } else { _o->lasers.resize(0); } }
+}
+
+inline ::flatbuffers::Offset<ZoneHandoffZ2Z> ZoneHandoffZ2Z::Pack(::flatbuffers::FlatBufferBuilder &_fbb, const ZoneHandoffZ2ZT* _o, const ::flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateZoneHandoffZ2Z(_fbb, _o, _rehasher);
+}
+
+inline ::flatbuffers::Offset<ZoneHandoffZ2Z> CreateZoneHandoffZ2Z(::flatbuffers::FlatBufferBuilder &_fbb, const ZoneHandoffZ2ZT *_o, const ::flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { ::flatbuffers::FlatBufferBuilder *__fbb; const ZoneHandoffZ2ZT* __o; const ::flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _player = _o->player ? _o->player.get() : nullptr;
+  auto _session_token = _o->session_token;
+  auto _current_speed = _o->current_speed;
+  auto _rotation_z = _o->rotation_z;
+  auto _rot_x_smooth = _o->rot_x_smooth;
+  auto _rot_y_smooth = _o->rot_y_smooth;
+  auto _rot_z_smooth = _o->rot_z_smooth;
+  auto _input_bitmap = _o->input_bitmap;
+  auto _input_time = _o->input_time;
+  auto _input_cooldown = _o->input_cooldown;
+  auto _lasers = _o->lasers.size() ? _fbb.CreateVectorOfStructs(_o->lasers) : 0;
+  return Protocol::CreateZoneHandoffZ2Z(
+      _fbb,
+      _player,
+      _session_token,
+      _current_speed,
+      _rotation_z,
+      _rot_x_smooth,
+      _rot_y_smooth,
+      _rot_z_smooth,
+      _input_bitmap,
+      _input_time,
+      _input_cooldown,
+      _lasers);
+}
+
+inline ZoneGhostsZ2ZT *ZoneGhostsZ2Z::UnPack(const ::flatbuffers::resolver_function_t *_resolver) const {
+  auto _o = std::unique_ptr<ZoneGhostsZ2ZT>(new ZoneGhostsZ2ZT());
+  UnPackTo(_o.get(), _resolver);
+  return _o.release();
+}
+
+inline void ZoneGhostsZ2Z::UnPackTo(ZoneGhostsZ2ZT *_o, const ::flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = time(); _o->time = _e; }
+  { auto _e = players(); if (_e) { _o->players.resize(_e->size()); for (::flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->players[_i] = *_e->Get(_i); } } else { _o->players.resize(0); } }
+}
+
+inline ::flatbuffers::Offset<ZoneGhostsZ2Z> ZoneGhostsZ2Z::Pack(::flatbuffers::FlatBufferBuilder &_fbb, const ZoneGhostsZ2ZT* _o, const ::flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateZoneGhostsZ2Z(_fbb, _o, _rehasher);
+}
+
+inline ::flatbuffers::Offset<ZoneGhostsZ2Z> CreateZoneGhostsZ2Z(::flatbuffers::FlatBufferBuilder &_fbb, const ZoneGhostsZ2ZT *_o, const ::flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { ::flatbuffers::FlatBufferBuilder *__fbb; const ZoneGhostsZ2ZT* __o; const ::flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _time = _o->time;
+  auto _players = _o->players.size() ? _fbb.CreateVectorOfStructs(_o->players) : 0;
+  return Protocol::CreateZoneGhostsZ2Z(
+      _fbb,
+      _time,
+      _players);
+}
+
+inline ZoneRedirectS2CT *ZoneRedirectS2C::UnPack(const ::flatbuffers::resolver_function_t *_resolver) const {
+  auto _o = std::unique_ptr<ZoneRedirectS2CT>(new ZoneRedirectS2CT());
+  UnPackTo(_o.get(), _resolver);
+  return _o.release();
+}
+
+inline void ZoneRedirectS2C::UnPackTo(ZoneRedirectS2CT *_o, const ::flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = host(); _o->host = _e; }
+  { auto _e = port(); _o->port = _e; }
+  { auto _e = session_token(); _o->session_token = _e; }
+}
+
+inline ::flatbuffers::Offset<ZoneRedirectS2C> ZoneRedirectS2C::Pack(::flatbuffers::FlatBufferBuilder &_fbb, const ZoneRedirectS2CT* _o, const ::flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateZoneRedirectS2C(_fbb, _o, _rehasher);
+}
+
+inline ::flatbuffers::Offset<ZoneRedirectS2C> CreateZoneRedirectS2C(::flatbuffers::FlatBufferBuilder &_fbb, const ZoneRedirectS2CT *_o, const ::flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { ::flatbuffers::FlatBufferBuilder *__fbb; const ZoneRedirectS2CT* __o; const ::flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _host = _o->host;
+  auto _port = _o->port;
+  auto _session_token = _o->session_token;
+  return Protocol::CreateZoneRedirectS2C(
+      _fbb,
+      _host,
+      _port,
+      _session_token);
+}
+
 inline bool VerifyPacketType(::flatbuffers::Verifier &verifier, const void *obj, PacketType type) {
   switch (type) {
     case PacketType_NONE: {
@@ -1977,6 +3008,26 @@ inline bool VerifyPacketType(::flatbuffers::Verifier &verifier, const void *obj,
       auto ptr = reinterpret_cast<const Protocol::TextS2C *>(obj);
       return verifier.VerifyTable(ptr);
     }
+    case PacketType_ResumeC2S: {
+      auto ptr = reinterpret_cast<const Protocol::ResumeC2S *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case PacketType_ClientHelloC2S: {
+      auto ptr = reinterpret_cast<const Protocol::ClientHelloC2S *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case PacketType_ZoneHandoffZ2Z: {
+      auto ptr = reinterpret_cast<const Protocol::ZoneHandoffZ2Z *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case PacketType_ZoneGhostsZ2Z: {
+      auto ptr = reinterpret_cast<const Protocol::ZoneGhostsZ2Z *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case PacketType_ZoneRedirectS2C: {
+      auto ptr = reinterpret_cast<const Protocol::ZoneRedirectS2C *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
     default: return true;
   }
 }
@@ -2044,6 +3095,26 @@ inline void *PacketTypeUnion::UnPack(const void *obj, PacketType type, const ::f
       auto ptr = reinterpret_cast<const Protocol::TextS2C *>(obj);
       return ptr->UnPack(resolver);
     }
+    case PacketType_ResumeC2S: {
+      auto ptr = reinterpret_cast<const Protocol::ResumeC2S *>(obj);
+      return ptr->UnPack(resolver);
+    }
+    case PacketType_ClientHelloC2S: {
+      auto ptr = reinterpret_cast<const Protocol::ClientHelloC2S *>(obj);
+      return ptr->UnPack(resolver);
+    }
+    case PacketType_ZoneHandoffZ2Z: {
+      auto ptr = reinterpret_cast<const Protocol::ZoneHandoffZ2Z *>(obj);
+      return ptr->UnPack(resolver);
+    }
+    case PacketType_ZoneGhostsZ2Z: {
+      auto ptr = reinterpret_cast<const Protocol::ZoneGhostsZ2Z *>(obj);
+      return ptr->UnPack(resolver);
+    }
+    case PacketType_ZoneRedirectS2C: {
+      auto ptr = reinterpret_cast<const Protocol::ZoneRedirectS2C *>(obj);
+      return ptr->UnPack(resolver);
+    }
     default: return nullptr;
   }
 }
@@ -2099,6 +3170,26 @@ inline ::flatbuffers::Offset<void> PacketTypeUnion::Pack(::flatbuffers::FlatBuff
       auto ptr = reinterpret_cast<const Protocol::TextS2CT *>(value);
       return CreateTextS2C(_fbb, ptr, _rehasher).Union();
     }
+    case PacketType_ResumeC2S: {
+      auto ptr = reinterpret_cast<const Protocol::ResumeC2ST *>(value);
+      return CreateResumeC2S(_fbb, ptr, _rehasher).Union();
+    }
+    case PacketType_ClientHelloC2S: {
+      auto ptr = reinterpret_cast<const Protocol::ClientHelloC2ST *>(value);
+      return CreateClientHelloC2S(_fbb, ptr, _rehasher).Union();
+    }
+    case PacketType_ZoneHandoffZ2Z: {
+      auto ptr = reinterpret_cast<const Protocol::ZoneHandoffZ2ZT *>(value);
+      return CreateZoneHandoffZ2Z(_fbb, ptr, _rehasher).Union();
+    }
+    case PacketType_ZoneGhostsZ2Z: {
+      auto ptr = reinterpret_cast<const Protocol::ZoneGhostsZ2ZT *>(value);
+      return CreateZoneGhostsZ2Z(_fbb, ptr, _rehasher).Union();
+    }
+    case PacketType_ZoneRedirectS2C: {
+      auto ptr = reinterpret_cast<const Protocol::ZoneRedirectS2CT *>(value);
+      return CreateZoneRedirectS2C(_fbb, ptr, _rehasher).Union();
+    }
     default: return 0;
   }
 }
@@ -2153,6 +3244,26 @@ inline PacketTypeUnion::PacketTypeUnion(const PacketTypeUnion &u) : type(u.type)
       value = new Protocol::TextS2CT(*reinterpret_cast<Protocol::TextS2CT *>(u.value));
       break;
     }
+    case PacketType_ResumeC2S: {
+      value = new Protocol::ResumeC2ST(*reinterpret_cast<Protocol::ResumeC2ST *>(u.value));
+      break;
+    }
+    case PacketType_ClientHelloC2S: {
+      value = new Protocol::ClientHelloC2ST(*reinterpret_cast<Protocol::ClientHelloC2ST *>(u.value));
+      break;
+    }
+    case PacketType_ZoneHandoffZ2Z: {
+      value = new Protocol::ZoneHandoffZ2ZT(*reinterpret_cast<Protocol::ZoneHandoffZ2ZT *>(u.value));
+      break;
+    }
+    case PacketType_ZoneGhostsZ2Z: {
+      value = new Protocol::ZoneGhostsZ2ZT(*reinterpret_cast<Protocol::ZoneGhostsZ2ZT *>(u.value));
+      break;
+    }
+    case PacketType_ZoneRedirectS2C: {
+      value = new Protocol::ZoneRedirectS2CT(*reinterpret_cast<Protocol::ZoneRedirectS2CT *>(u.value));
+      break;
+    }
     default:
       break;
   }
@@ -2220,6 +3331,31 @@ inline void PacketTypeUnion::Reset() {
       delete ptr;
       break;
     }
+    case PacketType_ResumeC2S: {
+      auto ptr = reinterpret_cast<Protocol::ResumeC2ST *>(value);
+      delete ptr;
+      break;
+    }
+    case PacketType_ClientHelloC2S: {
+      auto ptr = reinterpret_cast<Protocol::ClientHelloC2ST *>(value);
+      delete ptr;
+      break;
+    }
+    case PacketType_ZoneHandoffZ2Z: {
+      auto ptr = reinterpret_cast<Protocol::ZoneHandoffZ2ZT *>(value);
+      delete ptr;
+      break;
+    }
+    case PacketType_ZoneGhostsZ2Z: {
+      auto ptr = reinterpret_cast<Protocol::ZoneGhostsZ2ZT *>(value);
+      delete ptr;
+      break;
+    }
+    case PacketType_ZoneRedirectS2C: {
+      auto ptr = reinterpret_cast<Protocol::ZoneRedirectS2CT *>(value);
+      delete ptr;
+      break;
+    }
     default: break;
   }
   value = nullptr;
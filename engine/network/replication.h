@@ -0,0 +1,132 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+#include "bitpack.h"
+
+/*
+* DECLARATIVE REPLICATION
+*	- A SCHEMA LISTS THE NETWORKED FIELDS OF A PLAIN STATE STRUCT, EACH WITH ITS BitPack DESCRIPTOR (ONE DIRTY BIT PER FIELD)
+*	- DIRTY BITS ARE PER RECEIVER: CURRENT STATE AGAINST WHAT THAT RECEIVER LAST GOT, COMPARED AFTER QUANTIZATION
+*	- AN UPDATE CARRIES THE DIRTY MASK + ONLY THE DIRTY FIELDS, THE RECEIVER MERGES THEM INTO THE STATE IT KEEPS
+*	- RELIES ON RELIABLE, IN ORDER DELIVERY (EVERY SEND IS RELIABLE), A LOST UPDATE WOULD LEAVE THE FIELDS IT CARRIED STALE
+*	- THE SPAWNS / JOIN CHUNKS / FULL UPDATES A BASELINE STARTS FROM SHARE THE UPDATES CHANNEL (PacketStream_Ships), ENET ONLY ORDERS WITHIN ONE
+*	- ADDING A FIELD: A MEMBER IN THE STATE STRUCT + A Field<> IN THE SCHEMA, THE MESSAGE CODE STAYS THE SAME
+*/
+
+namespace Replication
+{
+
+template<auto MEMBER, typename CODEC>
+struct Field
+{
+    static constexpr uint32_t bits = CODEC::bits;
+
+    template<typename STATE> static bool Same(const STATE& a, const STATE& b) { return CODEC::Same(a.*MEMBER, b.*MEMBER); }
+    template<typename STATE> static bool Fits(const STATE& state) { return CODEC::Fits(state.*MEMBER); }
+    template<typename STATE> static void Write(BitPack::BitWriter& writer, const STATE& state) { CODEC::Write(writer, state.*MEMBER); }
+    template<typename STATE> static void Read(BitPack::BitReader& reader, STATE& state)
+    {
+        using Value = std::remove_reference_t<decltype(state.*MEMBER)>;
+        state.*MEMBER = Value(CODEC::Read(reader));
+    }
+    template<typename STATE> static void Copy(STATE& to, const STATE& from) { to.*MEMBER = from.*MEMBER; }
+};
+
+//Field i owns bit (1 << i) of the dirty mask, in the order they are listed
+template<typename STATE, typename... FIELDS>
+struct Schema
+{
+    static_assert(sizeof...(FIELDS) > 0 && sizeof...(FIELDS) <= 32, "a schema has 1..32 fields");
+    static constexpr uint32_t count = sizeof...(FIELDS);
+    static constexpr uint32_t all = uint32_t((uint64_t(1) << count) - 1);
+    using Mask = BitPack::UInt<all>;
+
+    //Fields of current the receiver would see differently from known
+    static uint32_t Dirty(const STATE& current, const STATE& known)
+    {
+        uint32_t mask = 0;
+        uint32_t bit = 1;
+        ((mask |= FIELDS::Same(current, known) ? 0 : bit, bit <<= 1), ...);
+        return mask;
+    }
+    static bool Fits(const STATE& state) { return (FIELDS::Fits(state) && ...); }
+    static void Write(BitPack::BitWriter& writer, const STATE& state, uint32_t mask)
+    {
+        Mask::Write(writer, mask);
+        uint32_t bit = 1;
+        ((mask & bit ? FIELDS::Write(writer, state) : void(), bit <<= 1), ...);
+    }
+    //Overwrites the fields present in the message, returns their mask
+    static uint32_t Read(BitPack::BitReader& reader, STATE& state)
+    {
+        const uint32_t mask = uint32_t(Mask::Read(reader));
+        uint32_t bit = 1;
+        ((mask & bit ? FIELDS::Read(reader, state) : void(), bit <<= 1), ...);
+        return mask;
+    }
+    static void Copy(STATE& to, const STATE& from, uint32_t mask)
+    {
+        uint32_t bit = 1;
+        ((mask & bit ? FIELDS::Copy(to, from) : void(), bit <<= 1), ...);
+    }
+};
+
+// ==========================
+// Ships
+// ==========================
+struct ShipState
+{
+    uint16_t intervalMs = 0; //receivers snapshot interval, lets the client size its interpolation buffer
+    glm::vec3 position = glm::vec3(0);
+    glm::vec3 velocity = glm::vec3(0);
+    glm::quat orientation = glm::identity<glm::quat>();
+};
+
+using ShipSchema = Schema<ShipState,
+    Field<&ShipState::intervalMs, BitPack::UInt<0xFF>>, //ms
+    Field<&ShipState::position, BitPack::QVec3<BitPack::QFloat<-2048, 2048, 22>>>, //~0.001 units
+    Field<&ShipState::velocity, BitPack::QVec3<BitPack::QFloat<-64, 64, 14>>>, //~0.008 units / s
+    Field<&ShipState::orientation, BitPack::QQuat<11>>>;
+
+//Bit packed UpdatePlayerS2C: tick + uuid + the ships dirty fields (+ the input ack, only in the owners update)
+struct ShipUpdateS2C
+{
+    using Uuid = BitPack::ShipId;
+    using HasAck = BitPack::UInt<1>;
+    using AckSeq = BitPack::UInt<0xFFFF>;
+    using AckDelay = BitPack::UInt<0xFFF>; //0.1ms, clamped to ~410ms
+
+    uint32_t tick = 0;
+    uint32_t uuid = 0;
+    uint32_t dirty = ShipSchema::all;
+    ShipState state;
+    uint16_t ackSeq = 0; //InputC2S seq of the receivers last applied input, 0 = no ack
+    uint16_t ackDelay = 0;
+
+    //Ships outside the described ranges are sent as FlatBuffers instead
+    bool Fits() const { return Uuid::Fits(uuid) && ShipSchema::Fits(state); }
+    void Write(BitPack::BitWriter& writer) const
+    {
+        BitPack::Type::Write(writer, BitPack::MessageType_UpdatePlayerS2C);
+        BitPack::TickStamp::Write(writer, tick);
+        Uuid::Write(writer, uuid);
+        ShipSchema::Write(writer, state, dirty);
+        HasAck::Write(writer, ackSeq != 0);
+        if (ackSeq == 0) return;
+        AckSeq::Write(writer, ackSeq);
+        AckDelay::Write(writer, std::min<uint16_t>(ackDelay, 0xFFF));
+    }
+    //Type already consumed by the dispatcher. Only the dirty fields of state are set, merge them with ShipSchema::Copy
+    bool Read(BitPack::BitReader& reader, uint32_t referenceTick)
+    {
+        tick = BitPack::TickStamp::Read(reader, referenceTick);
+        uuid = uint32_t(Uuid::Read(reader));
+        dirty = ShipSchema::Read(reader, state);
+        const bool hasAck = HasAck::Read(reader) != 0;
+        ackSeq = hasAck ? uint16_t(AckSeq::Read(reader)) : 0;
+        ackDelay = hasAck ? uint16_t(AckDelay::Read(reader)) : 0;
+        return reader.Ok();
+    }
+};
+
+} // namespace Replication
@@ -4,10 +4,41 @@
 
 #include <iostream>
 #include <chrono>
+#include <algorithm>
 
 #include "timer.h"
+#include "loopback.h"
+#include "ingress.h"
+#include "checkpoint.h"
+#include "core/cvar.h"
 
 #include <gtx/string_cast.hpp> //DEBUG LOG VEC3
+#include <gtc/type_ptr.hpp>
+
+static Core::CVar* sv_dr_position_tolerance = nullptr;
+static Core::CVar* sv_dr_angle_tolerance = nullptr;
+static Core::CVar* sv_dr_max_interval = nullptr;
+static Core::CVar* sv_rate_min_interval = nullptr;
+static Core::CVar* sv_rate_max_interval = nullptr;
+static Core::CVar* sv_rate_rtt_good = nullptr;
+static Core::CVar* sv_rate_rtt_bad = nullptr;
+static Core::CVar* sv_session_grace = nullptr;
+static Core::CVar* sv_bitpack = nullptr;
+static Core::CVar* sv_compression = nullptr;
+static Core::CVar* sv_compress_min = nullptr;
+static Core::CVar* sv_capture = nullptr;
+static Core::CVar* sv_backlog_soft = nullptr;
+static Core::CVar* sv_backlog_hard = nullptr;
+static Core::CVar* sv_backlog_timeout = nullptr;
+static Core::CVar* sv_ingress_workers = nullptr;
+static Core::CVar* sv_spectators = nullptr;
+static Core::CVar* sv_zone_count = nullptr;
+static Core::CVar* sv_zone_id = nullptr;
+static Core::CVar* sv_zone_size = nullptr;
+static Core::CVar* sv_zone_border = nullptr;
+static Core::CVar* sv_zone_hosts = nullptr;
+static Core::CVar* sv_checkpoint = nullptr;
+static Core::CVar* sv_checkpoint_interval = nullptr;
 
 #pragma region UTILITY
 
@@ -33,7 +64,7 @@ Laser GameServer::BatchLaser(const Game::ServerLaser& laser) const
 		laser.uuid,
 		laser.startTime,
 		laser.endTime,
-		Vec3(laser.position.x, laser.position.y, laser.position.z),
+		Vec3(laser.origin.x, laser.origin.y, laser.origin.z), //clients fast forward from the origin with startTime
 		Vec4(laser.orientation.w, laser.orientation.x, laser.orientation.y, laser.orientation.z)
 	};
 }
@@ -77,13 +108,40 @@ GameServer::~GameServer()
 
 void GameServer::StartServer(uint16_t port)
 {
+	sv_ingress_workers = Core::CVarCreate(Core::CVar_Int, "sv_ingress_workers", "0", "Hosts sharing the port (SO_REUSEPORT), each serviced by its own thread (0 = one host on the server thread)");
+	sv_zone_count = Core::CVarCreate(Core::CVar_Int, "sv_zone_count", "1", "Zone servers the world is split into along x (1 = no zoning)");
+	sv_zone_id = Core::CVarCreate(Core::CVar_Int, "sv_zone_id", "0", "Zone this server owns (0 = lowest x)");
+	sv_zone_size = Core::CVarCreate(Core::CVar_Float, "sv_zone_size", "200", "Width (units) of a zone along x, the outer zones are unbounded");
+	sv_zone_border = Core::CVarCreate(Core::CVar_Float, "sv_zone_border", "25", "Ships this close to a boundary are mirrored read only to the neighbour");
+	sv_zone_hosts = Core::CVarCreate(Core::CVar_String, "sv_zone_hosts", "", "host:port of every zone in order, comma separated (empty = consecutive ports on 127.0.0.1)");
 	InitNetwork(port);
+	InitZones(port);
 
 	live = true; //Set the server into active
-	playerMeshColliderID = Physics::LoadColliderMesh("assets/space/spaceship_physics.glb");
-
-	//generate the spawnpoints for the connected user (circular)
+	sv_dr_position_tolerance = Core::CVarCreate(Core::CVar_Float, "sv_dr_position_tolerance", "0.25", "Position error (units) before a ship update is sent");
+	sv_dr_angle_tolerance = Core::CVarCreate(Core::CVar_Float, "sv_dr_angle_tolerance", "2.0", "Orientation error (degrees) before a ship update is sent");
+	sv_dr_max_interval = Core::CVarCreate(Core::CVar_Int, "sv_dr_max_interval", "60", "Max ticks between ship updates to a receiver");
+	sv_rate_min_interval = Core::CVarCreate(Core::CVar_Int, "sv_rate_min_interval", "1", "Fewest ticks between snapshots to a receiver (1 = 60hz)");
+	sv_rate_max_interval = Core::CVarCreate(Core::CVar_Int, "sv_rate_max_interval", "6", "Most ticks between snapshots to a congested receiver (6 = 10hz)");
+	sv_rate_rtt_good = Core::CVarCreate(Core::CVar_Int, "sv_rate_rtt_good", "80", "RTT (ms) below which a receivers snapshot rate is raised");
+	sv_rate_rtt_bad = Core::CVarCreate(Core::CVar_Int, "sv_rate_rtt_bad", "200", "RTT (ms) above which a receivers snapshot rate is lowered");
+	sv_bitpack = Core::CVarCreate(Core::CVar_Int, "sv_bitpack", "1", "Offer the bit packed wire format to clients that open its channel");
+	sv_session_grace = Core::CVarCreate(Core::CVar_Int, "sv_session_grace", "10000", "Time (ms) a dropped player is kept for a reconnect");
+	sv_compression = Core::CVarCreate(Core::CVar_Int, "sv_compression", "0", "Payload compression (0 = off, 1 = ENet range coder, 2 = dictionary LZ)");
+	sv_compress_min = Core::CVarCreate(Core::CVar_Int, "sv_compress_min", "96", "Smallest payload (bytes) the dictionary codec compresses");
+	sv_capture = Core::CVarCreate(Core::CVar_String, "sv_capture", "", "File that sent payloads are captured to for dictionary training (empty = off)");
+	sv_backlog_soft = Core::CVarCreate(Core::CVar_Int, "sv_backlog_soft", "32768", "Outstanding reliable bytes above which a peer only gets essential packets");
+	sv_backlog_hard = Core::CVarCreate(Core::CVar_Int, "sv_backlog_hard", "262144", "Outstanding reliable bytes a peer may not stay above");
+	sv_spectators = Core::CVarCreate(Core::CVar_Int, "sv_spectators", "4", "Spectator relays that may subscribe at once (each takes one peer slot)");
+	sv_backlog_timeout = Core::CVarCreate(Core::CVar_Int, "sv_backlog_timeout", "3000", "Time (ms) a peer may stay above sv_backlog_hard before it is dropped");
+	sv_checkpoint = Core::CVarCreate(Core::CVar_String, "sv_checkpoint", "", "File the simulation state is checkpointed to and restored from on start (empty = off)");
+	sv_checkpoint_interval = Core::CVarCreate(Core::CVar_Int, "sv_checkpoint_interval", "5000", "Time (ms) between checkpoints");
+	ApplyCompressionSettings();
+
+	//generate the spawnpoints for the connected user (circular, around the middle of our zone when the world is split)
 	glm::vec3 center(0);
+	if (zoneCount > 1)
+		center.x = ZoneEdge(zoneID) + zoneSize * 0.5f;
 	const float radius = 50;
 	for(int i = 0; i < 32; ++i)
 	{
@@ -93,20 +151,48 @@ void GameServer::StartServer(uint16_t port)
 		spawnpoints[i].position = glm::vec3(x, 0.0f, z);
 	}
 
+	//WARM RESTART (held sessions let the clients of the previous process resume)
+	if (!LoadCheckpoint())
+		LoadAssets();
+	nextCheckpointTime = Time::Now() + uint64_t(std::max(0, Core::CVarReadInt(sv_checkpoint_interval)));
+	nextTickTime = Time::NowUs();
+
 	std::cout << "SERVER: Successful creating ENET server\n";
 
 }
 
+void GameServer::LoadAssets()
+{
+	if (assetsLoaded) return;
+	playerMeshColliderID = Physics::LoadColliderMesh("assets/space/spaceship_physics.glb");
+	assetsLoaded = true;
+}
+
 void GameServer::ShutdownServer()
 {
+	if (live)
+		SaveCheckpoint(true); //The next process starts where this one stopped
+
 	//shutdown server
+	if (Ingress::Instance().Running())
+	{
+		Ingress::Instance().Stop(); //Destroys every worker host, server is one of them
+		server = nullptr;
+	}
 	if (server != NULL)
 	{
+		net_instance.ForgetHost(server);
 		enet_host_destroy(server);
 		server = nullptr;
 	}
+	ShutdownZones();
+	NetworkManager::Compressor().StopCapture();
+	compressionApplied = false;
 
 	//Clear all the connect users (peers)
+	Loopback::Instance().Reset();
+	sessions.clear();
+	spectators.clear();
 	live = false;
 }
 
@@ -117,7 +203,10 @@ void GameServer::Run()
 	if(live && server != NULL) //As long the server exist run the server
 	{
 		s_currentTime = Time::Now();
+		ApplyCompressionSettings();
 		PollNetworkEvents();
+		PollZoneLinks();
+		PollLoopback();
 
 		// Check for collision 
 		//PLAYER VS PLAYER
@@ -171,20 +260,30 @@ void GameServer::Run()
 		}
 
 		//HANDLE DESPAWN PLAYER
-		const float respawnDelay = 3.0f; //3 seconds until respawn
+		const uint32_t respawnDelay = 3 * Tick::Rate; //3 seconds until respawn
 		for (auto id : playerToDespawn)
 		{
 			auto despawn = packet::DespawnPlayerS2C(id);
-			net_instance.Broadcast(server, despawn);
-			pendingRespawns.push_back({ id,respawnDelay });
+			net_instance.Broadcast(server, despawn, PacketPriority_Normal, PacketStream_Ships);
+			pendingRespawns.push_back({ id, serverTick + respawnDelay });
 			players.erase(id);
-			playerColliders.erase(id);
+			DestroyCollider(id);
+			for (auto& [peer, baselines] : replicationBaselines)
+				baselines.erase(id);
+		}
+
+		//LASERS HANDED OFF WITH THEIR SHIP (the neighbour simulates them, our receivers still see them fly)
+		for (auto it = ghostLasers.begin(); it != ghostLasers.end();)
+		{
+			if (!Tick::Reached(serverTick, it->second)) { it++; continue; }
+			net_instance.Broadcast(server, packet::DespawnLaserS2C(it->first));
+			it = ghostLasers.erase(it);
 		}
 
 		//UPDATE LASER PHYSICS
 		for(auto& laser : lasers)
 		{
-			if (laser.second.isExpired(s_currentTime))
+			if (laser.second.isExpired(serverTick))
 			{
 				auto despawn = packet::DespawnLaserS2C(laser.first);
 				net_instance.Broadcast(server, despawn);
@@ -213,10 +312,14 @@ void GameServer::Run()
 			if (playerToDespawn.contains(uuid))
 				continue; // Skip updating ships that are about to despawn
 
-			ship.Update(0.01667f); //fixed 60 frames
+			ship.Update(SHIP_FIXED_DT); //fixed 60 frames
 			Physics::SetTransform(playerColliders[uuid], ship.transform);
 		}
 
+		//GHOSTS COAST ON THEIR LAST VELOCITY BETWEEN ZONE UPDATES (never simulated or collided here)
+		for (auto& [uuid, ghost] : ghosts)
+			ghost.position += ghost.linearVelocity * SHIP_FIXED_DT;
+
 
 		//RESET THE LIST 
 		playerToDespawn.clear();
@@ -224,11 +327,9 @@ void GameServer::Run()
 		laserToDespawn.clear();
 
 		//HANDLE THE RESPAWNS
-		float deltaTime = 0.01667f; //Follows the same flow as server fixed timestep 60fps
 		for(auto it = pendingRespawns.begin(); it != pendingRespawns.end();)
 		{
-			it->respawnTimer -= deltaTime;
-			if (it->respawnTimer <= 0.0f)
+			if (Tick::Reached(serverTick, it->respawnTick))
 			{
 				std::cout << "RESPAWNING PLAYER WITH ID " << it->playerID << "\n";
 				SpawnPlayer(it->playerID); //respawn the player by sending the spawnPackage back to that user
@@ -238,21 +339,39 @@ void GameServer::Run()
 				it++;
 		}
 
-		serverTickCounter++;
+		serverTick++;
+
+		//DROPPED PLAYERS WHOSE GRACE PERIOD RAN OUT
+		ExpireSessions();
 
-		//NETWORK STATE SYNC (Every Nth frame) 
-		if(serverTickCounter % 5 == 0) //every 5 frame of 60 fps (12 times / s)
+		//CHECKPOINT (built here, written by a background thread)
+		if (s_currentTime >= nextCheckpointTime)
 		{
-			//UPDATE PLAYERS
-			for(const auto& player : players)
-			{
-				auto packPlayer = BatchShip(player.second);
-				const auto fbb = packet::UpdatePlayerS2C(s_currentTime, &packPlayer);
-				net_instance.Broadcast(server, fbb);
-			}
+			SaveCheckpoint(false);
+			nextCheckpointTime = s_currentTime + uint64_t(std::max(1, Core::CVarReadInt(sv_checkpoint_interval)));
 		}
 
-		while(Time::Now() - s_currentTime < 16) { /*WAIT*/ }
+		//ZONES (ships past a boundary change server, border ships are mirrored to the neighbours)
+		ExpireArrivals();
+		HandoffShips();
+		SendGhosts();
+
+		//BACKPRESSURE (peers that do not keep up get less, peers that stay backed up are dropped)
+		MonitorBacklogs();
+
+		//JOIN IN PROGRESS (a bounded amount of chunks per tick)
+		StreamJoinState();
+
+		//NETWORK STATE SYNC (only when the receivers extrapolation is off, at each receivers own rate)
+		AdaptSnapshotRates();
+		ReplicateShips();
+
+		//FIXED CADENCE ON THE MONOTONIC CLOCK (tick numbers are the protocol time, they have to keep up with Tick::Rate)
+		nextTickTime += Tick::Us;
+		const uint64_t now = Time::NowUs();
+		if (now > nextTickTime + Tick::Us * 15)
+			nextTickTime = now; //Stalled (a quarter second behind), skip ahead instead of bursting through the backlog
+		while(Time::NowUs() < nextTickTime) { /*WAIT*/ }
 	}
 }
 
@@ -265,6 +384,14 @@ void GameServer::InitNetwork(uint16_t port)
 	address.host = ENET_HOST_ANY;
 	address.port = port;
 
+	//Ingress workers, server is then the first of their hosts (only used as a handle for broadcasts / compression, never serviced here)
+	const int workers = std::max(0, Core::CVarReadInt(sv_ingress_workers));
+	if (workers > 0 && Ingress::Instance().Start(port, workers, 32, 2))
+	{
+		server = Ingress::Instance().PrimaryHost();
+		return;
+	}
+
 	server = enet_host_create(&address, 32, 2, 0, 0);
 	if (server == NULL)
 	{
@@ -275,6 +402,12 @@ void GameServer::InitNetwork(uint16_t port)
 
 void GameServer::PollNetworkEvents()
 {
+	if (Ingress::Instance().Running())
+	{
+		PollIngress();
+		return;
+	}
+
 	ENetEvent event;
 	while (enet_host_service(server, &event, 0) > 0) //Pool
 	{
@@ -282,27 +415,112 @@ void GameServer::PollNetworkEvents()
 		{
 			case ENET_EVENT_TYPE_CONNECT: {
 				//std::cout << "SERVER:TYPE CONNECT WAS GENERATED\n";
-				OnClientConnect(event.peer);
+				OnClientConnect(event.peer, event.data); //connect data carries the session token of a reconnecting client
 				break;
 			}
 
 			case ENET_EVENT_TYPE_RECEIVE: {
 				//std::cout << "SERVER: RECIEVED INCOMING PACKET FROM CLIENT WITH ID: " << event.peer->incomingPeerID << "\n";
-				OnPacketRecieved(event.peer->incomingPeerID, event.packet);
+				if (event.channelID == BitPack::Channel)
+					OnBitPackedRecieved(event.peer, event.packet->data, event.packet->dataLength);
+				else
+					OnPacketRecieved(event.peer, event.packet->data);
+				enet_packet_destroy(event.packet);
 				break;
 			}
 
 			case ENET_EVENT_TYPE_DISCONNECT: {
 				//std::cout << "SERVER: RECIEVED DISCONNECT PACKET FROM CLIENT WITH ID: " << event.peer->incomingPeerID << "\n";
-				OnClientDisconnect(event.peer->incomingPeerID);
+				//Timeouts carry no data, a client leaving on purpose sends its id
+				OnClientDisconnect(event.peer, event.data != 0);
 				break;
 			}
 		}
 	}
 }
 
-void GameServer::OnClientConnect(ENetPeer* peer)
+void GameServer::PollIngress()
 {
+	//Same dispatch as PollNetworkEvents, the workers already took the packets out of ENet
+	ingressEvents.clear();
+	Ingress::Instance().Drain(ingressEvents);
+	for (IngressEvent& event : ingressEvents)
+	{
+		switch (event.type)
+		{
+			case ENET_EVENT_TYPE_CONNECT:
+				OnClientConnect(event.peer, event.data);
+				break;
+
+			case ENET_EVENT_TYPE_RECEIVE:
+				if (event.channelID == BitPack::Channel)
+					OnBitPackedRecieved(event.peer, event.payload.data(), event.payload.size());
+				else
+					OnPacketRecieved(event.peer, event.payload.data());
+				break;
+
+			case ENET_EVENT_TYPE_DISCONNECT:
+				OnClientDisconnect(event.peer, event.data != 0);
+				break;
+
+			default:
+				break;
+		}
+	}
+}
+
+void GameServer::PollLoopback()
+{
+	Loopback& loopback = Loopback::Instance();
+	if (loopback.ConsumeConnect())
+		OnClientConnect(loopback.Peer());
+
+	while (loopback.toServer.Pop(loopbackBuffer))
+		OnPacketRecieved(loopback.Peer(), loopbackBuffer.data());
+
+	if (loopback.ConsumeDisconnect())
+		OnClientDisconnect(loopback.Peer(), true);
+
+	loopback.toClient.Flush();
+}
+
+void GameServer::OnClientConnect(ENetPeer* peer, uint32_t sessionToken)
+{
+	if (sessionToken == SpectatorConnectData)
+	{
+		OnSpectatorConnect(peer);
+		return;
+	}
+	if ((sessionToken & ZoneConnectMask) == ZoneConnectData)
+	{
+		OnZoneLinkConnect(peer, int(sessionToken & ~ZoneConnectMask));
+		return;
+	}
+
+	//RESUME (the player is still held, nothing is respawned or restreamed until the client tells us what it kept)
+	const auto held = sessions.find(sessionToken);
+	if (sessionToken != 0 && held != sessions.end() && held->second.peer == nullptr)
+	{
+		Session& session = held->second;
+		session.peer = peer;
+		connections[peer] = session.playerID;
+		snapshotRates[peer] = SnapshotRate{ 5, serverTick, serverTick };
+		wireFormats[peer] = NegotiateWireFormat(peer);
+		net_instance.SetPeerBitPacked(peer, wireFormats[peer] == BitPack::WireFormat_BitPacked);
+
+		auto fbb = packet::ClienConnectsS2C(session.playerID, serverTick, sessionToken, wireFormats[peer]);
+		net_instance.SendToClient(peer, fbb, PacketStream_Ships); //Ahead of every update, they are read against its tick
+		std::cout << "SERVER: Client " << session.playerID << " resumed its session\n";
+		return;
+	}
+
+	//Redirected by a neighbouring zone, its handoff can still be on the way
+	if (zoneCount > 1 && sessionToken != 0 && !sessions.contains(sessionToken))
+	{
+		arrivals[sessionToken] = ZoneArrival{ peer, s_currentTime + 1000 };
+		return;
+	}
+
 	/*
 	*  incomingPeerID
 		Purpose: Represents the ID assigned to the remote peer (i.e., the ID that the local host assigned to this connection).
@@ -311,52 +529,194 @@ void GameServer::OnClientConnect(ENetPeer* peer)
 		has drawback for soley using incomingPeerID, use self assinged ID When client successful render out the peer
 	*/
 	
-	//uint32_t uuid = nextClientID++; //assign the user with this GameServer unique identifier
-	connections[peer] = peer->incomingPeerID; //insert the new element into the list
-
-	auto fbb = packet::ClienConnectsS2C(peer->incomingPeerID, s_currentTime);
-	net_instance.SendToClient(peer, fbb); //Send the packet to the connected peer
+	//Own ids, a held player keeps its id while its peer slot is reused by someone else
+	const uint32_t uuid = nextClientID++; //assign the user with this GameServer unique identifier
+	connections[peer] = uuid; //insert the new element into the list
+	snapshotRates[peer] = SnapshotRate{ 5, serverTick, serverTick }; //Start at the old fixed 12hz and adapt from there
+
+	//Non zero and unused (zero means "no session" in the connect data)
+	uint32_t token = 0;
+	while (token == 0 || token == SpectatorConnectData || (token & ZoneConnectMask) == ZoneConnectData || sessions.contains(token))
+		token = uint32_t(tokenGenerator());
+	sessions[token] = Session{ uuid, peer, 0 };
+	wireFormats[peer] = NegotiateWireFormat(peer);
+	net_instance.SetPeerBitPacked(peer, wireFormats[peer] == BitPack::WireFormat_BitPacked);
+
+	auto fbb = packet::ClienConnectsS2C(uuid, serverTick, token, wireFormats[peer]);
+	net_instance.SendToClient(peer, fbb, PacketStream_Ships); //Send the packet to the connected peer, ahead of every ship update
 
 	//Change in game state (apply the change of new player joined) 
 
 	//GAME STATE CONFIG (APPLY THE NECESSITY FOR THE ADDING THE NEW PLAYER TO THE STATE)
-	std::vector<Player> playerVec;
-	playerVec.reserve(players.size());
+	//Only the ids are recorded here, the entities are packed into MTU sized GameStateS2C chunks
+	//by StreamJoinState over the following ticks so a late joiner never produces one big fragmented packet
+	JoinStream& stream = joinStreams[peer];
+	stream.pendingPlayers.clear();
+	stream.pendingLasers.clear();
+	stream.pendingPlayers.reserve(players.size());
+	stream.pendingLasers.reserve(lasers.size());
+	for (const auto& [id, ship] : players)
+		stream.pendingPlayers.push_back(id);
+	for (const auto& [id, ship] : ghosts)
+		stream.pendingPlayers.push_back(id);
+	for (const auto& [id, laser] : lasers)
+		stream.pendingLasers.push_back(id);
+
+	std::cout << "SERVER: Streaming " << stream.pendingPlayers.size() << " players and "
+		<< stream.pendingLasers.size() << " lasers to joining client\n";
+
+	SpawnPlayer(uuid);
+
+	//std::cout << "SERVER: Client " << uuid << " connected.\n";
+	//std::cout << "SERVER SPACESHIP COUNT " << players.size() << "\n";
+	//std::cout << "SERVER: Connected USER COUNT " << connections.size() << "\n";
+}
+
+void GameServer::OnSpectatorConnect(ENetPeer* peer)
+{
+	if (spectators.size() >= size_t(std::max(0, Core::CVarReadInt(sv_spectators))))
+	{
+		std::cout << "SERVER: Refused spectator relay, sv_spectators reached\n";
+		net_instance.DisconnectNow(peer);
+		return;
+	}
+
+	//A receiver without a ship: same join stream, dead reckoned updates and broadcasts as a player, nothing it sends is applied
+	spectators.insert(peer);
+	snapshotRates[peer] = SnapshotRate{ 5, serverTick, serverTick };
+	wireFormats[peer] = BitPack::WireFormat_FlatBuffers; //Relays forward the payloads as they are
+	auto fbb = packet::ClienConnectsS2C(0, serverTick);
+	net_instance.SendToClient(peer, fbb);
+
+	JoinStream& stream = joinStreams[peer];
+	stream.pendingPlayers.clear();
+	stream.pendingLasers.clear();
+	for (const auto& [id, ship] : players)
+		stream.pendingPlayers.push_back(id);
+	for (const auto& [id, ship] : ghosts)
+		stream.pendingPlayers.push_back(id);
+	for (const auto& [id, laser] : lasers)
+		stream.pendingLasers.push_back(id);
+
+	std::cout << "SERVER: Spectator relay subscribed (" << spectators.size() << " relays)\n";
+}
+
+void GameServer::ForgetReceiver(ENetPeer* peer)
+{
+	joinStreams.erase(peer);
+	replicationBaselines.erase(peer);
+	snapshotRates.erase(peer);
+	wireFormats.erase(peer);
+	inputAcks.erase(peer);
+	backlogs.erase(peer);
+	net_instance.ForgetPeer(peer);
+}
+
+std::string GameServer::PeerLabel(ENetPeer* peer) const
+{
+	const auto connection = connections.find(peer);
+	if (connection != connections.end())
+		return "client " + std::to_string(connection->second);
+	return spectators.contains(peer) ? "spectator relay" : "unknown peer";
+}
 
-	//Reserve the all existing players so the new player get the data of the already connected peers
-	//Below should function the same as BatchShip
-	std::transform(players.begin(), players.end(), std::back_inserter(playerVec),
-		[](const std::pair<const uint32_t, Game::ServerSpaceship>& entry)
+void GameServer::ApplyCompressionSettings()
+{
+	//First call (StartServer) applies everything, after that only what changed in the console
+	const bool first = !compressionApplied;
+	compressionApplied = true;
+
+	if (first || Core::CVarModified(sv_compression))
+	{
+		const int mode = std::clamp(Core::CVarReadInt(sv_compression), int(CompressionMode_Off), int(CompressionMode_Dictionary));
+		net_instance.SetCompression(server, CompressionMode(mode));
+		Core::CVarSetModified(sv_compression, false);
+	}
+	if (first || Core::CVarModified(sv_compress_min))
+	{
+		NetworkManager::Compressor().threshold = size_t(std::max(0, Core::CVarReadInt(sv_compress_min)));
+		Core::CVarSetModified(sv_compress_min, false);
+	}
+	if (first || Core::CVarModified(sv_capture))
+	{
+		const char* path = Core::CVarReadString(sv_capture);
+		if (path != nullptr && path[0] != '\0')
+			NetworkManager::Compressor().StartCapture(path);
+		else
+			NetworkManager::Compressor().StopCapture();
+		Core::CVarSetModified(sv_capture, false);
+	}
+}
+
+BitPack::WireFormat GameServer::NegotiateWireFormat(ENetPeer* peer) const
+{
+	//Clients offer the bit packed format by opening its channel (the loopback peer has no channels)
+	if (Core::CVarReadInt(sv_bitpack) != 0 && net_instance.Stats(peer, 0).channelCount > BitPack::Channel)
+		return BitPack::WireFormat_BitPacked;
+	return BitPack::WireFormat_FlatBuffers;
+}
+
+size_t GameServer::JoinChunkCapacity(ENetPeer* peer) const
+{
+	//ENet command headers plus the PacketWrapper / GameStateS2C tables and vector prefixes
+	const size_t overhead = sizeof(ENetProtocolHeader) + sizeof(ENetProtocolSendReliable) + 64;
+	const size_t peerMtu = net_instance.Stats(peer, 0).mtu;
+	const size_t mtu = peerMtu > overhead ? peerMtu : size_t(ENET_PROTOCOL_MINIMUM_MTU);
+	const size_t entrySize = std::max(sizeof(Player), sizeof(Laser));
+	return std::max<size_t>(1, (mtu - overhead) / entrySize);
+}
+
+void GameServer::StreamJoinState()
+{
+	int chunksLeft = joinChunksPerTick;
+	for (auto it = joinStreams.begin(); it != joinStreams.end() && chunksLeft > 0;)
+	{
+		ENetPeer* peer = it->first;
+		JoinStream& stream = it->second;
+		if (IsCongested(peer))
 		{
-			//Pack our custom server side spaceship into a protocol player
-			auto& ship = entry.second;
-			const glm::vec3& pos = ship.position;
-			const glm::vec3& vel = ship.linearVelocity;
-			const glm::quat& orient = ship.orientation;
-
-			Vec3 posVec = Vec3(pos.x, pos.y, pos.z);
-			Vec3 velVec = Vec3(vel.x, vel.y, vel.z);
-			Vec3 accelVec = Vec3(); // acceleration of the ship
-			Vec4 OrientVec = Vec4(orient.w,orient.x, orient.y, orient.z);
-
-			return Player(ship.id, posVec, velVec, accelVec, OrientVec);
+			it++; //Resumes once the peer caught up, the world is read fresh for every chunk anyway
+			continue;
 		}
-	);
-	
-	std::cout << "PlayerVec count " << playerVec.size() << "\n";
-	std::vector<Laser> laserVec;
-	laserVec.reserve(lasers.size()); //We let it be zero (laser functionality and properties yet implemented)
-	//Do the same for lasers (pack the existing in lasers in the game)
+		size_t capacity = JoinChunkCapacity(peer);
 
-	fbb.Clear();
-	fbb = packet::GameStateS2C(playerVec, laserVec);
-	net_instance.SendToClient(peer, fbb); //Send back to connected user about the current game state 
+		//Entities removed since the join started are skipped (their despawn already went out as a broadcast)
+		std::vector<Player> playerVec;
+		while (!stream.pendingPlayers.empty() && playerVec.size() < capacity)
+		{
+			const uint32_t id = stream.pendingPlayers.back();
+			stream.pendingPlayers.pop_back();
+			const Game::ServerSpaceship* ship = FindShip(id);
+			if (ship != nullptr)
+				playerVec.push_back(BatchShip(*ship));
+		}
+		capacity -= playerVec.size();
 
-	SpawnPlayer(peer->incomingPeerID);
+		std::vector<Laser> laserVec;
+		while (!stream.pendingLasers.empty() && laserVec.size() < capacity)
+		{
+			const uint32_t id = stream.pendingLasers.back();
+			stream.pendingLasers.pop_back();
+			const auto laser = lasers.find(id);
+			if (laser != lasers.end())
+				laserVec.push_back(BatchLaser(laser->second));
+		}
 
-	//std::cout << "SERVER: Client " << peer->incomingPeerID << " connected.\n";
-	//std::cout << "SERVER SPACESHIP COUNT " << players.size() << "\n";
-	//std::cout << "SERVER: Connected USER COUNT " << connections.size() << "\n";
+		for (const Player& player : playerVec)
+			SetBaseline(peer, *FindShip(player.uuid()));
+
+		if (!playerVec.empty() || !laserVec.empty())
+		{
+			const auto fbb = packet::GameStateS2C(playerVec, laserVec);
+			net_instance.SendToClient(peer, fbb, PacketStream_Ships); //The baselines set above
+			chunksLeft--;
+		}
+
+		if (stream.pendingPlayers.empty() && stream.pendingLasers.empty())
+			it = joinStreams.erase(it);
+		else
+			it++;
+	}
 }
 
 void GameServer::SpawnPlayer(uint32_t clientID)
@@ -408,9 +768,215 @@ void GameServer::SpawnPlayer(uint32_t clientID)
 		Physics::SetTransform(playerColliders[clientID], ship.transform);
 
 	//SEND THE BROADCAST PACKAGE TO ALL CLIENT ABOUT A NEW USER CONNECTED
+	AnnounceShip(ship);
+}
+
+void GameServer::AnnounceShip(const Game::ServerSpaceship& ship)
+{
 	auto playerData = BatchShip(ship);
 	auto fbb = packet::SpawnPlayerS2C(&playerData);
-	net_instance.Broadcast(server, fbb);
+	net_instance.Broadcast(server, fbb, PacketPriority_Normal, PacketStream_Ships); //Bit packed updates build on it, they must not overtake it
+	for (const auto& [peer, id] : connections)
+		SetBaseline(peer, ship);
+	for (ENetPeer* peer : spectators)
+		SetBaseline(peer, ship);
+}
+
+void GameServer::SetBaseline(ENetPeer* peer, const Game::ServerSpaceship& ship)
+{
+	ReplicatedShip& base = replicationBaselines[peer][ship.id];
+	base.state.intervalMs = 0; //Spawns carry no interval, the first update does
+	base.state.position = ship.position;
+	base.state.velocity = ship.linearVelocity;
+	base.state.orientation = ship.orientation;
+	base.sentTick = serverTick;
+	base.keyframe = false;
+}
+
+void GameServer::ReplicateShips()
+{
+	const float positionTolerance = Core::CVarReadFloat(sv_dr_position_tolerance);
+	const float angleTolerance = glm::radians(Core::CVarReadFloat(sv_dr_angle_tolerance));
+	const int maxInterval = Core::CVarReadInt(sv_dr_max_interval);
+
+	//Packed at most once per tick and interval, shared by every receiver that needs the ship
+	std::unordered_map<uint64_t, FlatBufferBuilder> updates;
+	std::unordered_map<uint64_t, BitPack::BitWriter> bitPackedUpdates;
+	BitPack::BitWriter ackedUpdate; //The owners own update with its input ack, never shared
+
+	for (auto& [peer, baselines] : replicationBaselines)
+	{
+		SnapshotRate& rate = snapshotRates[peer];
+		const bool bitPacked = wireFormats[peer] == BitPack::WireFormat_BitPacked;
+		if (Tick::Diff(serverTick, rate.lastSentTick) < rate.interval) continue; //Not this receivers turn
+		if (IsCongested(peer)) continue; //Baselines stay old, the first pass after it caught up sends the latest state only
+		rate.lastSentTick = serverTick;
+		const uint16_t intervalMs = uint16_t(rate.interval * Tick::Ms + 0.5);
+
+		//The last applied input is echoed in the receivers own ship update, that one goes out this pass even without a DR error
+		const auto connection = connections.find(peer);
+		const auto pendingAck = inputAcks.find(peer);
+		InputAck* ack = connection != connections.end() && pendingAck != inputAcks.end() && pendingAck->second.pending ? &pendingAck->second : nullptr;
+		const uint16_t ackDelay = ack != nullptr ? uint16_t(std::min<uint64_t>((Time::NowUs() - ack->receivedUs) / 100, 0xFFFF)) : 0;
+
+		for (auto& [id, base] : baselines)
+		{
+			const Game::ServerSpaceship* found = FindShip(id); //Ghosts of the neighbouring zones are replicated like our own ships
+			if (found == nullptr) continue;
+			const Game::ServerSpaceship& ship = *found;
+			const bool acking = ack != nullptr && id == connection->second;
+
+			//Run the receivers extrapolation and compare it against the authoritative state
+			const float elapsed = float(Tick::Diff(serverTick, base.sentTick)) * Tick::Seconds;
+			const glm::vec3 predicted = base.state.position + base.state.velocity * elapsed;
+			const float positionError = glm::length(ship.position - predicted);
+			const float cosHalfAngle = std::min(1.0f, std::abs(glm::dot(base.state.orientation, ship.orientation)));
+			const float angleError = 2.0f * std::acos(cosHalfAngle);
+
+			const bool refresh = Tick::Diff(serverTick, base.sentTick) >= maxInterval;
+			if (!acking && positionError <= positionTolerance && angleError <= angleTolerance && !refresh)
+				continue;
+
+			Replication::ShipUpdateS2C message;
+			message.tick = serverTick;
+			message.uuid = id;
+			message.state.intervalMs = intervalMs;
+			message.state.position = ship.position;
+			message.state.velocity = ship.linearVelocity;
+			message.state.orientation = ship.orientation;
+			if (bitPacked && !message.Fits() && unpackedShips.insert(id).second)
+				std::cout << "SERVER: Ship " << id << " is outside the bit packed update ranges, sending it as FlatBuffers\n";
+			if (bitPacked && message.Fits()) //Otherwise a full FlatBuffers update below
+			{
+				//Only what this receiver would see changed, receivers with the same dirty fields share the message
+				//The max interval send carries every field, whatever the receiver holds is corrected within sv_dr_max_interval
+				message.dirty = base.keyframe || refresh ? Replication::ShipSchema::all : Replication::ShipSchema::Dirty(message.state, base.state);
+				if (acking)
+				{
+					message.ackSeq = ack->seq;
+					message.ackDelay = ackDelay;
+					ackedUpdate.Clear();
+					message.Write(ackedUpdate);
+					net_instance.SendToClient(peer, ackedUpdate);
+				}
+				else
+				{
+					const uint64_t packedKey = (uint64_t(id) << 32) | (uint64_t(intervalMs) << 16) | message.dirty;
+					auto packed = bitPackedUpdates.find(packedKey);
+					if (packed == bitPackedUpdates.end())
+					{
+						packed = bitPackedUpdates.emplace(packedKey, BitPack::BitWriter()).first;
+						message.Write(packed->second);
+					}
+					net_instance.SendToClient(peer, packed->second);
+				}
+				Replication::ShipSchema::Copy(base.state, message.state, message.dirty);
+				base.sentTick = serverTick;
+				base.keyframe = false;
+				continue;
+			}
+
+			if (acking)
+			{
+				auto packPlayer = BatchShip(ship);
+				net_instance.SendToClient(peer, packet::UpdatePlayerS2C(serverTick, &packPlayer, intervalMs, ack->seq, ackDelay), PacketStream_Ships);
+			}
+			else
+			{
+				const uint64_t key = (uint64_t(id) << 16) | intervalMs;
+				auto update = updates.find(key);
+				if (update == updates.end())
+				{
+					auto packPlayer = BatchShip(ship);
+					update = updates.emplace(key, packet::UpdatePlayerS2C(serverTick, &packPlayer, intervalMs)).first;
+				}
+				net_instance.SendToClient(peer, update->second, PacketStream_Ships); //A full state, later bit packed updates build on it
+			}
+			base.state = message.state;
+			base.sentTick = serverTick;
+			base.keyframe = false;
+		}
+		if (ack != nullptr)
+			ack->pending = false; //Sent, or our ship is gone (an ack held until the respawn would only measure the respawn time)
+	}
+}
+
+void GameServer::MonitorBacklogs()
+{
+	const size_t soft = size_t(std::max(0, Core::CVarReadInt(sv_backlog_soft)));
+	const size_t hard = std::max(soft, size_t(std::max(0, Core::CVarReadInt(sv_backlog_hard))));
+	const uint64_t timeout = uint64_t(std::max(0, Core::CVarReadInt(sv_backlog_timeout)));
+
+	std::vector<ENetPeer*> overloaded;
+	for (const auto& [peer, rate] : snapshotRates) //Every receiver, players and spectator relays
+	{
+		if (peer == Loopback::Instance().Peer()) continue; //In process, nothing queues up in ENet
+
+		PeerBacklog& backlog = backlogs[peer];
+		backlog.bytes = net_instance.Stats(peer, hard).outstandingBytes;
+
+		//Congested above soft, clears below half of it so a peer on the edge does not flip every tick
+		const bool congested = backlog.bytes > soft || (backlog.congested && backlog.bytes > soft / 2);
+		if (congested != backlog.congested)
+		{
+			std::cout << "SERVER: " << PeerLabel(peer) << (congested ? " is backed up (" : " caught up (") << backlog.bytes << " bytes outstanding)\n";
+			backlog.congested = congested;
+			net_instance.SetPeerCongested(peer, congested);
+		}
+
+		if (backlog.bytes <= hard)
+			backlog.overHardSince = 0;
+		else if (backlog.overHardSince == 0)
+			backlog.overHardSince = s_currentTime;
+		else if (s_currentTime - backlog.overHardSince >= timeout)
+			overloaded.push_back(peer);
+	}
+
+	for (ENetPeer* peer : overloaded)
+	{
+		//Frees the queue right away, the session is held so the client can resume on a fresh connection
+		std::cout << "SERVER: " << PeerLabel(peer) << " stayed above " << hard << " outstanding bytes, dropping it\n";
+		net_instance.DisconnectNow(peer);
+		OnClientDisconnect(peer, false);
+	}
+}
+
+void GameServer::AdaptSnapshotRates()
+{
+	const int adaptPeriod = 30; //Reevaluate twice a second, ENet's RTT / throttle averages move slower than that anyway
+	const int minInterval = std::max(1, Core::CVarReadInt(sv_rate_min_interval));
+	const int maxInterval = std::max(minInterval, Core::CVarReadInt(sv_rate_max_interval));
+	const enet_uint32 rttGood = enet_uint32(Core::CVarReadInt(sv_rate_rtt_good));
+	const enet_uint32 rttBad = enet_uint32(Core::CVarReadInt(sv_rate_rtt_bad));
+
+	for (auto& [peer, rate] : snapshotRates)
+	{
+		if (Tick::Diff(serverTick, rate.lastAdaptTick) < adaptPeriod) continue;
+		rate.lastAdaptTick = serverTick;
+
+		//ENet lowers packetThrottle when RTT rises above its running mean and counts reliable loss
+		const PeerStats link = net_instance.Stats(peer, 0);
+		const bool throttled = link.packetThrottle < ENET_PEER_PACKET_THROTTLE_SCALE * 3 / 4;
+		const bool lossy = link.packetLoss > ENET_PEER_PACKET_LOSS_SCALE / 20; //5%
+		const bool congested = throttled || lossy || link.roundTripTime > rttBad;
+		const bool headroom = link.packetThrottle >= ENET_PEER_PACKET_THROTTLE_SCALE &&
+			link.packetLoss == 0 && link.roundTripTime < rttGood;
+
+		//Back off fast, speed up slowly (AIMD)
+		int interval = rate.interval;
+		if (congested)
+			interval = std::min(maxInterval, interval * 2);
+		else if (headroom)
+			interval = std::max(minInterval, interval - 1);
+		interval = std::clamp(interval, minInterval, maxInterval);
+
+		if (interval != rate.interval)
+		{
+			std::cout << "SERVER: Snapshot rate for " << PeerLabel(peer) << " is now "
+				<< int(60 / interval) << "hz (rtt " << link.roundTripTime << "ms)\n";
+			rate.interval = interval;
+		}
+	}
 }
 
 bool GameServer::CheckCollision(Game::ServerSpaceship& shipA, Game::ServerSpaceship& shipB)
@@ -430,51 +996,50 @@ bool GameServer::CheckCollision(Game::ServerSpaceship& shipA, Game::ServerSpaces
 	return collided;
 }
 
-void GameServer::OnPacketRecieved(uint32_t senderID, const ENetPacket* packet)
+void GameServer::OnPacketRecieved(ENetPeer* peer, const uint8_t* data)
 {
 	//if (packet == NULL) return; //NO PACKET
-	auto wrapper = GetPacketWrapper(packet->data);
+	const int linkZone = ZoneOfLink(peer);
+	if (linkZone >= 0)
+	{
+		OnZonePacket(linkZone, data);
+		return;
+	}
+	if (spectators.contains(peer))
+	{
+		//Relays only report their dictionary
+		auto wrapper = GetPacketWrapper(data);
+		if (wrapper->packet_type() == PacketType_ClientHelloC2S && wrapper->packet_as_ClientHelloC2S())
+			net_instance.SetPeerDictionary(peer, wrapper->packet_as_ClientHelloC2S()->dictionary_id());
+		return;
+	}
+	const auto connection = connections.find(peer);
+	if (connection == connections.end()) return; //Sender already disconnected
+	const uint32_t senderID = connection->second;
+
+	auto wrapper = GetPacketWrapper(data);
 	switch(wrapper->packet_type())
 	{
 		case PacketType_InputC2S:{
 			//std::cout << "SERVER: RECIEVES A INPUT REQUEST FROM CLIENT\n";
 			auto inputData = wrapper->packet_as_InputC2S();
 			if (!inputData) return;
-			auto& player = players[senderID]; //maybe need to navigate through the connections to find
-			//apply the input (valid data)
-			if (inputData->time() < player.lastInputTimeStamp) return;
-			player.lastInputBitmap = inputData->bitmap();
-			player.lastInputTimeStamp = inputData->time();
-			player.inputCooldown = 0;
-			//RECIEVES A INPUT EVENT
-	/*		std::cout << "Player input bitmap " << player.lastInputBitmap << "\n";
-			std::cout << "Player input timestamp " << player.lastInputTimeStamp << "\n";*/
-
-			if (inputData->bitmap() & (1 << 7)) //SPACE input
-			{
-				//Spawn laser forward from this ship
-				Game::ServerLaser laser;
-				// Get forward direction
-				glm::vec3 forward = player.orientation * glm::vec3(0.0f, 0.0f, 1.0f);
-
-				laser.uuid = laserUUIDCounter++;
-				laser.ownerID = player.id;
-				laser.position = player.position + forward * 2.0f;
-				laser.orientation = player.orientation;
-				//laser.velocity = forward * glm::vec3(0.0f, 0.0f, 20.0f); //20 units / s speed
-
-				laser.startTime = inputData->time();
-				laser.endTime = inputData->time() + 2500; // 2.5s before disapear
-				laser.transform = glm::translate(laser.position) * glm::mat4_cast(laser.orientation) * glm::scale(glm::vec3(1.0f));
-
-				lasers[laser.uuid] = laser; //add it to the server laser list
-				
-				//Send the spawnlaser package to all client
-				auto laserData = BatchLaser(laser);
-				auto fbb = packet::SpawnLaserS2C(&laserData);
-				net_instance.Broadcast(server, fbb);
-			}
-
+			if (ApplyInput(senderID, inputData->time(), inputData->bitmap(), inputData->shot_seq()))
+				AckInput(peer, inputData->input_seq());
+			break;
+		}
+		case PacketType_ResumeC2S:
+		{
+			auto resume = wrapper->packet_as_ResumeC2S();
+			if (!resume) return;
+			ResumeSession(peer, *resume);
+			break;
+		}
+		case PacketType_ClientHelloC2S:
+		{
+			auto hello = wrapper->packet_as_ClientHelloC2S();
+			if (!hello) return;
+			net_instance.SetPeerDictionary(peer, hello->dictionary_id());
 			break;
 		}
 		case PacketType_TextS2C:
@@ -485,13 +1050,913 @@ void GameServer::OnPacketRecieved(uint32_t senderID, const ENetPacket* packet)
 	
 }
 
-void GameServer::OnClientDisconnect(uint32_t clientID) {
+void GameServer::OnBitPackedRecieved(ENetPeer* peer, const uint8_t* data, size_t size)
+{
+	const auto connection = connections.find(peer);
+	if (connection == connections.end()) return;
+	const uint32_t senderID = connection->second;
+
+	BitPack::BitReader reader(data, size);
+	switch (BitPack::Type::Read(reader))
+	{
+		case BitPack::MessageType_InputC2S:
+		{
+			//Client tick is rebuilt next to the last input we applied (or our own tick for the first one)
+			const auto found = players.find(senderID);
+			const uint32_t reference = found != players.end() && found->second.lastInputTimeStamp != 0 ? found->second.lastInputTimeStamp : serverTick;
+			BitPack::InputC2S input;
+			if (!input.Read(reader, reference)) return; //Truncated
+			if (ApplyInput(senderID, input.tick, input.bitmap, input.shotSeq))
+				AckInput(peer, input.seq);
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+void GameServer::AckInput(ENetPeer* peer, uint16_t inputSeq)
+{
+	if (inputSeq == 0) return; //Sender does not measure latency
+	InputAck& ack = inputAcks[peer];
+	ack.seq = inputSeq;
+	ack.receivedUs = Time::NowUs();
+	ack.pending = true;
+}
+
+bool GameServer::ApplyInput(uint32_t senderID, uint32_t tick, uint16_t bitmap, uint32_t shotSeq)
+{
+	const auto found = players.find(senderID);
+	if (found == players.end()) return false; //Dead (waiting for respawn), a predicted laser on the client just expires
+	auto& player = found->second;
+	//apply the input (valid data)
+	if (player.lastInputTimeStamp != 0 && Tick::Diff(tick, player.lastInputTimeStamp) < 0) return false;
+	player.lastInputBitmap = bitmap;
+	player.lastInputTimeStamp = tick;
+	player.inputCooldown = 0;
+	//RECIEVES A INPUT EVENT
+/*	std::cout << "Player input bitmap " << player.lastInputBitmap << "\n";
+	std::cout << "Player input timestamp " << player.lastInputTimeStamp << "\n";*/
+
+	if (bitmap & (1 << 7)) //SPACE input
+	{
+		//Spawn laser forward from this ship
+		Game::ServerLaser laser;
+		// Get forward direction
+		glm::vec3 forward = player.orientation * glm::vec3(0.0f, 0.0f, 1.0f);
+
+		laser.uuid = laserUUIDCounter++;
+		laser.ownerID = player.id;
+		laser.position = player.position + forward * 2.0f;
+		laser.origin = laser.position;
+		laser.orientation = player.orientation;
+		//laser.velocity = forward * glm::vec3(0.0f, 0.0f, 20.0f); //20 units / s speed
+
+		//Server tick, clients fast forward with their synced tick
+		laser.startTime = serverTick;
+		laser.endTime = serverTick + LASER_LIFETIME_TICKS; // 2.5s before disapear
+		laser.transform = glm::translate(laser.position) * glm::mat4_cast(laser.orientation) * glm::scale(glm::vec3(1.0f));
+
+		lasers[laser.uuid] = laser; //add it to the server laser list
+		
+		//Send the spawnlaser package to all client
+		auto laserData = BatchLaser(laser);
+		auto fbb = packet::SpawnLaserS2C(&laserData, player.id, shotSeq);
+		net_instance.Broadcast(server, fbb, PacketPriority_Low); //Gone in 2.5s, not worth queueing behind a backlog (the shooters prediction just expires)
+	}
+	return true;
+}
+
+void GameServer::ResumeSession(ENetPeer* peer, const ResumeC2S& known)
+{
+	//The client reports what it still holds, anything else it missed while gone is the delta
+	std::unordered_set<uint32_t> knownPlayers, knownLasers;
+	if (known.players()) knownPlayers.insert(known.players()->begin(), known.players()->end());
+	if (known.lasers()) knownLasers.insert(known.lasers()->begin(), known.lasers()->end());
+
+	//Gone while the client was away
+	int despawned = 0;
+	for (uint32_t id : knownPlayers)
+	{
+		if (FindShip(id) != nullptr) continue;
+		net_instance.SendToClient(peer, packet::DespawnPlayerS2C(id), PacketStream_Ships);
+		despawned++;
+	}
+	for (uint32_t id : knownLasers)
+	{
+		if (lasers.contains(id)) continue;
+		net_instance.SendToClient(peer, packet::DespawnLaserS2C(id));
+		despawned++;
+	}
+
+	//New while the client was away, streamed in MTU sized chunks like a join
+	JoinStream& stream = joinStreams[peer];
+	stream.pendingPlayers.clear();
+	stream.pendingLasers.clear();
+	for (const auto& [id, ship] : players)
+		if (!knownPlayers.contains(id)) stream.pendingPlayers.push_back(id);
+	for (const auto& [id, ship] : ghosts)
+		if (!knownPlayers.contains(id)) stream.pendingPlayers.push_back(id);
+	for (const auto& [id, laser] : lasers)
+		if (!knownLasers.contains(id)) stream.pendingLasers.push_back(id);
+
+	//Kept ships get a fresh state on this receivers next replication pass
+	const int maxInterval = Core::CVarReadInt(sv_dr_max_interval);
+	for (uint32_t id : knownPlayers)
+	{
+		const Game::ServerSpaceship* ship = FindShip(id);
+		if (ship == nullptr) continue;
+		SetBaseline(peer, *ship);
+		ReplicatedShip& base = replicationBaselines[peer][id];
+		base.sentTick = serverTick - maxInterval;
+		base.keyframe = true; //What the client kept is older than any baseline we have
+	}
+
+	std::cout << "SERVER: Resume delta " << despawned << " despawns, " << stream.pendingPlayers.size()
+		<< " players and " << stream.pendingLasers.size() << " lasers to stream\n";
+	if (stream.pendingPlayers.empty() && stream.pendingLasers.empty())
+		joinStreams.erase(peer);
+}
+
+void GameServer::OnClientDisconnect(ENetPeer* peer, bool graceful) {
+
+	const int linkZone = ZoneOfLink(peer);
+	if (linkZone >= 0)
+	{
+		OnZoneLinkLost(linkZone);
+		return;
+	}
+	for (auto it = arrivals.begin(); it != arrivals.end(); it++)
+	{
+		if (it->second.peer != peer) continue;
+		arrivals.erase(it); //Gave up before its handoff arrived
+		return;
+	}
+	if (spectators.erase(peer))
+	{
+		ForgetReceiver(peer);
+		std::cout << "SERVER: Spectator relay left (" << spectators.size() << " relays)\n";
+		return;
+	}
 
+	const auto connection = connections.find(peer);
+	if (connection == connections.end())
+	{
+		redirected.erase(peer); //Handed off, left for its new zone
+		net_instance.ForgetPeer(peer);
+		return;
+	}
+	const uint32_t clientID = connection->second;
 	//std::cout << "SERVER: Client " << clientID << " disconnected.\n";
-	playerColliders.erase(clientID);
+	ForgetReceiver(peer); //Also stops streaming the world to a peer that left mid join
+	connections.erase(connection);
+
+	for (auto it = sessions.begin(); it != sessions.end(); it++)
+	{
+		if (it->second.peer != peer) continue;
+		if (graceful)
+			break; //Left on purpose, nothing to hold
+
+		//Dropped: the ship stays in the world (its input times out) until the client comes back or the grace ends
+		it->second.peer = nullptr;
+		it->second.expireTime = s_currentTime + uint64_t(std::max(0, Core::CVarReadInt(sv_session_grace)));
+		std::cout << "SERVER: Client " << clientID << " dropped, holding its session\n";
+		return;
+	}
+
+	RemovePlayer(clientID);
+}
+
+void GameServer::RemovePlayer(uint32_t clientID)
+{
+	for (auto it = sessions.begin(); it != sessions.end(); it++)
+	{
+		if (it->second.playerID != clientID) continue;
+		sessions.erase(it);
+		break;
+	}
+	for (auto& sp : spawnpoints)
+	{
+		if (sp.occupied && sp.ownerID == clientID)
+			sp.occupied = false;
+	}
+	pendingRespawns.erase(std::remove_if(pendingRespawns.begin(), pendingRespawns.end(),
+		[clientID](const PendingRespawn& respawn) { return respawn.playerID == clientID; }), pendingRespawns.end());
+
+	DestroyCollider(clientID);
+	for (auto& [peer, baselines] : replicationBaselines)
+		baselines.erase(clientID);
 	const auto fbb = packet::DespawnPlayerS2C(clientID);
-	net_instance.Broadcast(server, fbb);
+	net_instance.Broadcast(server, fbb, PacketPriority_Normal, PacketStream_Ships);
 	players.erase(clientID);
 }
 
-#pragma endregion
\ No newline at end of file
+void GameServer::DestroyCollider(uint32_t id)
+{
+	const auto collider = playerColliders.find(id);
+	if (collider == playerColliders.end()) return;
+	Physics::DestroyCollider(collider->second);
+	playerColliders.erase(collider);
+}
+
+void GameServer::ExpireSessions()
+{
+	std::vector<uint32_t> expired;
+	for (const auto& [token, session] : sessions)
+	{
+		if (session.peer == nullptr && s_currentTime >= session.expireTime)
+			expired.push_back(session.playerID);
+	}
+	for (uint32_t id : expired)
+	{
+		std::cout << "SERVER: Session of client " << id << " expired\n";
+		RemovePlayer(id);
+	}
+}
+
+#pragma endregion
+#pragma region ZONES
+
+void GameServer::InitZones(uint16_t port)
+{
+	zoneCount = std::clamp(Core::CVarReadInt(sv_zone_count), 1, 256); //The zone id travels in the low byte of the link connect data
+	zoneID = std::clamp(Core::CVarReadInt(sv_zone_id), 0, zoneCount - 1);
+	zoneSize = std::max(1.0f, Core::CVarReadFloat(sv_zone_size));
+	zoneBorder = std::clamp(Core::CVarReadFloat(sv_zone_border), 0.0f, zoneSize * 0.5f);
+	if (zoneCount <= 1) return;
+
+	//Ids stay unique across zones, a ship keeps its id when it is handed off
+	nextClientID = (uint32_t(zoneID) << 24) + 1;
+	laserUUIDCounter = uint32_t(zoneID) << 24;
+
+	//Either every zone listed in sv_zone_hosts or consecutive ports on this machine
+	zoneAddresses.assign(zoneCount, ENetAddress{});
+	const char* hostList = Core::CVarReadString(sv_zone_hosts);
+	std::string hosts = hostList != nullptr ? hostList : "";
+	for (int zone = 0; zone < zoneCount; ++zone)
+	{
+		ENetAddress& address = zoneAddresses[zone];
+		enet_address_set_host(&address, "127.0.0.1");
+		address.port = uint16_t(port - zoneID + zone);
+
+		const size_t end = hosts.find(',');
+		const std::string entry = hosts.substr(0, end);
+		hosts = end == std::string::npos ? "" : hosts.substr(end + 1);
+		const size_t colon = entry.rfind(':');
+		if (entry.empty() || colon == std::string::npos) continue;
+		enet_address_set_host(&address, entry.substr(0, colon).c_str());
+		address.port = uint16_t(std::atoi(entry.c_str() + colon + 1));
+	}
+
+	//Links are always opened by the lower zone, so every pair of neighbours shares exactly one
+	zoneLinkHost = enet_host_create(nullptr, 1, 1, 0, 0);
+	if (zoneLinkHost == nullptr)
+	{
+		std::cout << "SERVER: Failed to create the zone link host\n";
+		return;
+	}
+	net_instance.EnableDecompression(zoneLinkHost);
+	if (zoneID + 1 < zoneCount)
+		zoneLinks[zoneID + 1] = ZoneLink{ nullptr, true, false, 0 };
+
+	std::cout << "SERVER: Zone " << zoneID << " of " << zoneCount << " (x " << ZoneEdge(zoneID) << " to " << ZoneEdge(zoneID + 1) << ")\n";
+}
+
+void GameServer::ShutdownZones()
+{
+	if (zoneLinkHost != nullptr)
+	{
+		net_instance.ForgetHost(zoneLinkHost);
+		enet_host_destroy(zoneLinkHost);
+		zoneLinkHost = nullptr;
+	}
+	zoneLinks.clear();
+	ghosts.clear();
+	ghostInfo.clear();
+	ghostLasers.clear();
+	arrivals.clear();
+	redirected.clear();
+	zoneAddresses.clear();
+	zoneCount = 1;
+}
+
+float GameServer::ZoneEdge(int zone) const
+{
+	return -float(zoneCount) * zoneSize * 0.5f + float(zone) * zoneSize;
+}
+
+void GameServer::PollZoneLinks()
+{
+	if (zoneLinkHost == nullptr) return;
+
+	for (auto& [zone, link] : zoneLinks)
+	{
+		if (!link.outgoing || link.peer != nullptr || s_currentTime < link.nextAttempt) continue;
+		link.peer = enet_host_connect(zoneLinkHost, &zoneAddresses[zone], 1, ZoneConnectData | enet_uint32(zoneID));
+		link.nextAttempt = s_currentTime + 2000;
+	}
+
+	ENetEvent event;
+	while (enet_host_service(zoneLinkHost, &event, 0) > 0)
+	{
+		const int zone = ZoneOfLink(event.peer);
+		switch (event.type)
+		{
+			case ENET_EVENT_TYPE_CONNECT: {
+				if (zone < 0) break;
+				zoneLinks[zone].connected = true;
+				zoneLinks[zone].tickOffsetKnown = false;
+				std::cout << "SERVER: Linked to zone " << zone << "\n";
+				break;
+			}
+
+			case ENET_EVENT_TYPE_RECEIVE: {
+				const uint8_t* data = event.packet->data;
+				size_t size = event.packet->dataLength;
+				if (Compression::IsCompressed(data, size) && net_instance.Decompress(data, size, zoneLinkBuffer))
+					data = zoneLinkBuffer.data();
+				if (zone >= 0)
+					OnZonePacket(zone, data);
+				enet_packet_destroy(event.packet);
+				break;
+			}
+
+			case ENET_EVENT_TYPE_DISCONNECT: {
+				if (zone >= 0)
+					OnZoneLinkLost(zone);
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+}
+
+void GameServer::OnZoneLinkConnect(ENetPeer* peer, int zone)
+{
+	if (zoneCount <= 1 || zone != zoneID - 1)
+	{
+		std::cout << "SERVER: Refused zone link from zone " << zone << "\n";
+		net_instance.DisconnectNow(peer);
+		return;
+	}
+
+	//The neighbour restarted before its old link timed out
+	if (zoneLinks.contains(zone))
+		OnZoneLinkLost(zone);
+
+	//Not a receiver: no join stream, baselines or broadcasts, only what SendToZone addresses to it
+	zoneLinks[zone] = ZoneLink{ peer, false, true, 0 };
+	net_instance.SetPeerBroadcasts(peer, false);
+	std::cout << "SERVER: Zone " << zone << " linked\n";
+}
+
+void GameServer::OnZoneLinkLost(int zone)
+{
+	const auto found = zoneLinks.find(zone);
+	if (found == zoneLinks.end()) return;
+	ZoneLink& link = found->second;
+
+	if (link.outgoing)
+	{
+		if (link.connected) std::cout << "SERVER: Lost the link to zone " << zone << "\n";
+		link.peer = nullptr;
+		link.connected = false;
+		link.ghostsSent = 0;
+		link.nextAttempt = s_currentTime + 2000;
+	}
+	else
+	{
+		std::cout << "SERVER: Zone " << zone << " unlinked\n";
+		net_instance.ForgetPeer(link.peer);
+		zoneLinks.erase(found);
+	}
+
+	//Nobody updates its border ships anymore
+	std::vector<uint32_t> stale;
+	for (const auto& [id, info] : ghostInfo)
+		if (info.zone == zone) stale.push_back(id);
+	for (uint32_t id : stale)
+		RemoveGhost(id);
+}
+
+int GameServer::ZoneOfLink(const ENetPeer* peer) const
+{
+	for (const auto& [zone, link] : zoneLinks)
+		if (link.peer == peer) return zone;
+	return -1;
+}
+
+void GameServer::SendToZone(int zone, const FlatBufferBuilder& builder)
+{
+	const auto found = zoneLinks.find(zone);
+	if (found == zoneLinks.end() || !found->second.connected) return;
+	if (found->second.outgoing)
+		net_instance.SendToServer(found->second.peer, builder);
+	else
+		net_instance.SendToClient(found->second.peer, builder);
+}
+
+void GameServer::OnZonePacket(int zone, const uint8_t* data)
+{
+	auto wrapper = GetPacketWrapper(data);
+	switch (wrapper->packet_type())
+	{
+		case PacketType_ZoneHandoffZ2Z:
+		{
+			auto handoff = wrapper->packet_as_ZoneHandoffZ2Z();
+			if (!handoff) return;
+			ReceiveHandoff(*handoff);
+			break;
+		}
+		case PacketType_ZoneGhostsZ2Z:
+		{
+			auto message = wrapper->packet_as_ZoneGhostsZ2Z();
+			if (!message) return;
+			ReceiveGhosts(zone, *message);
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+void GameServer::HandoffShips()
+{
+	if (zoneLinks.empty()) return;
+
+	//A little past the boundary, a ship flying along it is not passed back and forth
+	const float low = ZoneEdge(zoneID) - zoneHysteresis;
+	const float high = ZoneEdge(zoneID + 1) + zoneHysteresis;
+	std::vector<std::pair<uint32_t, int>> leaving;
+	for (const auto& [id, ship] : players)
+	{
+		int zone = -1;
+		if (zoneID > 0 && ship.position.x < low)
+			zone = zoneID - 1;
+		else if (zoneID + 1 < zoneCount && ship.position.x > high)
+			zone = zoneID + 1;
+		const auto link = zoneLinks.find(zone);
+		if (link != zoneLinks.end() && link->second.connected)
+			leaving.emplace_back(id, zone);
+	}
+
+	for (const auto& [id, zone] : leaving)
+		HandOff(id, zone);
+}
+
+void GameServer::HandOff(uint32_t id, int zone)
+{
+	//Only ships with a live client move, a held ship stays until its client is back (the loopback player can not follow)
+	auto session = sessions.begin();
+	while (session != sessions.end() && session->second.playerID != id)
+		session++;
+	if (session == sessions.end() || session->second.peer == nullptr || session->second.peer == Loopback::Instance().Peer())
+		return;
+	const uint32_t token = session->first;
+	ENetPeer* peer = session->second.peer;
+	const Game::ServerSpaceship& ship = players.at(id);
+
+	//Its lasers fly on over there, our receivers keep seeing them until they would have expired
+	//(every zone counts its own ticks: sent relative to our current tick, the receiver adds its own)
+	std::vector<Laser> shipLasers;
+	for (auto it = lasers.begin(); it != lasers.end();)
+	{
+		if (it->second.ownerID != id) { it++; continue; }
+		Laser shot = BatchLaser(it->second);
+		shot.mutate_start_time(it->second.startTime - serverTick);
+		shot.mutate_end_time(it->second.endTime - serverTick);
+		shipLasers.push_back(shot);
+		ghostLasers[it->first] = it->second.endTime;
+		it = lasers.erase(it);
+	}
+
+	const uint32_t inputTick = ship.lastInputTimeStamp != 0 ? ship.lastInputTimeStamp - serverTick : 0;
+	SendToZone(zone, packet::ZoneHandoffZ2Z(BatchShip(ship), token, ship, inputTick, shipLasers));
+	net_instance.SendToClient(peer, packet::ZoneRedirectS2C(zoneAddresses[zone], token));
+
+	//Stays visible here as the neighbours ghost, its updates start with the next ghost message
+	ghosts.erase(id);
+	ghosts.emplace(id, ship); //Copied, ships are not assignable (const collider points)
+	ghostInfo[id] = ZoneGhost{ zone, s_currentTime + 500 };
+	players.erase(id);
+	DestroyCollider(id);
+	for (auto& sp : spawnpoints)
+	{
+		if (sp.occupied && sp.ownerID == id)
+			sp.occupied = false;
+	}
+	sessions.erase(session);
+
+	//The client disconnects itself once it read the redirect, until then it gets nothing
+	ForgetReceiver(peer);
+	connections.erase(peer);
+	net_instance.SetPeerBroadcasts(peer, false);
+	redirected[peer] = s_currentTime + 2000;
+	std::cout << "SERVER: Client " << id << " handed off to zone " << zone << " with " << shipLasers.size() << " lasers\n";
+}
+
+void GameServer::ReceiveHandoff(const ZoneHandoffZ2Z& handoff)
+{
+	const Player* player = handoff.player();
+	if (!player) return;
+	const uint32_t id = player->uuid();
+	const bool announced = ghosts.contains(id); //Our receivers already have it as a ghost
+	ghosts.erase(id);
+	ghostInfo.erase(id);
+
+	//BatchShip sends the orientation as (w, x, y, z)
+	const Vec3& pos = player->position();
+	const Vec3& vel = player->velocity();
+	const Vec4& orient = player->direction();
+	Game::ServerSpaceship& ship = players[id];
+	ship.id = id;
+	ship.position = glm::vec3(pos.x(), pos.y(), pos.z());
+	ship.linearVelocity = glm::vec3(vel.x(), vel.y(), vel.z());
+	ship.orientation = glm::quat(orient.x(), orient.y(), orient.z(), orient.w());
+	ship.currentSpeed = handoff.current_speed();
+	ship.rotationZ = handoff.rotation_z();
+	ship.rotXSmooth = handoff.rot_x_smooth();
+	ship.rotYSmooth = handoff.rot_y_smooth();
+	ship.rotZSmooth = handoff.rot_z_smooth();
+	ship.lastInputBitmap = handoff.input_bitmap(); //Keeps steering with the last input until the client is back
+	ship.lastInputTimeStamp = handoff.input_time() != 0 ? handoff.input_time() + serverTick : 0; //Relative to the senders tick
+	ship.inputCooldown = handoff.input_cooldown();
+	ship.transform = glm::translate(ship.position) * glm::mat4_cast(ship.orientation) * glm::scale(glm::vec3(1.0f));
+
+	if (!playerColliders.contains(id))
+		playerColliders[id] = Physics::CreateCollider(playerMeshColliderID, ship.transform);
+	else
+		Physics::SetTransform(playerColliders[id], ship.transform);
+	if (!announced)
+		AnnounceShip(ship);
+
+	//Lasers continue from where they are now
+	if (handoff.lasers()) for (const Laser* shot : *handoff.lasers())
+	{
+		const Vec3& origin = shot->origin();
+		const Vec4& direction = shot->direction();
+		Game::ServerLaser laser;
+		laser.uuid = shot->uuid();
+		laser.ownerID = id;
+		laser.startTime = shot->start_time() + serverTick; //Relative to the senders tick
+		laser.endTime = shot->end_time() + serverTick;
+		laser.origin = glm::vec3(origin.x(), origin.y(), origin.z());
+		laser.orientation = glm::quat(direction.x(), direction.y(), direction.z(), direction.w());
+		const float elapsed = std::max(0.0f, float(Tick::Diff(serverTick, laser.startTime)) * Tick::Seconds);
+		laser.position = laser.origin + (laser.orientation * glm::vec3(0.0f, 0.0f, 1.0f)) * LASER_SPEED * elapsed;
+		laser.previousPosition = laser.position;
+		laser.transform = glm::translate(laser.position) * glm::mat4_cast(laser.orientation) * glm::scale(glm::vec3(1.0f));
+		lasers[laser.uuid] = laser;
+
+		auto laserData = BatchLaser(laser);
+		net_instance.Broadcast(server, packet::SpawnLaserS2C(&laserData, id), PacketPriority_Low);
+	}
+
+	//Held until the client reconnects with the token, it resumes like after a dropped connection
+	const uint32_t token = handoff.session_token();
+	sessions[token] = Session{ id, nullptr, s_currentTime + uint64_t(std::max(0, Core::CVarReadInt(sv_session_grace))) };
+	std::cout << "SERVER: Took over client " << id << " from a neighbouring zone\n";
+
+	//The client was faster than its handoff
+	const auto arrival = arrivals.find(token);
+	if (arrival != arrivals.end())
+	{
+		ENetPeer* peer = arrival->second.peer;
+		arrivals.erase(arrival);
+		OnClientConnect(peer, token);
+	}
+}
+
+void GameServer::SendGhosts()
+{
+	if (zoneLinks.empty() || serverTick % zoneGhostInterval != 0) return;
+
+	for (auto& [zone, link] : zoneLinks)
+	{
+		if (!link.connected) continue;
+		const float edge = zone < zoneID ? ZoneEdge(zoneID) : ZoneEdge(zoneID + 1);
+
+		std::vector<Player> border;
+		for (const auto& [id, ship] : players)
+			if (std::abs(ship.position.x - edge) <= zoneBorder) border.push_back(BatchShip(ship));
+
+		//The neighbour drops ghosts missing from an update, one empty update clears them all
+		if (border.empty() && link.ghostsSent == 0) continue;
+		link.ghostsSent = border.size();
+		SendToZone(zone, packet::ZoneGhostsZ2Z(serverTick, border));
+	}
+}
+
+void GameServer::ReceiveGhosts(int zone, const ZoneGhostsZ2Z& message)
+{
+	//Brought forward to our clock, the ghosts coast from there until the next update. The neighbour counts its own ticks:
+	//the fastest delivery seen stands in for the offset between the counters, the age is how much slower this one came
+	ZoneLink& link = zoneLinks[zone];
+	const int32_t offset = Tick::Diff(message.time(), serverTick);
+	if (!link.tickOffsetKnown || offset > link.tickOffset)
+	{
+		link.tickOffset = offset;
+		link.tickOffsetKnown = true;
+	}
+	const float age = std::clamp(float(link.tickOffset - offset) * Tick::Seconds, 0.0f, 0.25f);
+
+	std::unordered_set<uint32_t> present;
+	if (message.players()) for (const Player* player : *message.players())
+	{
+		const uint32_t id = player->uuid();
+		present.insert(id);
+		if (players.contains(id)) continue; //Handed to us, the update crossed the handoff
+
+		const bool isNew = !ghosts.contains(id);
+		const Vec3& pos = player->position();
+		const Vec3& vel = player->velocity();
+		const Vec4& orient = player->direction();
+		Game::ServerSpaceship& ghost = ghosts[id];
+		ghost.id = id;
+		ghost.linearVelocity = glm::vec3(vel.x(), vel.y(), vel.z());
+		ghost.position = glm::vec3(pos.x(), pos.y(), pos.z()) + ghost.linearVelocity * age;
+		ghost.orientation = glm::quat(orient.x(), orient.y(), orient.z(), orient.w());
+		ghostInfo[id].zone = zone;
+		if (isNew)
+			AnnounceShip(ghost);
+	}
+
+	//Left the border (or died) over there, a ship we just handed off is kept until its first update
+	std::vector<uint32_t> gone;
+	for (const auto& [id, info] : ghostInfo)
+		if (info.zone == zone && !present.contains(id) && s_currentTime >= info.keepUntil) gone.push_back(id);
+	for (uint32_t id : gone)
+		RemoveGhost(id);
+}
+
+void GameServer::RemoveGhost(uint32_t id)
+{
+	ghosts.erase(id);
+	ghostInfo.erase(id);
+	for (auto& [peer, baselines] : replicationBaselines)
+		baselines.erase(id);
+	net_instance.Broadcast(server, packet::DespawnPlayerS2C(id), PacketPriority_Normal, PacketStream_Ships);
+}
+
+void GameServer::ExpireArrivals()
+{
+	std::vector<ENetPeer*> late;
+	for (auto it = arrivals.begin(); it != arrivals.end();)
+	{
+		if (s_currentTime < it->second.deadline) { it++; continue; }
+		late.push_back(it->second.peer);
+		it = arrivals.erase(it);
+	}
+	for (ENetPeer* peer : late)
+	{
+		std::cout << "SERVER: No handoff for a redirected client, joining it as a new player\n";
+		OnClientConnect(peer, 0);
+	}
+
+	//Clients that never read their redirect (or can not) would hold the slot forever
+	for (auto it = redirected.begin(); it != redirected.end();)
+	{
+		if (s_currentTime < it->second) { it++; continue; }
+		net_instance.DisconnectNow(it->first);
+		net_instance.ForgetPeer(it->first);
+		it = redirected.erase(it);
+	}
+}
+
+const Game::ServerSpaceship* GameServer::FindShip(uint32_t id) const
+{
+	const auto own = players.find(id);
+	if (own != players.end()) return &own->second;
+	const auto ghost = ghosts.find(id);
+	return ghost != ghosts.end() ? &ghost->second : nullptr;
+}
+
+#pragma endregion
+
+#pragma region CHECKPOINT
+
+//Time::Now is monotonic (since boot), the save time has to survive a reboot
+static uint64_t WallClockMs()
+{
+	return uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+void GameServer::SaveCheckpoint(bool wait)
+{
+	const char* path = Core::CVarReadString(sv_checkpoint);
+	if (path == nullptr || path[0] == '\0') return;
+
+	Checkpoint::Writer writer;
+	Checkpoint::Header& head = writer.Head();
+	head.savedAt = WallClockMs();
+	head.serverTick = serverTick;
+	head.nextClientID = nextClientID;
+	head.laserUUIDCounter = laserUUIDCounter;
+	head.playerMeshCollider = uint32_t(playerMeshColliderID);
+
+	std::vector<Checkpoint::ShipRecord> ships;
+	ships.reserve(players.size());
+	for (const auto& [id, ship] : players)
+	{
+		Checkpoint::ShipRecord record = {};
+		record.id = id;
+		const auto collider = playerColliders.find(id);
+		record.collider = collider != playerColliders.end() ? uint32_t(collider->second) : uint32_t(Physics::ColliderId::Invalid());
+		memcpy(record.position, glm::value_ptr(ship.position), sizeof(record.position));
+		record.orientation[0] = ship.orientation.w;
+		record.orientation[1] = ship.orientation.x;
+		record.orientation[2] = ship.orientation.y;
+		record.orientation[3] = ship.orientation.z;
+		memcpy(record.linearVelocity, glm::value_ptr(ship.linearVelocity), sizeof(record.linearVelocity));
+		record.currentSpeed = ship.currentSpeed;
+		record.rotationZ = ship.rotationZ;
+		record.rotSmooth[0] = ship.rotXSmooth;
+		record.rotSmooth[1] = ship.rotYSmooth;
+		record.rotSmooth[2] = ship.rotZSmooth;
+		record.inputCooldown = ship.inputCooldown;
+		record.lastInputTimeStamp = ship.lastInputTimeStamp;
+		record.lastInputBitmap = ship.lastInputBitmap;
+		ships.push_back(record);
+	}
+	writer.Add(Checkpoint::Section_Ships, ships);
+
+	std::vector<Checkpoint::LaserRecord> laserRecords;
+	laserRecords.reserve(lasers.size());
+	for (const auto& [id, laser] : lasers)
+	{
+		Checkpoint::LaserRecord record = {};
+		record.uuid = laser.uuid;
+		record.ownerID = laser.ownerID;
+		record.startTime = laser.startTime;
+		record.endTime = laser.endTime;
+		memcpy(record.origin, glm::value_ptr(laser.origin), sizeof(record.origin));
+		memcpy(record.position, glm::value_ptr(laser.position), sizeof(record.position));
+		record.orientation[0] = laser.orientation.w;
+		record.orientation[1] = laser.orientation.x;
+		record.orientation[2] = laser.orientation.y;
+		record.orientation[3] = laser.orientation.z;
+		laserRecords.push_back(record);
+	}
+	writer.Add(Checkpoint::Section_Lasers, laserRecords);
+
+	std::vector<Checkpoint::RespawnRecord> respawns;
+	for (const PendingRespawn& respawn : pendingRespawns)
+		respawns.push_back({ respawn.playerID, respawn.respawnTick });
+	writer.Add(Checkpoint::Section_Respawns, respawns);
+
+	std::vector<Checkpoint::SpawnPointRecord> spawns;
+	for (const SpawnPoint& sp : spawnpoints)
+		spawns.push_back({ sp.ownerID, sp.occupied ? 1u : 0u });
+	writer.Add(Checkpoint::Section_SpawnPoints, spawns);
+
+	//Every session, live ones included: all clients lose their connection with the process
+	std::vector<Checkpoint::SessionRecord> sessionRecords;
+	for (const auto& [token, session] : sessions)
+		sessionRecords.push_back({ token, session.playerID });
+	writer.Add(Checkpoint::Section_Sessions, sessionRecords);
+
+	std::vector<Checkpoint::AsteroidRecord> asteroidRecords;
+	for (const ServerAsteroid& asteroid : asteroids)
+	{
+		Checkpoint::AsteroidRecord record = {};
+		record.collider = uint32_t(asteroid.colliderID);
+		memcpy(record.transform, glm::value_ptr(asteroid.transform), sizeof(record.transform));
+		asteroidRecords.push_back(record);
+	}
+	writer.Add(Checkpoint::Section_Asteroids, asteroidRecords);
+
+	std::vector<uint8_t> world;
+	Physics::SaveWorld(world);
+	writer.AddBlob(Checkpoint::Section_PhysicsWorld, world);
+
+	std::vector<uint8_t> image = writer.Finish();
+	if (!wait)
+	{
+		Checkpoint::WriteAsync(path, std::move(image));
+		return;
+	}
+	Checkpoint::WaitForWrites();
+	if (Checkpoint::Write(path, image))
+		std::cout << "SERVER: Checkpoint written to " << path << " (" << image.size() << " bytes)\n";
+	else
+		std::cout << "SERVER: Failed to write checkpoint " << path << "\n";
+}
+
+bool GameServer::LoadCheckpoint()
+{
+	const char* path = Core::CVarReadString(sv_checkpoint);
+	if (path == nullptr || path[0] == '\0') return false;
+
+	const auto begin = std::chrono::steady_clock::now();
+	Checkpoint::MappedFile file;
+	if (!file.Open(path)) return false;
+	Checkpoint::Reader reader;
+	if (!reader.Open(file.Data(), file.Size()))
+	{
+		std::cout << "SERVER: Checkpoint " << path << " is from another version or damaged, starting empty\n";
+		return false;
+	}
+	const Checkpoint::Header& head = reader.Head();
+
+	//A dedicated server takes the whole physics world (no glTF parsing, collider ids stay valid),
+	//a hosting game already built its own world and asteroids, only the ships get new colliders
+	const bool restoreWorld = Physics::IsWorldEmpty() && asteroids.empty();
+	if (restoreWorld)
+	{
+		size_t worldSize = 0;
+		const uint8_t* world = reader.Blob(Checkpoint::Section_PhysicsWorld, worldSize);
+		if (world == nullptr || !Physics::RestoreWorld(world, worldSize))
+		{
+			std::cout << "SERVER: Checkpoint has no usable physics world, starting empty\n";
+			return false;
+		}
+		playerMeshColliderID = Physics::ColliderMeshId::Create(head.playerMeshCollider);
+		assetsLoaded = true;
+
+		size_t count = 0;
+		const Checkpoint::AsteroidRecord* asteroidRecords = reader.Records<Checkpoint::AsteroidRecord>(Checkpoint::Section_Asteroids, count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			ServerAsteroid asteroid;
+			asteroid.colliderID = Physics::ColliderId::Create(asteroidRecords[i].collider);
+			asteroid.transform = glm::make_mat4(asteroidRecords[i].transform);
+			asteroids.push_back(asteroid);
+		}
+	}
+	else
+		LoadAssets();
+
+	size_t count = 0;
+	const Checkpoint::ShipRecord* ships = reader.Records<Checkpoint::ShipRecord>(Checkpoint::Section_Ships, count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Checkpoint::ShipRecord& record = ships[i];
+		Game::ServerSpaceship& ship = players[record.id];
+		ship.id = record.id;
+		ship.position = glm::make_vec3(record.position);
+		ship.orientation = glm::quat(record.orientation[0], record.orientation[1], record.orientation[2], record.orientation[3]);
+		ship.linearVelocity = glm::make_vec3(record.linearVelocity);
+		ship.currentSpeed = record.currentSpeed;
+		ship.rotationZ = record.rotationZ;
+		ship.rotXSmooth = record.rotSmooth[0];
+		ship.rotYSmooth = record.rotSmooth[1];
+		ship.rotZSmooth = record.rotSmooth[2];
+		ship.inputCooldown = record.inputCooldown;
+		ship.lastInputTimeStamp = record.lastInputTimeStamp;
+		ship.lastInputBitmap = record.lastInputBitmap;
+		ship.transform = glm::translate(ship.position) * glm::mat4_cast(ship.orientation) * glm::scale(glm::vec3(1.0f));
+		if (restoreWorld)
+			playerColliders[record.id] = Physics::ColliderId::Create(record.collider);
+		else
+			playerColliders[record.id] = Physics::CreateCollider(playerMeshColliderID, ship.transform);
+	}
+	const size_t shipCount = count;
+
+	const Checkpoint::LaserRecord* laserRecords = reader.Records<Checkpoint::LaserRecord>(Checkpoint::Section_Lasers, count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Checkpoint::LaserRecord& record = laserRecords[i];
+		Game::ServerLaser laser;
+		laser.uuid = record.uuid;
+		laser.ownerID = record.ownerID;
+		laser.startTime = record.startTime;
+		laser.endTime = record.endTime;
+		laser.origin = glm::make_vec3(record.origin);
+		laser.position = glm::make_vec3(record.position);
+		laser.previousPosition = laser.position;
+		laser.orientation = glm::quat(record.orientation[0], record.orientation[1], record.orientation[2], record.orientation[3]);
+		laser.transform = glm::translate(laser.position) * glm::mat4_cast(laser.orientation) * glm::scale(glm::vec3(1.0f));
+		lasers[laser.uuid] = laser;
+	}
+
+	const Checkpoint::RespawnRecord* respawns = reader.Records<Checkpoint::RespawnRecord>(Checkpoint::Section_Respawns, count);
+	for (size_t i = 0; i < count; ++i)
+		pendingRespawns.push_back({ respawns[i].playerID, respawns[i].respawnTick });
+
+	const Checkpoint::SpawnPointRecord* spawns = reader.Records<Checkpoint::SpawnPointRecord>(Checkpoint::Section_SpawnPoints, count);
+	for (size_t i = 0; i < count && i < spawnpoints.size(); ++i)
+	{
+		spawnpoints[i].ownerID = spawns[i].ownerID;
+		spawnpoints[i].occupied = spawns[i].occupied != 0;
+	}
+
+	//Held like a dropped connection, clients reconnecting with their token resume through ResumeC2S
+	const uint64_t expireTime = Time::Now() + uint64_t(std::max(0, Core::CVarReadInt(sv_session_grace)));
+	const Checkpoint::SessionRecord* sessionRecords = reader.Records<Checkpoint::SessionRecord>(Checkpoint::Section_Sessions, count);
+	for (size_t i = 0; i < count; ++i)
+		sessions[sessionRecords[i].token] = Session{ sessionRecords[i].playerID, nullptr, expireTime };
+
+	nextClientID = std::max(nextClientID, head.nextClientID);
+	laserUUIDCounter = std::max(laserUUIDCounter, head.laserUUIDCounter);
+	serverTick = head.serverTick;
+
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	std::cout << "SERVER: Restored checkpoint " << path << " (" << shipCount << " players, " << lasers.size() << " lasers, "
+		<< sessions.size() << " held sessions" << (restoreWorld ? ", physics world" : "") << ") in " << ms << "ms, saved "
+		<< int64_t(WallClockMs() - head.savedAt) << "ms ago\n";
+	return true;
+}
+
+#pragma endregion
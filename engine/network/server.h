@@ -3,9 +3,13 @@
 //#include "proto.h"
 
 #include "network.h"
+#include "bitpack.h"
+#include "replication.h"
+#include "ingress.h"
 #include <unordered_map>
 #include "physics/physics.h"
 #include <unordered_set>
+#include <random>
 
 //#include "../projects/spacegame/code/spaceship.h"
 
@@ -29,7 +33,73 @@ struct ServerAsteroid
 struct PendingRespawn
 {
     uint32_t playerID;
-    float respawnTimer; //second left until respawn
+    uint32_t respawnTick; //server tick the player respawns
+};
+
+struct JoinStream
+{
+    std::vector<uint32_t> pendingPlayers; //ships the joining peer has not been sent yet
+    std::vector<uint32_t> pendingLasers; //lasers the joining peer has not been sent yet
+};
+
+struct ReplicatedShip
+{
+    //Last state a receiver got for a ship, extrapolated the same way the client does (position + velocity * elapsed)
+    //Bit packed receivers only get the dirty fields, the others stay as they were (within one quantization step of the ship)
+    Replication::ShipState state;
+    uint32_t sentTick = 0; //server tick the state was sent
+    bool keyframe = false; //the receivers copy is unknown (resumed session), the next update carries every field
+};
+
+struct Session
+{
+    uint32_t playerID = 0;
+    ENetPeer* peer = nullptr; //nullptr while the player is held for a reconnect
+    uint64_t expireTime = 0; //server time (ms) a held player is removed
+};
+
+struct SnapshotRate
+{
+    int interval = 5; //ticks between replication passes for this receiver (5 = 12hz)
+    uint32_t lastSentTick = 0; //tick of the last replication pass
+    uint32_t lastAdaptTick = 0; //tick the interval was last reevaluated
+};
+
+struct InputAck
+{
+    uint16_t seq = 0; //InputC2S seq of the last applied input
+    uint64_t receivedUs = 0; //Time::NowUs() it was applied
+    bool pending = false; //not echoed yet, goes out with the receivers own ship on its next replication pass
+};
+
+struct PeerBacklog
+{
+    size_t bytes = 0; //reliable data in transit + queued, capped at sv_backlog_hard
+    bool congested = false; //above sv_backlog_soft (state updates and low priority events are held back)
+    uint64_t overHardSince = 0; //server time (ms) the peer went above sv_backlog_hard, 0 = below
+};
+
+struct ZoneLink
+{
+    ENetPeer* peer = nullptr; //Ours on zoneLinkHost (towards the higher zone) or theirs on the server host (from the lower zone)
+    bool outgoing = false;
+    bool connected = false;
+    uint64_t nextAttempt = 0; //outgoing only, server time (ms) of the next connect attempt
+    size_t ghostsSent = 0; //Ships in the last ghost update, an empty update is only sent once
+    int32_t tickOffset = 0; //Their tick - ours, less the fastest delivery seen (every zone counts its own ticks)
+    bool tickOffsetKnown = false;
+};
+
+struct ZoneGhost
+{
+    int zone = -1; //Neighbour that owns the ship
+    uint64_t keepUntil = 0; //server time (ms), a ship we just handed off is kept even if a ghost update crossed the handoff
+};
+
+struct ZoneArrival
+{
+    ENetPeer* peer = nullptr; //Client that connected with a token whose handoff has not arrived yet
+    uint64_t deadline = 0; //server time (ms) it is let in as a new player instead
 };
 
 struct SpawnPoint
@@ -72,6 +142,9 @@ public:
     void Update(float dt = 0.016f);
     void SetAsteroid(const ServerAsteroid& asteroid) { 
         asteroids.push_back(asteroid); }
+    void LoadAssets(); //Collider meshes of the simulation, StartServer loads them if nobody did before (see projects/matchpool)
+    bool Idle() const { return sessions.empty() && spectators.empty(); } //No player connected or held
+    bool Listening() const { return server != nullptr; } //StartServer got its port
 
     GameServer() = default;
     ~GameServer();
@@ -84,13 +157,57 @@ private:
     //ENET / NETWORKING
     void InitNetwork(uint16_t port);
     void PollNetworkEvents();
-    void OnClientConnect(ENetPeer* peer);
-    void OnClientDisconnect(uint32_t clientID);
-    void OnPacketRecieved(uint32_t senderID, const ENetPacket* packet);
+    void PollIngress(); //Events forwarded by the ingress workers (sv_ingress_workers > 0)
+    void PollLoopback(); //Hosts own client (in process, no ENet)
+    void OnClientConnect(ENetPeer* peer, uint32_t sessionToken = 0);
+    void OnClientDisconnect(ENetPeer* peer, bool graceful);
+    void OnSpectatorConnect(ENetPeer* peer); //Relay subscribing with SpectatorConnectData
+    std::string PeerLabel(ENetPeer* peer) const; //"client <id>" / "spectator relay" for logs
+    void ForgetReceiver(ENetPeer* peer); //Drops every per receiver state (join stream, baselines, rate, format, backlog)
+    void OnPacketRecieved(ENetPeer* peer, const uint8_t* data);
+    void OnBitPackedRecieved(ENetPeer* peer, const uint8_t* data, size_t size); //Messages on BitPack::Channel
+    bool ApplyInput(uint32_t senderID, uint32_t tick, uint16_t bitmap, uint32_t shotSeq); //Shared by both wire formats, false when dropped
+    void AckInput(ENetPeer* peer, uint16_t inputSeq); //Echoed in the senders next own ship update
+    BitPack::WireFormat NegotiateWireFormat(ENetPeer* peer) const;
+    void ApplyCompressionSettings(); //sv_compression / sv_compress_min / sv_capture, rechecked every tick
+    void ResumeSession(ENetPeer* peer, const ResumeC2S& known); //Sends what changed since the client dropped
+    void ExpireSessions(); //Removes held players whose grace period ran out
+    void StreamJoinState(); //Sends the next join chunk to peers still receiving the world
+    size_t JoinChunkCapacity(ENetPeer* peer) const; //Entities that fit in one unfragmented packet
+    void ReplicateShips(); //Sends ship updates only where the receivers extrapolation drifted too far
+    void SetBaseline(ENetPeer* peer, const Game::ServerSpaceship& ship); //Records what a receiver was sent
+    void AdaptSnapshotRates(); //Moves every receivers snapshot interval with its RTT / throttle
+    void MonitorBacklogs(); //Marks backed up peers congested, drops the ones that stay over the hard limit
+    bool IsCongested(ENetPeer* peer) const { const auto it = backlogs.find(peer); return it != backlogs.end() && it->second.congested; }
+
+    //SPATIAL ZONES (sv_zone_count > 1, the world is split along x, every zone is its own server process)
+    void InitZones(uint16_t port);
+    void ShutdownZones();
+    void PollZoneLinks(); //Outgoing link towards the next zone
+    void OnZoneLinkConnect(ENetPeer* peer, int zone);
+    void OnZoneLinkLost(int zone);
+    void OnZonePacket(int zone, const uint8_t* data);
+    int ZoneOfLink(const ENetPeer* peer) const; //-1 = not a zone link
+    void SendToZone(int zone, const FlatBufferBuilder& builder);
+    void HandoffShips(); //Ships past a boundary move to the neighbour, their client is redirected
+    void HandOff(uint32_t id, int zone);
+    void ReceiveHandoff(const ZoneHandoffZ2Z& handoff);
+    void SendGhosts(); //Own ships near a boundary, mirrored read only by the neighbour
+    void ReceiveGhosts(int zone, const ZoneGhostsZ2Z& message);
+    void RemoveGhost(uint32_t id);
+    void ExpireArrivals(); //Clients whose handoff never came join as new players, redirected clients that stayed are dropped
+    float ZoneEdge(int zone) const; //Lowest x of a zone (zone 0 and the last zone are unbounded outwards)
+    const Game::ServerSpaceship* FindShip(uint32_t id) const; //Own ship or ghost
+    void AnnounceShip(const Game::ServerSpaceship& ship); //SpawnPlayerS2C + baselines for every receiver
+
+    //CHECKPOINT (sv_checkpoint, warm restart from the last saved state)
+    void SaveCheckpoint(bool wait); //wait = blocking write (shutdown), otherwise written on a background thread
+    bool LoadCheckpoint(); //False when there is no valid checkpoint, the server then starts empty
 
     //GAMEPLAY
     void SpawnPlayer(uint32_t clientID);
-    void RemovePlayer(uint32_t clientID);
+    void RemovePlayer(uint32_t clientID); //Final removal (leave or expired session), frees the spawnpoint
+    void DestroyCollider(uint32_t id); //Frees the ships physics collider, a dead or departed ship would stop lasers otherwise
     bool CheckCollision(Game::ServerSpaceship& shipA, Game::ServerSpaceship& shipB);
 
     //UTILITIY
@@ -98,24 +215,77 @@ private:
     Laser BatchLaser(const Game::ServerLaser& laser) const;
 
     //SERVER STATE
-    ENetHost* server;
+    ENetHost* server = nullptr;
     uint32_t serverPort;
 
     uint32_t nextClientID = 1; //Auto increment ID for new player
-    uint64_t s_currentTime = 0; //current server time (ms)
+    uint64_t s_currentTime = 0; //current server time (ms, monotonic), only for local timeouts, never sent
 
 
-    int serverTickCounter = 0;
-    const int sendRate = 5; // every 5 physics tick
+    uint32_t serverTick = 0; //Simulation tick, the time base of the protocol (every time on the wire is a tick number)
 
     //Server time related  (general time related)
-    
+    uint64_t nextTickTime = 0; //monotonic us the next tick is due (fixed cadence, Tick::Rate)
+
 
     //CONNECTED USERS (CLIENTS)
     std::unordered_map<ENetPeer*, uint32_t> connections;
+    std::vector<uint8_t> loopbackBuffer; //Reused receive buffer for the loopback queue
+    std::vector<IngressEvent> ingressEvents; //Reused for the events drained from the ingress workers
+
+    //SESSIONS (token handed out on connect, a dropped player is held for sv_session_grace ms)
+    std::unordered_map<uint32_t, Session> sessions; //session token -> session
+    std::mt19937 tokenGenerator{ std::random_device{}() };
+
+    //SPECTATOR RELAYS (receivers without a ship, see projects/relay)
+    std::unordered_set<ENetPeer*> spectators;
+
+    //SPATIAL ZONES
+    int zoneID = 0;
+    int zoneCount = 1; //1 = no zoning
+    float zoneSize = 200.0f; //Width of a zone along x (the outer zones are unbounded)
+    float zoneBorder = 25.0f; //Ships this close to a boundary are mirrored to the neighbour
+    const float zoneHysteresis = 2.0f; //Distance past the boundary before a ship is handed off (no ping pong)
+    const int zoneGhostInterval = 3; //Ticks between ghost updates to a neighbour
+    std::vector<ENetAddress> zoneAddresses; //Game port of every zone (clients are redirected there, links connect there)
+    ENetHost* zoneLinkHost = nullptr;
+    std::unordered_map<int, ZoneLink> zoneLinks; //neighbour zone -> link
+    std::unordered_map<uint32_t, Game::ServerSpaceship> ghosts; //Read only border ships of the neighbours (replicated, never simulated)
+    std::unordered_map<uint32_t, ZoneGhost> ghostInfo;
+    std::unordered_map<uint32_t, uint32_t> ghostLasers; //Lasers handed off with their ship, despawned here at their end tick
+    std::unordered_map<uint32_t, ZoneArrival> arrivals; //session token -> client waiting for its handoff
+    std::unordered_map<ENetPeer*, uint64_t> redirected; //Clients sent to a neighbour -> server time (ms) they are dropped if still connected
+    std::vector<uint8_t> zoneLinkBuffer; //Decompressed payloads received on zoneLinkHost
+
+    //JOIN IN PROGRESS (world state is streamed to new peers in MTU sized chunks over several ticks)
+    std::unordered_map<ENetPeer*, JoinStream> joinStreams;
+    const int joinChunksPerTick = 4; //Upper bound of join chunks sent per tick across all joining peers
+
+    //DEAD RECKONING REPLICATION (per receiver baseline of every ship it knows about)
+    std::unordered_map<ENetPeer*, std::unordered_map<uint32_t, ReplicatedShip>> replicationBaselines;
+
+    //PER RECEIVER SNAPSHOT RATE (60hz for good links, backs off for congested ones)
+    std::unordered_map<ENetPeer*, SnapshotRate> snapshotRates;
+
+    //WIRE FORMAT AGREED ON CONNECT (bit packed input / ship updates for clients that support it)
+    std::unordered_map<ENetPeer*, BitPack::WireFormat> wireFormats;
+    std::unordered_set<uint32_t> unpackedShips; //Ships already reported as falling back to FlatBuffers updates
+
+    //INPUT ACKS (last applied input per client, echoed with the delay it spent on the server)
+    std::unordered_map<ENetPeer*, InputAck> inputAcks;
+
+    //BACKPRESSURE (outstanding reliable data per peer, see MonitorBacklogs)
+    std::unordered_map<ENetPeer*, PeerBacklog> backlogs;
+
+    //CHECKPOINT
+    uint64_t nextCheckpointTime = 0; //server time (ms) of the next periodic checkpoint
+
+    //PAYLOAD COMPRESSION (modes in compression.h, dictionary agreed per peer through ClientHelloC2S)
+    bool compressionApplied = false;
 
     //GAME STATE
     Physics::ColliderMeshId playerMeshColliderID;
+    bool assetsLoaded = false;
     std::unordered_map<uint32_t, Game::ServerSpaceship> players; //AMount of player ship is registered in the server (for handling updates and changes)
     std::unordered_map<uint32_t, Physics::ColliderId> playerColliders; //Colliders for the players spaceship
     std::unordered_map<uint32_t, Game::ServerLaser> lasers; // All the registered laser in the server
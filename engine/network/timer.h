@@ -1,12 +1,31 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 
 
 struct Time {
+    //Monotonic (steady_clock), never jumps with NTP or a changed system clock. Only meaningful as a difference
     static uint64_t Now() {
-        const auto now = std::chrono::system_clock::now();
+        const auto now = std::chrono::steady_clock::now();
         const auto duration = now.time_since_epoch();
         return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
     }
-};
\ No newline at end of file
+    static uint64_t NowUs() {
+        const auto duration = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    }
+};
+
+//Server simulation tick, the time base of the protocol (32 bit tick numbers instead of epoch ms)
+struct Tick {
+    static constexpr uint32_t Rate = 60; //ticks per second
+    static constexpr uint64_t Us = 1000000 / Rate; //length of one tick
+    static constexpr double Ms = 1000.0 / Rate;
+    static constexpr float Seconds = 1.0f / Rate;
+
+    //a - b in ticks, right across the wrap (every ~2.2 years at 60hz)
+    static int32_t Diff(uint32_t a, uint32_t b) { return int32_t(a - b); }
+    static bool Reached(uint32_t now, uint32_t tick) { return Diff(now, tick) >= 0; }
+    static uint32_t FromMs(uint64_t ms) { return uint32_t((ms * Rate + 999) / 1000); } //rounded up
+};
@@ -10,6 +10,8 @@
 #include "core/random.h"
 #include "core/cvar.h"
 #include <iostream>
+#include <cstring>
+#include <algorithm>
 namespace Physics
 {
 
@@ -34,10 +36,46 @@ struct Colliders
     std::vector<ColliderMeshId> meshes;
 };
 
+//------------------------------------------------------------------------------
+/**
+    Broadphase, a bounding volume tree with one leaf per active collider (the box
+    around its bounding sphere). Moving a collider refits the boxes above its leaf,
+    creating or destroying one inserts or removes a single leaf. The whole tree is
+    rebuilt by the next raycast when it was invalidated: colliders created before
+    the first raycast (loading a field), a restored world, or so many refits and
+    inserts since the last build that the boxes have grown loose.
+*/
+struct BoundsTree
+{
+    struct Node
+    {
+        glm::vec3 min;
+        int32_t parent = -1;
+        glm::vec3 max;
+        int32_t collider = -1; // leaves only
+        int32_t children[2] = { -1, -1 };
+    };
+    struct Visit
+    {
+        int32_t node;
+        float enter; // distance along the ray where it enters the box
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int32_t> freeNodes;
+    std::vector<int32_t> leaves; // collider index -> leaf node, -1 when not in the tree
+    std::vector<Visit> stack; // raycast traversal
+    int32_t root = -1;
+    bool dirty = true;
+    size_t changes = 0; // refits and inserts since the last build
+};
+
 static Colliders colliders;
 static std::vector<ColliderMesh> meshes;
 static Util::IdPool<ColliderMeshId> colliderMeshPool;
 static Util::IdPool<ColliderId> colliderPool;
+static BoundsTree tree;
+static Core::CVar* phys_bvh = nullptr;
 
 //------------------------------------------------------------------------------
 /**
@@ -92,13 +130,11 @@ LoadFromIndexBuffer(fx::gltf::Document const& doc, ColliderMesh* mesh)
         mesh->tris.push_back(std::move(tri));
     }
 
-    // bounding sphere radius is max of x, y or z from aabb
-    mesh->bSphereRadius = vbAccessor.max[0];
-    mesh->bSphereRadius = std::max(mesh->bSphereRadius, vbAccessor.max[1]);
-    mesh->bSphereRadius = std::max(mesh->bSphereRadius, vbAccessor.max[2]);
-    mesh->bSphereRadius = std::max(mesh->bSphereRadius, fabs(vbAccessor.min[0]));
-    mesh->bSphereRadius = std::max(mesh->bSphereRadius, fabs(vbAccessor.min[1]));
-    mesh->bSphereRadius = std::max(mesh->bSphereRadius, fabs(vbAccessor.min[2]));
+    // bounding sphere radius is the farthest vertex, the broadphase relies on every triangle being inside
+    mesh->bSphereRadius = 0.0f;
+    for (ColliderMesh::Triangle const& tri : mesh->tris)
+        for (glm::vec3 const& vertex : tri.vertices)
+            mesh->bSphereRadius = std::max(mesh->bSphereRadius, glm::length(vertex));
 }
 
 
@@ -164,6 +200,229 @@ LoadColliderMesh(std::string path)
     return id;
 }
 
+//------------------------------------------------------------------------------
+/**
+    Box around the colliders bounding sphere, with a little slack for float error in the transform.
+*/
+static void
+ColliderBounds(int colliderIndex, glm::vec3& min, glm::vec3& max)
+{
+    glm::vec4 const& PS = colliders.positionsAndScales[colliderIndex];
+    float const radius = meshes[colliders.meshes[colliderIndex].index].bSphereRadius * PS.w * 1.0001f + 0.0001f;
+    min = glm::vec3(PS) - radius;
+    max = glm::vec3(PS) + radius;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static float
+SurfaceArea(glm::vec3 const& min, glm::vec3 const& max)
+{
+    glm::vec3 const d = max - min;
+    return d.x * d.y + d.y * d.z + d.z * d.x;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static int32_t
+AllocateNode()
+{
+    if (!tree.freeNodes.empty())
+    {
+        int32_t const node = tree.freeNodes.back();
+        tree.freeNodes.pop_back();
+        tree.nodes[node] = BoundsTree::Node();
+        return node;
+    }
+    tree.nodes.emplace_back();
+    return (int32_t)tree.nodes.size() - 1;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Recomputes the boxes from node up to the root.
+*/
+static void
+RefitAncestors(int32_t node)
+{
+    for (; node != -1; node = tree.nodes[node].parent)
+    {
+        BoundsTree::Node& n = tree.nodes[node];
+        BoundsTree::Node const& a = tree.nodes[n.children[0]];
+        BoundsTree::Node const& b = tree.nodes[n.children[1]];
+        n.min = glm::min(a.min, b.min);
+        n.max = glm::max(a.max, b.max);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Top down build, splits at the median center along the longest axis of the centers.
+*/
+static int32_t
+BuildNode(int32_t* first, size_t count, int32_t parent)
+{
+    int32_t const node = AllocateNode();
+    tree.nodes[node].parent = parent;
+    if (count == 1)
+    {
+        tree.nodes[node].collider = *first;
+        ColliderBounds(*first, tree.nodes[node].min, tree.nodes[node].max);
+        tree.leaves[*first] = node;
+        return node;
+    }
+
+    glm::vec3 centerMin = glm::vec3(colliders.positionsAndScales[*first]);
+    glm::vec3 centerMax = centerMin;
+    for (size_t i = 1; i < count; i++)
+    {
+        centerMin = glm::min(centerMin, glm::vec3(colliders.positionsAndScales[first[i]]));
+        centerMax = glm::max(centerMax, glm::vec3(colliders.positionsAndScales[first[i]]));
+    }
+    glm::vec3 const extent = centerMax - centerMin;
+    int const axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+    size_t const half = count / 2;
+    std::nth_element(first, first + half, first + count, [axis](int32_t a, int32_t b)
+    {
+        return colliders.positionsAndScales[a][axis] < colliders.positionsAndScales[b][axis];
+    });
+    int32_t const left = BuildNode(first, half, node);
+    int32_t const right = BuildNode(first + half, count - half, node);
+    tree.nodes[node].children[0] = left;
+    tree.nodes[node].children[1] = right;
+    tree.nodes[node].min = glm::min(tree.nodes[left].min, tree.nodes[right].min);
+    tree.nodes[node].max = glm::max(tree.nodes[left].max, tree.nodes[right].max);
+    return node;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+RebuildTree()
+{
+    tree.nodes.clear();
+    tree.freeNodes.clear();
+    tree.leaves.assign(colliders.active.size(), -1);
+    tree.root = -1;
+    tree.dirty = false;
+    tree.changes = 0;
+
+    std::vector<int32_t> active;
+    for (int32_t i = 0; i < (int32_t)colliders.active.size(); i++)
+        if (colliders.active[i])
+            active.push_back(i);
+    if (active.empty())
+        return;
+
+    tree.nodes.reserve(active.size() * 2 - 1);
+    tree.root = BuildNode(active.data(), active.size(), -1);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Walks down towards the sibling that grows the boxes the least (surface area), and pairs the new leaf with it.
+*/
+static void
+InsertLeaf(int32_t colliderIndex)
+{
+    int32_t const leaf = AllocateNode();
+    glm::vec3 min, max;
+    ColliderBounds(colliderIndex, min, max);
+    tree.nodes[leaf].min = min;
+    tree.nodes[leaf].max = max;
+    tree.nodes[leaf].collider = colliderIndex;
+    tree.leaves[colliderIndex] = leaf;
+    if (tree.root == -1)
+    {
+        tree.root = leaf;
+        return;
+    }
+
+    int32_t sibling = tree.root;
+    while (tree.nodes[sibling].collider == -1)
+    {
+        BoundsTree::Node const& node = tree.nodes[sibling];
+        float const combined = SurfaceArea(glm::min(node.min, min), glm::max(node.max, max));
+        float const pairHere = 2.0f * combined;
+        float const inherited = 2.0f * (combined - SurfaceArea(node.min, node.max)); // this node grows either way
+
+        float descend[2];
+        for (int i = 0; i < 2; i++)
+        {
+            BoundsTree::Node const& child = tree.nodes[node.children[i]];
+            float const grown = SurfaceArea(glm::min(child.min, min), glm::max(child.max, max));
+            descend[i] = (child.collider != -1 ? grown : grown - SurfaceArea(child.min, child.max)) + inherited;
+        }
+        if (pairHere < descend[0] && pairHere < descend[1])
+            break;
+        sibling = node.children[descend[0] < descend[1] ? 0 : 1];
+    }
+
+    int32_t const oldParent = tree.nodes[sibling].parent;
+    int32_t const parent = AllocateNode();
+    tree.nodes[parent].parent = oldParent;
+    tree.nodes[parent].children[0] = sibling;
+    tree.nodes[parent].children[1] = leaf;
+    tree.nodes[sibling].parent = parent;
+    tree.nodes[leaf].parent = parent;
+    if (oldParent == -1)
+    {
+        tree.root = parent;
+    }
+    else
+    {
+        BoundsTree::Node& node = tree.nodes[oldParent];
+        node.children[node.children[0] == sibling ? 0 : 1] = parent;
+    }
+    RefitAncestors(parent);
+}
+
+//------------------------------------------------------------------------------
+/**
+    The leafs sibling takes the place of their parent.
+*/
+static void
+RemoveLeaf(int32_t colliderIndex)
+{
+    int32_t const leaf = tree.leaves[colliderIndex];
+    tree.leaves[colliderIndex] = -1;
+    tree.freeNodes.push_back(leaf);
+    if (leaf == tree.root)
+    {
+        tree.root = -1;
+        return;
+    }
+
+    int32_t const parent = tree.nodes[leaf].parent;
+    int32_t const sibling = tree.nodes[parent].children[tree.nodes[parent].children[0] == leaf ? 1 : 0];
+    int32_t const grandParent = tree.nodes[parent].parent;
+    tree.freeNodes.push_back(parent);
+    tree.nodes[sibling].parent = grandParent;
+    if (grandParent == -1)
+    {
+        tree.root = sibling;
+        return;
+    }
+    BoundsTree::Node& node = tree.nodes[grandParent];
+    node.children[node.children[0] == parent ? 0 : 1] = sibling;
+    RefitAncestors(grandParent);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Refits and inserts loosen the tree, after a few per leaf a rebuild is cheaper than the wasted traversal.
+*/
+static void
+CountTreeChange()
+{
+    if (++tree.changes > 4 * tree.leaves.size() + 64)
+        tree.dirty = true;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -201,9 +460,30 @@ CreateCollider(ColliderMeshId meshId, glm::mat4 const& transform, uint16_t mask,
         colliders.userData[id.index] = userData;
         colliders.masks[id.index] = mask;
     }
+
+    if (!tree.dirty)
+    {
+        tree.leaves.resize(colliders.active.size(), -1);
+        InsertLeaf(id.index);
+        CountTreeChange();
+    }
     return id;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+void
+DestroyCollider(ColliderId collider)
+{
+    assert(colliderPool.IsValid(collider));
+    if (!tree.dirty)
+        RemoveLeaf(collider.index);
+    colliders.active[collider.index] = false;
+    colliders.userData[collider.index] = nullptr;
+    colliderPool.Deallocate(collider);
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -224,6 +504,286 @@ SetTransform(ColliderId collider, glm::mat4 const& transform)
     PS.w = glm::length(transform[0]);
     colliders.positionsAndScales[collider.index] = PS;
     colliders.invTransforms[collider.index] = glm::inverse(transform);
+
+    if (!tree.dirty)
+    {
+        int32_t const leaf = tree.leaves[collider.index];
+        ColliderBounds(collider.index, tree.nodes[leaf].min, tree.nodes[leaf].max);
+        RefitAncestors(tree.nodes[leaf].parent);
+        CountTreeChange();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+IsWorldEmpty()
+{
+    return meshes.empty();
+}
+
+//------------------------------------------------------------------------------
+/**
+    Blob layout: WorldHeader, then per mesh its radius, triangle count and triangles,
+    then the collider arrays and the generations / free lists of both id pools.
+    Every section is a plain array so a restore is a handful of memcpys.
+*/
+struct WorldHeader
+{
+    uint32_t meshCount;
+    uint32_t colliderCount;
+    uint32_t freeMeshCount;
+    uint32_t freeColliderCount;
+};
+
+template<typename T> static void
+WriteArray(std::vector<uint8_t>& out, T const* data, size_t count)
+{
+    size_t const offset = out.size();
+    out.resize(offset + sizeof(T) * count);
+    if (count > 0)
+        memcpy(out.data() + offset, data, sizeof(T) * count);
+}
+
+template<typename T> static bool
+ReadArray(uint8_t const*& cursor, uint8_t const* end, T* data, size_t count)
+{
+    if (size_t(end - cursor) < sizeof(T) * count)
+        return false;
+    if (count > 0)
+        memcpy(data, cursor, sizeof(T) * count);
+    cursor += sizeof(T) * count;
+    return true;
+}
+
+template<typename ID_T> static std::vector<uint32_t>
+FreeList(Util::IdPool<ID_T> pool)
+{
+    std::vector<uint32_t> ids;
+    for (; !pool.freeIds.empty(); pool.freeIds.pop())
+        ids.push_back(pool.freeIds.front());
+    return ids;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SaveWorld(std::vector<uint8_t>& out)
+{
+    std::vector<uint32_t> const freeMeshes = FreeList(colliderMeshPool);
+    std::vector<uint32_t> const freeColliders = FreeList(colliderPool);
+
+    WorldHeader header;
+    header.meshCount = (uint32_t)meshes.size();
+    header.colliderCount = (uint32_t)colliders.active.size();
+    header.freeMeshCount = (uint32_t)freeMeshes.size();
+    header.freeColliderCount = (uint32_t)freeColliders.size();
+    WriteArray(out, &header, 1);
+
+    for (ColliderMesh const& mesh : meshes)
+    {
+        uint32_t const triCount = (uint32_t)mesh.tris.size();
+        WriteArray(out, &mesh.bSphereRadius, 1);
+        WriteArray(out, &triCount, 1);
+        WriteArray(out, mesh.tris.data(), mesh.tris.size());
+    }
+
+    std::vector<uint8_t> active(colliders.active.begin(), colliders.active.end());
+    std::vector<uint32_t> colliderMeshes;
+    for (ColliderMeshId const& id : colliders.meshes)
+        colliderMeshes.push_back((uint32_t)id);
+    WriteArray(out, active.data(), active.size());
+    WriteArray(out, colliders.masks.data(), colliders.masks.size());
+    WriteArray(out, colliders.positionsAndScales.data(), colliders.positionsAndScales.size());
+    WriteArray(out, colliders.invTransforms.data(), colliders.invTransforms.size());
+    WriteArray(out, colliderMeshes.data(), colliderMeshes.size());
+
+    WriteArray(out, colliderMeshPool.generations.data(), header.meshCount);
+    WriteArray(out, colliderPool.generations.data(), header.colliderCount);
+    WriteArray(out, freeMeshes.data(), freeMeshes.size());
+    WriteArray(out, freeColliders.data(), freeColliders.size());
+}
+
+//------------------------------------------------------------------------------
+/**
+    Everything is read into temporaries first, a truncated blob leaves the world untouched.
+*/
+bool
+RestoreWorld(uint8_t const* data, size_t size)
+{
+    uint8_t const* cursor = data;
+    uint8_t const* const end = data + size;
+
+    WorldHeader header;
+    if (!ReadArray(cursor, end, &header, 1))
+        return false;
+
+    std::vector<ColliderMesh> newMeshes(header.meshCount);
+    for (ColliderMesh& mesh : newMeshes)
+    {
+        uint32_t triCount = 0;
+        if (!ReadArray(cursor, end, &mesh.bSphereRadius, 1) || !ReadArray(cursor, end, &triCount, 1))
+            return false;
+        if (size_t(end - cursor) / sizeof(ColliderMesh::Triangle) < triCount)
+            return false;
+        mesh.tris.resize(triCount);
+        ReadArray(cursor, end, mesh.tris.data(), triCount);
+    }
+
+    size_t const count = header.colliderCount;
+    if (size_t(end - cursor) < count)
+        return false;
+    std::vector<uint8_t> active(count);
+    std::vector<uint32_t> colliderMeshes(count);
+    Colliders restored;
+    restored.masks.resize(count);
+    restored.positionsAndScales.resize(count);
+    restored.invTransforms.resize(count);
+    Util::IdPool<ColliderMeshId> meshPool;
+    Util::IdPool<ColliderId> pool;
+    meshPool.generations.resize(header.meshCount);
+    pool.generations.resize(count);
+    std::vector<uint32_t> freeMeshes(header.freeMeshCount);
+    std::vector<uint32_t> freeColliders(header.freeColliderCount);
+    if (!ReadArray(cursor, end, active.data(), count) ||
+        !ReadArray(cursor, end, restored.masks.data(), count) ||
+        !ReadArray(cursor, end, restored.positionsAndScales.data(), count) ||
+        !ReadArray(cursor, end, restored.invTransforms.data(), count) ||
+        !ReadArray(cursor, end, colliderMeshes.data(), count) ||
+        !ReadArray(cursor, end, meshPool.generations.data(), header.meshCount) ||
+        !ReadArray(cursor, end, pool.generations.data(), count) ||
+        !ReadArray(cursor, end, freeMeshes.data(), freeMeshes.size()) ||
+        !ReadArray(cursor, end, freeColliders.data(), freeColliders.size()))
+        return false;
+
+    restored.active.assign(active.begin(), active.end());
+    restored.userData.assign(count, nullptr);
+    for (uint32_t id : colliderMeshes)
+        restored.meshes.push_back(ColliderMeshId::Create(id));
+    for (uint32_t id : freeMeshes)
+        meshPool.freeIds.push(id);
+    for (uint32_t id : freeColliders)
+        pool.freeIds.push(id);
+
+    meshes = std::move(newMeshes);
+    colliders = std::move(restored);
+    colliderMeshPool = std::move(meshPool);
+    colliderPool = std::move(pool);
+    tree.dirty = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Bounding sphere and triangle test of one collider, keeps the closest hit in ret.
+*/
+static void
+RaycastCollider(int colliderIndex, glm::vec3 const& start, glm::vec3 const& dir, RaycastPayload& ret)
+{
+    ColliderMesh const* const mesh = &meshes[colliders.meshes[colliderIndex].index];
+    glm::vec3 bSphereCenter = colliders.positionsAndScales[colliderIndex];
+    float radius = mesh->bSphereRadius * colliders.positionsAndScales[colliderIndex][3];
+
+    // Coarse check against bounding sphere
+    {
+        glm::vec3 cDir = bSphereCenter - start;
+
+        float r2 = radius * radius;
+        float c2 = glm::dot(cDir, cDir);
+
+        if (c2 < r2)
+            goto CHECK_MESH; // ray starts within sphere
+
+        float d = glm::dot(cDir, dir);
+        if (d < 0.0f)
+            return; // ray is pointing away from sphere
+
+        float discr = d * d - (c2 - r2);
+
+        // A negative discriminant corresponds to ray missing sphere 
+        if (discr < 0.0f)
+            return;
+
+        // NOTE: this should be equivalent to this: (sqrtf(c2) - radius > ret.hitDistance)), but faster
+        if ((c2 > (ret.hitDistance * ret.hitDistance) + (2 * radius * ret.hitDistance) + r2))
+            return; // ray is too short
+    }
+
+CHECK_MESH:
+    // transform ray into modelspace
+    glm::mat4 const& invT = colliders.invTransforms[colliderIndex];
+    glm::vec3 invRayStart = invT * glm::vec4(start, 1.0f);
+    glm::vec3 invRayDir = invT * glm::vec4(dir, 0);
+
+    // fine check against mesh
+    int numTris = (int)mesh->tris.size();
+    for (int i = 0; i < numTris; ++i)
+    {
+        glm::vec3 const& N = mesh->tris[i].normal;
+
+        float NdotRayDirection = glm::dot(N, invRayDir);
+        if (NdotRayDirection < 0)
+            continue; // backfacing surface
+
+        glm::vec3 const& A = mesh->tris[i].vertices[0];
+        glm::vec3 const& B = mesh->tris[i].vertices[1];
+        glm::vec3 const& C = mesh->tris[i].vertices[2];
+
+        float d = -glm::dot(N, A);
+        float t = -(glm::dot(N, invRayStart) + d) / NdotRayDirection;
+
+        if (t < 0)
+            continue;  //the triangle is behind the ray
+
+        glm::vec3 P = invRayStart + invRayDir * t;
+
+        // check triangle bounds
+        glm::vec3 K;  //vector perpendicular to one of three subdivided triangles's plane 
+        glm::vec3 edge0 = B - A;
+        glm::vec3 vp0 = P - A;
+        K = glm::cross(vp0, edge0);
+        if (glm::dot(N, K) < 0)
+            continue;
+
+        glm::vec3 edge1 = C - B;
+        glm::vec3 vp1 = P - B;
+        K = glm::cross(vp1, edge1);
+        if (glm::dot(N, K) < 0)
+            continue;
+
+        glm::vec3 edge2 = A - C;
+        glm::vec3 vp2 = P - C;
+        K = glm::cross(vp2, edge2);
+        if (glm::dot(N, K) < 0)
+            continue;
+
+        // intersection with at least one triangle
+        if (ret.hitDistance >= t)
+        {
+            ret.hit = true;
+            ret.hitDistance = t;
+            ret.collider = ColliderId::Create(colliderIndex, colliderPool.generations[colliderIndex]);
+        }
+    }
+
+}
+
+//------------------------------------------------------------------------------
+/**
+    Slab test, enter is where the ray enters the box (0 when it starts inside).
+*/
+static bool
+RayEntersBox(glm::vec3 const& start, glm::vec3 const& invDir, float maxDistance, BoundsTree::Node const& node, float& enter)
+{
+    glm::vec3 const t0 = (node.min - start) * invDir;
+    glm::vec3 const t1 = (node.max - start) * invDir;
+    glm::vec3 const tNear = glm::min(t0, t1);
+    glm::vec3 const tFar = glm::max(t0, t1);
+    enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float const exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+    return enter <= exit;
 }
 
 //------------------------------------------------------------------------------
@@ -233,98 +793,66 @@ SetTransform(ColliderId collider, glm::mat4 const& transform)
 RaycastPayload
 Raycast(glm::vec3 start, glm::vec3 dir, float maxDistance, uint16_t mask)
 {
+    if (phys_bvh == nullptr)
+        phys_bvh = Core::CVarCreate(Core::CVar_Int, "phys_bvh", "1", "Raycasts walk the collider bounding volume tree (0 = test every collider)");
+
     RaycastPayload ret;
     ret.hitDistance = maxDistance;
-    // TODO: spatial acceleration instead of just checking everything...
-    int numColliders = (int)colliders.active.size();
-    for (int colliderIndex = 0; colliderIndex < numColliders; colliderIndex++)
+
+    if (Core::CVarReadInt(phys_bvh) == 0)
     {
-        if (colliders.active[colliderIndex] && (mask == 0 || (colliders.masks[colliderIndex] & mask) != 0))
+        int numColliders = (int)colliders.active.size();
+        for (int colliderIndex = 0; colliderIndex < numColliders; colliderIndex++)
         {
-            ColliderMesh const* const mesh = &meshes[colliders.meshes[colliderIndex].index];
-            glm::vec3 bSphereCenter = colliders.positionsAndScales[colliderIndex];
-            float radius = mesh->bSphereRadius * colliders.positionsAndScales[colliderIndex][3];
-
-            // Coarse check against bounding sphere
-            {
-                glm::vec3 cDir = bSphereCenter - start;
-
-                float r2 = radius * radius;
-                float c2 = glm::dot(cDir, cDir);
-
-                if (c2 < r2)
-                    goto CHECK_MESH; // ray starts within sphere
+            if (colliders.active[colliderIndex] && (mask == 0 || (colliders.masks[colliderIndex] & mask) != 0))
+                RaycastCollider(colliderIndex, start, dir, ret);
+        }
+    }
+    else
+    {
+        if (tree.dirty)
+            RebuildTree();
 
-                float d = glm::dot(cDir, dir);
-                if (d < 0.0f)
-                    continue; // ray is pointing away from sphere
+        // no zero components, 0 * inf would poison the slab test
+        glm::vec3 invDir;
+        for (int i = 0; i < 3; i++)
+            invDir[i] = 1.0f / (fabs(dir[i]) > 1e-20f ? dir[i] : 1e-20f);
 
-                float discr = d * d - (c2 - r2);
+        float enter;
+        tree.stack.clear();
+        if (tree.root != -1 && RayEntersBox(start, invDir, ret.hitDistance, tree.nodes[tree.root], enter))
+            tree.stack.push_back({ tree.root, enter });
 
-                // A negative discriminant corresponds to ray missing sphere 
-                if (discr < 0.0f)
-                    continue;
+        while (!tree.stack.empty())
+        {
+            BoundsTree::Visit const visit = tree.stack.back();
+            tree.stack.pop_back();
+            if (visit.enter > ret.hitDistance)
+                continue; // a closer hit was found since it was pushed
 
-                // NOTE: this should be equivalent to this: (sqrtf(c2) - radius > ret.hitDistance)), but faster
-                if ((c2 > (ret.hitDistance * ret.hitDistance) + (2 * radius * ret.hitDistance) + r2))
-                    continue; // ray is too short
+            BoundsTree::Node const& node = tree.nodes[visit.node];
+            if (node.collider != -1)
+            {
+                if (mask == 0 || (colliders.masks[node.collider] & mask) != 0)
+                    RaycastCollider(node.collider, start, dir, ret);
+                continue;
             }
 
-        CHECK_MESH:
-            // transform ray into modelspace
-            glm::mat4 const& invT = colliders.invTransforms[colliderIndex];
-            glm::vec3 invRayStart = invT * glm::vec4(start, 1.0f);
-            glm::vec3 invRayDir = invT * glm::vec4(dir, 0);
-
-            // fine check against mesh
-            int numTris = (int)mesh->tris.size();
-            for (int i = 0; i < numTris; ++i)
+            // the nearer child goes on top, its hits usually cull the other one
+            float enter0, enter1;
+            bool const hit0 = RayEntersBox(start, invDir, ret.hitDistance, tree.nodes[node.children[0]], enter0);
+            bool const hit1 = RayEntersBox(start, invDir, ret.hitDistance, tree.nodes[node.children[1]], enter1);
+            if (hit0 && hit1 && enter0 < enter1)
+            {
+                tree.stack.push_back({ node.children[1], enter1 });
+                tree.stack.push_back({ node.children[0], enter0 });
+            }
+            else
             {
-                glm::vec3 const& N = mesh->tris[i].normal;
-
-                float NdotRayDirection = glm::dot(N, invRayDir);
-                if (NdotRayDirection < 0)
-                    continue; // backfacing surface
-
-                glm::vec3 const& A = mesh->tris[i].vertices[0];
-                glm::vec3 const& B = mesh->tris[i].vertices[1];
-                glm::vec3 const& C = mesh->tris[i].vertices[2];
-
-                float d = -glm::dot(N, A);
-                float t = -(glm::dot(N, invRayStart) + d) / NdotRayDirection;
-
-                if (t < 0)
-                    continue;  //the triangle is behind the ray
-
-                glm::vec3 P = invRayStart + invRayDir * t;
-
-                // check triangle bounds
-                glm::vec3 K;  //vector perpendicular to one of three subdivided triangles's plane 
-                glm::vec3 edge0 = B - A;
-                glm::vec3 vp0 = P - A;
-                K = glm::cross(vp0, edge0);
-                if (glm::dot(N, K) < 0)
-                    continue;
-
-                glm::vec3 edge1 = C - B;
-                glm::vec3 vp1 = P - B;
-                K = glm::cross(vp1, edge1);
-                if (glm::dot(N, K) < 0)
-                    continue;
-
-                glm::vec3 edge2 = A - C;
-                glm::vec3 vp2 = P - C;
-                K = glm::cross(vp2, edge2);
-                if (glm::dot(N, K) < 0)
-                    continue;
-
-                // intersection with at least one triangle
-                if (ret.hitDistance >= t)
-                {
-                    ret.hit = true;
-                    ret.hitDistance = t;
-                    ret.collider = ColliderId::Create(colliderIndex, colliderPool.generations[colliderIndex]);
-                }
+                if (hit0)
+                    tree.stack.push_back({ node.children[0], enter0 });
+                if (hit1)
+                    tree.stack.push_back({ node.children[1], enter1 });
             }
         }
     }
@@ -8,6 +8,8 @@
 */
 //------------------------------------------------------------------------------
 #include <string>
+#include <vector>
+#include <cstdint>
 
 namespace Physics
 {
@@ -91,8 +93,20 @@ RaycastPayload Raycast(glm::vec3 start, glm::vec3 dir, float maxDistance, uint16
 
 ColliderId CreateCollider(ColliderMeshId meshId, glm::mat4 const& transform, uint16_t mask = 0, void* userData = nullptr);
 
+/// removes the collider from the world, its id becomes invalid
+void DestroyCollider(ColliderId collider);
+
 ColliderMeshId LoadColliderMesh(std::string path);
 
 void SetTransform(ColliderId collider, glm::mat4 const& transform);
 
+/// true while no collider mesh has been loaded
+bool IsWorldEmpty();
+
+/// appends every collider mesh and collider as one flat blob (user data pointers are not kept)
+void SaveWorld(std::vector<uint8_t>& out);
+
+/// replaces the world with a blob from SaveWorld, every id handed out before the save is valid again
+bool RestoreWorld(uint8_t const* data, size_t size);
+
 } // namespace Physics
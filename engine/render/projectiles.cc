@@ -0,0 +1,126 @@
+//------------------------------------------------------------------------------
+//  projectiles.cc
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "projectiles.h"
+#include "shaderresource.h"
+
+namespace Render
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ProjectileRenderer::Initialize()
+{
+    auto vs = Render::ShaderResource::LoadShader(Render::ShaderResource::ShaderType::VERTEXSHADER, "shd/vs_projectiles.glsl");
+    auto fs = Render::ShaderResource::LoadShader(Render::ShaderResource::ShaderType::FRAGMENTSHADER, "shd/fs_projectiles.glsl");
+    this->projectileShaderId = Render::ShaderResource::CompileShaderProgram({ vs, fs });
+    glGenBuffers(1, &this->instanceBuffer);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ProjectileRenderer::Set(uint32_t key, ProjectileInstance const& instance)
+{
+    auto found = this->indices.find(key);
+    if (found == this->indices.end())
+    {
+        found = this->indices.emplace(key, uint32_t(this->instances.size())).first;
+        this->instances.push_back(instance);
+        this->keys.push_back(key);
+    }
+    else
+    {
+        this->instances[found->second] = instance;
+    }
+    this->MarkDirty(found->second);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ProjectileRenderer::Remove(uint32_t key)
+{
+    auto found = this->indices.find(key);
+    if (found == this->indices.end())
+        return;
+
+    // Move the last instance into the hole
+    const uint32_t index = found->second;
+    const uint32_t last = uint32_t(this->instances.size() - 1);
+    this->indices.erase(found);
+    if (index != last)
+    {
+        this->instances[index] = this->instances[last];
+        this->keys[index] = this->keys[last];
+        this->indices[this->keys[index]] = index;
+        this->MarkDirty(index);
+    }
+    this->instances.pop_back();
+    this->keys.pop_back();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ProjectileRenderer::Clear()
+{
+    this->instances.clear();
+    this->keys.clear();
+    this->indices.clear();
+    this->dirtyBegin = this->dirtyEnd = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ProjectileRenderer::MarkDirty(size_t index)
+{
+    if (this->dirtyBegin == this->dirtyEnd)
+    {
+        this->dirtyBegin = index;
+        this->dirtyEnd = index + 1;
+        return;
+    }
+    this->dirtyBegin = glm::min(this->dirtyBegin, index);
+    this->dirtyEnd = glm::max(this->dirtyEnd, index + 1);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Called by the render device before drawing, only the instances changed since
+    the last frame are written (the whole buffer when it has to grow)
+*/
+void
+ProjectileRenderer::Upload()
+{
+    const size_t count = this->instances.size();
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->instanceBuffer);
+    if (count > this->capacity)
+    {
+        this->capacity = glm::max<size_t>(count * 2, 256);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, this->capacity * sizeof(ProjectileInstance), nullptr, GL_DYNAMIC_DRAW);
+        this->dirtyBegin = 0;
+        this->dirtyEnd = count;
+    }
+
+    this->dirtyEnd = glm::min(this->dirtyEnd, count);
+    if (this->dirtyBegin < this->dirtyEnd)
+    {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+            this->dirtyBegin * sizeof(ProjectileInstance),
+            (this->dirtyEnd - this->dirtyBegin) * sizeof(ProjectileInstance),
+            &this->instances[this->dirtyBegin]);
+    }
+    this->dirtyBegin = this->dirtyEnd = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+} // namespace Render
@@ -0,0 +1,85 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    Render::ProjectileRenderer
+
+    Straight flying projectiles (lasers) drawn with one instanced call per mesh
+    primitive. Only the flight path is stored on the GPU (origin, velocity per
+    tick, start / end tick), the vertex shader places every instance from the
+    current tick, so nothing is touched per projectile and frame on the CPU.
+    The buffer is only written when projectiles are added or removed.
+*/
+//------------------------------------------------------------------------------
+#include <vector>
+#include <unordered_map>
+#include "resourceid.h"
+#include "renderdevice.h"
+#include <gl/glew.h>
+
+namespace Render
+{
+
+// std430 layout, matches ProjectileBuffer in shd/vs_projectiles.glsl
+struct ProjectileInstance
+{
+    glm::vec3 origin = glm::vec3(0); // position at startTick
+    uint32_t startTick = 0;
+    glm::vec3 velocity = glm::vec3(0); // units per tick, the mesh +Z axis is turned along it
+    uint32_t endTick = 0; // hidden from this tick on
+};
+
+class ProjectileRenderer
+{
+public:
+    ProjectileRenderer() = default;
+    static ProjectileRenderer* Instance()
+    {
+        static ProjectileRenderer instance;
+        return &instance;
+    }
+public:
+    ProjectileRenderer(const ProjectileRenderer&) = delete;
+    void operator=(const ProjectileRenderer&) = delete;
+
+    void Initialize();
+
+    void SetModel(ModelId model) { this->model = model; this->hasModel = true; }
+    void SetColor(glm::vec4 const& color) { this->color = color; }
+
+    // Adds or replaces the projectile with this key (swap remove keeps the instances dense)
+    void Set(uint32_t key, ProjectileInstance const& instance);
+    void Remove(uint32_t key);
+    void Clear();
+    size_t Count() const { return this->instances.size(); }
+
+    // Time the shader places the projectiles at (fraction = part of the next tick already elapsed)
+    void SetTime(uint32_t tick, float fraction)
+    {
+        this->tick = tick;
+        this->tickFraction = fraction;
+    }
+
+private:
+    friend class RenderDevice;
+    void MarkDirty(size_t index);
+    void Upload();
+
+    std::vector<ProjectileInstance> instances;
+    std::vector<uint32_t> keys; // key of every instance
+    std::unordered_map<uint32_t, uint32_t> indices; // key -> instance
+
+    size_t dirtyBegin = 0; // instances changed since the last upload
+    size_t dirtyEnd = 0;
+    size_t capacity = 0; // instances the GPU buffer holds
+
+    ModelId model = 0;
+    bool hasModel = false;
+    glm::vec4 color = glm::vec4(0.3f, 0.6f, 4.0f, 1.0f);
+    uint32_t tick = 0;
+    float tickFraction = 0.0f;
+
+    Render::ShaderProgramId projectileShaderId;
+    GLuint instanceBuffer = 0;
+};
+
+} // namespace Render
@@ -15,6 +15,7 @@
 #include "core/cvar.h"
 #include "core/random.h"
 #include "particlesystem.h"
+#include "projectiles.h"
 
 namespace Render
 {
@@ -144,6 +145,7 @@ void RenderDevice::Init()
     glBindTexture(GL_TEXTURE_2D, 0);
 
     ParticleSystem::Instance()->Initialize();
+    ProjectileRenderer::Instance()->Initialize();
 
     Debug::InitDebugRendering();
 }
@@ -413,6 +415,44 @@ RenderDevice::SkyboxPass()
     glDepthFunc(GL_LESS);
 }
 
+//------------------------------------------------------------------------------
+/**
+    Every projectile of a mesh primitive in one instanced draw, positioned in the vertex shader
+*/
+void
+RenderDevice::ProjectilePass()
+{
+    ProjectileRenderer* projectiles = ProjectileRenderer::Instance();
+    if (!projectiles->hasModel)
+        return;
+    projectiles->Upload();
+    if (projectiles->instances.empty())
+        return;
+
+    Camera const* const mainCamera = CameraManager::GetCamera(CAMERA_MAIN);
+    GLuint programHandle = ShaderResource::GetProgramHandle(projectiles->projectileShaderId);
+    glUseProgram(programHandle);
+    glUniformMatrix4fv(glGetUniformLocation(programHandle, "ViewProjection"), 1, false, &mainCamera->viewProjection[0][0]);
+    glUniform1ui(glGetUniformLocation(programHandle, "Tick"), projectiles->tick);
+    glUniform1f(glGetUniformLocation(programHandle, "TickFraction"), projectiles->tickFraction);
+    glUniform4fv(glGetUniformLocation(programHandle, "Color"), 1, &projectiles->color[0]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, projectiles->instanceBuffer);
+
+    const GLsizei count = GLsizei(projectiles->instances.size());
+    Model const& model = GetModel(projectiles->model);
+    for (auto const& mesh : model.meshes)
+    {
+        for (auto& primitiveId : mesh.opaquePrimitives)
+        {
+            auto& primitive = mesh.primitives[primitiveId];
+            glBindVertexArray(primitive.vao);
+            glDrawElementsInstanced(GL_TRIANGLES, primitive.numIndices, primitive.indexType, (void*)(intptr_t)primitive.offset, count);
+        }
+    }
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -540,6 +580,7 @@ RenderDevice::Render(Display::Window* wnd, float dt)
     glViewport(0, 0, w, h);
 
     Instance()->StaticForwardPass();
+    Instance()->ProjectilePass();
     
     if (Instance()->skybox != InvalidResourceId)
     {
@@ -71,6 +71,7 @@ private:
     void StaticGeometryPrepass();
     void StaticForwardPass();
     void SkyboxPass();
+    void ProjectilePass();
     void ParticlePass(float dt);
     void FinalizePass(Display::Window* wnd);
 
@@ -27,6 +27,19 @@
 */
 ENetHost *
 enet_host_create (const ENetAddress * address, size_t peerCount, size_t channelLimit, enet_uint32 incomingBandwidth, enet_uint32 outgoingBandwidth)
+{
+    return enet_host_create_shared (address, peerCount, channelLimit, incomingBandwidth, outgoingBandwidth, 0);
+}
+
+/** Creates a host like enet_host_create, optionally on a port other hosts may bind as well.
+
+    @param shared if nonzero, the socket is given ENET_SOCKOPT_REUSEPORT before it is bound, so several
+    hosts (one per thread) can listen on the same address and the kernel spreads the remote peers among them
+
+    @returns the host on success and NULL on failure (also when the platform has no SO_REUSEPORT)
+*/
+ENetHost *
+enet_host_create_shared (const ENetAddress * address, size_t peerCount, size_t channelLimit, enet_uint32 incomingBandwidth, enet_uint32 outgoingBandwidth, int shared)
 {
     ENetHost * host;
     ENetPeer * currentPeer;
@@ -49,7 +62,9 @@ enet_host_create (const ENetAddress * address, size_t peerCount, size_t channelL
     memset (host -> peers, 0, peerCount * sizeof (ENetPeer));
 
     host -> socket = enet_socket_create (ENET_SOCKET_TYPE_DATAGRAM);
-    if (host -> socket == ENET_SOCKET_NULL || (address != NULL && enet_socket_bind (host -> socket, address) < 0))
+    if (host -> socket == ENET_SOCKET_NULL ||
+        (shared && enet_socket_set_option (host -> socket, ENET_SOCKOPT_REUSEPORT, 1) < 0) ||
+        (address != NULL && enet_socket_bind (host -> socket, address) < 0))
     {
        if (host -> socket != ENET_SOCKET_NULL)
          enet_socket_destroy (host -> socket);
@@ -110,6 +125,11 @@ enet_host_create (const ENetAddress * address, size_t peerCount, size_t channelL
 
     host -> intercept = NULL;
 
+    host -> socketBatch = NULL;
+#ifdef ENET_BATCHED_IO
+    host -> socketBatch = enet_socket_batch_create (); /* NULL falls back to one syscall per datagram */
+#endif
+
     enet_list_clear (& host -> dispatchQueue);
 
     for (currentPeer = host -> peers;
@@ -156,6 +176,11 @@ enet_host_destroy (ENetHost * host)
     if (host -> compressor.context != NULL && host -> compressor.destroy)
       (* host -> compressor.destroy) (host -> compressor.context);
 
+#ifdef ENET_BATCHED_IO
+    if (host -> socketBatch != NULL)
+      enet_socket_batch_destroy (host -> socketBatch);
+#endif
+
     enet_free (host -> peers);
     enet_free (host);
 }
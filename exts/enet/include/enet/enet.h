@@ -62,7 +62,8 @@ typedef enum _ENetSocketOption
    ENET_SOCKOPT_RCVTIMEO  = 6,
    ENET_SOCKOPT_SNDTIMEO  = 7,
    ENET_SOCKOPT_ERROR     = 8,
-   ENET_SOCKOPT_NODELAY   = 9
+   ENET_SOCKOPT_NODELAY   = 9,
+   ENET_SOCKOPT_REUSEPORT = 10
 } ENetSocketOption;
 
 typedef enum _ENetSocketShutdown
@@ -398,6 +399,7 @@ typedef struct _ENetHost
    size_t               duplicatePeers;              /**< optional number of allowed peers from duplicate IPs, defaults to ENET_PROTOCOL_MAXIMUM_PEER_ID */
    size_t               maximumPacketSize;           /**< the maximum allowable packet size that may be sent or received on a peer */
    size_t               maximumWaitingData;          /**< the maximum aggregate amount of buffer space a peer may use waiting for packets to be delivered */
+   struct _ENetSocketBatch * socketBatch;            /**< batched datagram I/O state (ENET_BATCHED_IO builds), NULL when datagrams go one syscall each */
 } ENetHost;
 
 /**
@@ -509,6 +511,32 @@ ENET_API int        enet_socket_shutdown (ENetSocket, ENetSocketShutdown);
 ENET_API void       enet_socket_destroy (ENetSocket);
 ENET_API int        enet_socketset_select (ENetSocket, ENetSocketSet *, ENetSocketSet *, enet_uint32);
 
+#ifdef ENET_BATCHED_IO
+/* Linux only: datagrams are received with one recvmmsg and sent with one sendmmsg per batch,
+   consecutive equal sized datagrams to the same peer additionally go out as one UDP GSO send. */
+#define ENET_SOCKET_BATCH_SIZE 32
+
+typedef struct _ENetSocketBatch
+{
+   size_t        receiveCount;
+   size_t        receiveNext;
+   ENetAddress   receiveAddresses [ENET_SOCKET_BATCH_SIZE];
+   int           receiveLengths [ENET_SOCKET_BATCH_SIZE];
+   enet_uint8    receiveData [ENET_SOCKET_BATCH_SIZE][ENET_PROTOCOL_MAXIMUM_MTU];
+   size_t        sendCount;
+   ENetAddress   sendAddresses [ENET_SOCKET_BATCH_SIZE];
+   size_t        sendLengths [ENET_SOCKET_BATCH_SIZE];
+   enet_uint8    sendData [ENET_SOCKET_BATCH_SIZE][ENET_PROTOCOL_MAXIMUM_MTU];
+   int           segmentation;   /**< 1 while the kernel accepts UDP_SEGMENT (GSO) sends */
+} ENetSocketBatch;
+
+ENET_API ENetSocketBatch * enet_socket_batch_create (void);
+ENET_API void       enet_socket_batch_destroy (ENetSocketBatch *);
+ENET_API int        enet_socket_receive_batch (ENetSocket, ENetSocketBatch *);
+ENET_API int        enet_socket_queue_batch (ENetSocket, ENetSocketBatch *, const ENetAddress *, const ENetBuffer *, size_t);
+ENET_API int        enet_socket_send_batch (ENetSocket, ENetSocketBatch *);
+#endif
+
 /** @} */
 
 /** @defgroup Address ENet address functions
@@ -563,6 +591,7 @@ ENET_API int          enet_packet_resize  (ENetPacket *, size_t);
 ENET_API enet_uint32  enet_crc32 (const ENetBuffer *, size_t);
                 
 ENET_API ENetHost * enet_host_create (const ENetAddress *, size_t, size_t, enet_uint32, enet_uint32);
+ENET_API ENetHost * enet_host_create_shared (const ENetAddress *, size_t, size_t, enet_uint32, enet_uint32, int);
 ENET_API void       enet_host_destroy (ENetHost *);
 ENET_API ENetPeer * enet_host_connect (ENetHost *, const ENetAddress *, size_t, enet_uint32);
 ENET_API int        enet_host_check_events (ENetHost *, ENetEvent *);
@@ -1213,6 +1213,28 @@ commandError:
     return 0;
 }
  
+#ifdef ENET_BATCHED_IO
+/* Hands out the next datagram of the current batch, refills the batch with one recvmmsg when it ran dry.
+   Datagrams left over when an event returns early stay in the batch for the next service call. */
+static int
+enet_protocol_receive_batched (ENetHost * host)
+{
+    ENetSocketBatch * batch = host -> socketBatch;
+
+    if (batch -> receiveNext >= batch -> receiveCount)
+    {
+       int received = enet_socket_receive_batch (host -> socket, batch);
+       if (received <= 0)
+         return received;
+    }
+
+    host -> receivedAddress = batch -> receiveAddresses [batch -> receiveNext];
+    host -> receivedData = batch -> receiveData [batch -> receiveNext];
+
+    return batch -> receiveLengths [batch -> receiveNext ++];
+}
+#endif
+
 static int
 enet_protocol_receive_incoming_commands (ENetHost * host, ENetEvent * event)
 {
@@ -1223,13 +1245,22 @@ enet_protocol_receive_incoming_commands (ENetHost * host, ENetEvent * event)
        int receivedLength;
        ENetBuffer buffer;
 
-       buffer.data = host -> packetData [0];
-       buffer.dataLength = sizeof (host -> packetData [0]);
+#ifdef ENET_BATCHED_IO
+       if (host -> socketBatch != NULL)
+         receivedLength = enet_protocol_receive_batched (host);
+       else
+#endif
+       {
+          buffer.data = host -> packetData [0];
+          buffer.dataLength = sizeof (host -> packetData [0]);
+
+          receivedLength = enet_socket_receive (host -> socket,
+                                                & host -> receivedAddress,
+                                                & buffer,
+                                                1);
 
-       receivedLength = enet_socket_receive (host -> socket,
-                                             & host -> receivedAddress,
-                                             & buffer,
-                                             1);
+          host -> receivedData = host -> packetData [0];
+       }
 
        if (receivedLength < 0)
          return -1;
@@ -1237,7 +1268,6 @@ enet_protocol_receive_incoming_commands (ENetHost * host, ENetEvent * event)
        if (receivedLength == 0)
          return 0;
 
-       host -> receivedData = host -> packetData [0];
        host -> receivedDataLength = receivedLength;
       
        host -> totalReceivedData += receivedLength;
@@ -1565,7 +1595,7 @@ enet_protocol_check_outgoing_commands (ENetHost * host, ENetPeer * peer)
 }
 
 static int
-enet_protocol_send_outgoing_commands (ENetHost * host, ENetEvent * event, int checkForTimeouts)
+enet_protocol_queue_outgoing_commands (ENetHost * host, ENetEvent * event, int checkForTimeouts)
 {
     enet_uint8 headerData [sizeof (ENetProtocolHeader) + sizeof (enet_uint32)];
     ENetProtocolHeader * header = (ENetProtocolHeader *) headerData;
@@ -1686,6 +1716,11 @@ enet_protocol_send_outgoing_commands (ENetHost * host, ENetEvent * event, int ch
 
         currentPeer -> lastSendTime = host -> serviceTime;
 
+#ifdef ENET_BATCHED_IO
+        if (host -> socketBatch != NULL)
+          sentLength = enet_socket_queue_batch (host -> socket, host -> socketBatch, & currentPeer -> address, host -> buffers, host -> bufferCount);
+        else
+#endif
         sentLength = enet_socket_send (host -> socket, & currentPeer -> address, host -> buffers, host -> bufferCount);
 
         enet_protocol_remove_sent_unreliable_commands (currentPeer);
@@ -1700,6 +1735,21 @@ enet_protocol_send_outgoing_commands (ENetHost * host, ENetEvent * event, int ch
     return 0;
 }
 
+static int
+enet_protocol_send_outgoing_commands (ENetHost * host, ENetEvent * event, int checkForTimeouts)
+{
+    int result = enet_protocol_queue_outgoing_commands (host, event, checkForTimeouts);
+
+#ifdef ENET_BATCHED_IO
+    /* Also on the early return of a timeout event, everything queued so far goes out in one sendmmsg */
+    if (host -> socketBatch != NULL &&
+        enet_socket_send_batch (host -> socket, host -> socketBatch) < 0)
+      return -1;
+#endif
+
+    return result;
+}
+
 /** Sends any queued packets on the host specified to its designated peers.
 
     @param host   host to flush
@@ -1855,6 +1905,17 @@ enet_host_service (ENetHost * host, ENetEvent * event, enet_uint32 timeout)
        if (ENET_TIME_GREATER_EQUAL (host -> serviceTime, timeout))
          return 0;
 
+#ifdef ENET_BATCHED_IO
+       /* Datagrams still waiting in the batch would not wake the socket wait below */
+       if (host -> socketBatch != NULL &&
+           host -> socketBatch -> receiveNext < host -> socketBatch -> receiveCount)
+       {
+          host -> serviceTime = enet_time_get ();
+          waitCondition = ENET_SOCKET_WAIT_RECEIVE;
+          continue;
+       }
+#endif
+
        do
        {
           host -> serviceTime = enet_time_get ();
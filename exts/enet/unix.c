@@ -4,6 +4,10 @@
 */
 #ifndef _WIN32
 
+#if defined(ENET_BATCHED_IO) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* recvmmsg / sendmmsg */
+#endif
+
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
@@ -348,6 +352,12 @@ enet_socket_set_option (ENetSocket socket, ENetSocketOption option, int value)
             result = setsockopt (socket, IPPROTO_TCP, TCP_NODELAY, (char *) & value, sizeof (int));
             break;
 
+        case ENET_SOCKOPT_REUSEPORT:
+#ifdef SO_REUSEPORT
+            result = setsockopt (socket, SOL_SOCKET, SO_REUSEPORT, (char *) & value, sizeof (int));
+#endif
+            break;
+
         default:
             break;
     }
@@ -512,6 +522,216 @@ enet_socket_receive (ENetSocket socket,
     return recvLength;
 }
 
+#ifdef ENET_BATCHED_IO
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <stdint.h>
+
+#if defined(UDP_SEGMENT) && !defined(UDP_MAX_SEGMENTS)
+#define UDP_MAX_SEGMENTS 64
+#endif
+
+ENetSocketBatch *
+enet_socket_batch_create (void)
+{
+    ENetSocketBatch * batch = (ENetSocketBatch *) enet_malloc (sizeof (ENetSocketBatch));
+    if (batch == NULL)
+      return NULL;
+
+    batch -> receiveCount = 0;
+    batch -> receiveNext = 0;
+    batch -> sendCount = 0;
+#ifdef UDP_SEGMENT
+    batch -> segmentation = 1;
+#else
+    batch -> segmentation = 0;
+#endif
+    return batch;
+}
+
+void
+enet_socket_batch_destroy (ENetSocketBatch * batch)
+{
+    enet_free (batch);
+}
+
+int
+enet_socket_receive_batch (ENetSocket socket, ENetSocketBatch * batch)
+{
+    struct mmsghdr msgs [ENET_SOCKET_BATCH_SIZE];
+    struct iovec iovs [ENET_SOCKET_BATCH_SIZE];
+    struct sockaddr_in names [ENET_SOCKET_BATCH_SIZE];
+    int received, i;
+
+    memset (msgs, 0, sizeof (msgs));
+    for (i = 0; i < ENET_SOCKET_BATCH_SIZE; ++ i)
+    {
+        iovs [i].iov_base = batch -> receiveData [i];
+        iovs [i].iov_len = sizeof (batch -> receiveData [i]);
+        msgs [i].msg_hdr.msg_name = & names [i];
+        msgs [i].msg_hdr.msg_namelen = sizeof (struct sockaddr_in);
+        msgs [i].msg_hdr.msg_iov = & iovs [i];
+        msgs [i].msg_hdr.msg_iovlen = 1;
+    }
+
+    batch -> receiveCount = 0;
+    batch -> receiveNext = 0;
+
+    received = recvmmsg (socket, msgs, ENET_SOCKET_BATCH_SIZE, MSG_DONTWAIT, NULL);
+    if (received == -1)
+    {
+       if (errno == EWOULDBLOCK)
+         return 0;
+
+       return -1;
+    }
+
+    for (i = 0; i < received; ++ i)
+    {
+        /* Same as enet_socket_receive: a truncated datagram is an error once it is handed out */
+        batch -> receiveLengths [i] = (msgs [i].msg_hdr.msg_flags & MSG_TRUNC) ? -1 : (int) msgs [i].msg_len;
+        batch -> receiveAddresses [i].host = (enet_uint32) names [i].sin_addr.s_addr;
+        batch -> receiveAddresses [i].port = ENET_NET_TO_HOST_16 (names [i].sin_port);
+    }
+
+    batch -> receiveCount = (size_t) received;
+    return received;
+}
+
+int
+enet_socket_queue_batch (ENetSocket socket, ENetSocketBatch * batch, const ENetAddress * address, const ENetBuffer * buffers, size_t bufferCount)
+{
+    size_t length = 0;
+    enet_uint8 * data;
+
+    if (batch -> sendCount >= ENET_SOCKET_BATCH_SIZE &&
+        enet_socket_send_batch (socket, batch) < 0)
+      return -1;
+
+    /* Copied, the buffers point at per datagram scratch space and packets that may be freed right after */
+    data = batch -> sendData [batch -> sendCount];
+    for (; bufferCount > 0; -- bufferCount, ++ buffers)
+    {
+        if (length + buffers -> dataLength > sizeof (batch -> sendData [0]))
+          return -1;
+
+        memcpy (data + length, buffers -> data, buffers -> dataLength);
+        length += buffers -> dataLength;
+    }
+
+    batch -> sendAddresses [batch -> sendCount] = * address;
+    batch -> sendLengths [batch -> sendCount] = length;
+    ++ batch -> sendCount;
+
+    return (int) length;
+}
+
+int
+enet_socket_send_batch (ENetSocket socket, ENetSocketBatch * batch)
+{
+    struct mmsghdr msgs [ENET_SOCKET_BATCH_SIZE];
+    struct iovec iovs [ENET_SOCKET_BATCH_SIZE];
+    struct sockaddr_in names [ENET_SOCKET_BATCH_SIZE];
+    size_t firsts [ENET_SOCKET_BATCH_SIZE];
+#ifdef UDP_SEGMENT
+    union
+    {
+        char buffer [CMSG_SPACE (sizeof (uint16_t))];
+        struct cmsghdr align;
+    } controls [ENET_SOCKET_BATCH_SIZE];
+#endif
+    size_t next = 0;
+
+    while (next < batch -> sendCount)
+    {
+        size_t msgCount = 0, current = next;
+        int segmented = 0, sent;
+
+        memset (msgs, 0, sizeof (msgs));
+        while (current < batch -> sendCount)
+        {
+            const ENetAddress * address = & batch -> sendAddresses [current];
+            size_t segments = 1, segmentSize = batch -> sendLengths [current], total = segmentSize, i;
+            struct msghdr * msg = & msgs [msgCount].msg_hdr;
+
+#ifdef UDP_SEGMENT
+            /* GSO: every segment but the last has the size of the first, all go to the same peer */
+            if (batch -> segmentation)
+            {
+                while (current + segments < batch -> sendCount &&
+                       segments < UDP_MAX_SEGMENTS &&
+                       batch -> sendLengths [current + segments - 1] == segmentSize &&
+                       batch -> sendLengths [current + segments] <= segmentSize &&
+                       total + batch -> sendLengths [current + segments] <= 65000 &&
+                       batch -> sendAddresses [current + segments].host == address -> host &&
+                       batch -> sendAddresses [current + segments].port == address -> port)
+                {
+                    total += batch -> sendLengths [current + segments];
+                    ++ segments;
+                }
+            }
+#endif
+
+            for (i = current; i < current + segments; ++ i)
+            {
+                iovs [i].iov_base = batch -> sendData [i];
+                iovs [i].iov_len = batch -> sendLengths [i];
+            }
+
+            memset (& names [msgCount], 0, sizeof (struct sockaddr_in));
+            names [msgCount].sin_family = AF_INET;
+            names [msgCount].sin_port = ENET_HOST_TO_NET_16 (address -> port);
+            names [msgCount].sin_addr.s_addr = address -> host;
+
+            msg -> msg_name = & names [msgCount];
+            msg -> msg_namelen = sizeof (struct sockaddr_in);
+            msg -> msg_iov = & iovs [current];
+            msg -> msg_iovlen = segments;
+
+#ifdef UDP_SEGMENT
+            if (segments > 1)
+            {
+                struct cmsghdr * cmsg;
+
+                msg -> msg_control = controls [msgCount].buffer;
+                msg -> msg_controllen = sizeof (controls [msgCount].buffer);
+                cmsg = CMSG_FIRSTHDR (msg);
+                cmsg -> cmsg_level = IPPROTO_UDP;
+                cmsg -> cmsg_type = UDP_SEGMENT;
+                cmsg -> cmsg_len = CMSG_LEN (sizeof (uint16_t));
+                * (uint16_t *) CMSG_DATA (cmsg) = (uint16_t) segmentSize;
+                segmented = 1;
+            }
+#endif
+
+            firsts [msgCount ++] = current;
+            current += segments;
+        }
+
+        sent = sendmmsg (socket, msgs, msgCount, MSG_NOSIGNAL);
+        if (sent == -1)
+        {
+           if (errno == EWOULDBLOCK)
+             break; /* Dropped like a full send buffer in enet_socket_send, reliable data is resent */
+
+           if (segmented && (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT || errno == EOPNOTSUPP))
+           {
+              batch -> segmentation = 0; /* Kernel or route without GSO, plain batches from now on */
+              continue;
+           }
+
+           batch -> sendCount = 0;
+           return -1;
+        }
+
+        next = (size_t) sent < msgCount ? firsts [sent] : current;
+    }
+
+    batch -> sendCount = 0;
+    return 0;
+}
+#endif
+
 int
 enet_socketset_select (ENetSocket maxSocket, ENetSocketSet * readSet, ENetSocketSet * writeSet, enet_uint32 timeout)
 {
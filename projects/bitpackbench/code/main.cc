@@ -0,0 +1,181 @@
+//------------------------------------------------------------------------------
+// main.cc
+// Bytes per message and encode / decode time of the two wire formats, for the messages
+// sent every tick: UpdatePlayerS2C (FlatBuffers) against Replication::ShipUpdateS2C (bit packed,
+// every field and only the dirty ones) and InputC2S against BitPack::InputC2S
+// (bitpackbench [messages = 200000])
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "network/network.h"
+#include "network/replication.h"
+#include "network/timer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+static double
+ElapsedNs(std::chrono::steady_clock::time_point start)
+{
+	return double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+using Message = std::vector<uint8_t>;
+
+struct Result
+{
+	double bytes = 0, encodeNs = 0, decodeNs = 0;
+};
+
+static void
+Print(const char* name, const Result& result, size_t count)
+{
+	std::cout << "  " << name << ": " << result.bytes / double(count) << " bytes, encode " << result.encodeNs / double(count)
+		<< " ns, decode " << result.decodeNs / double(count) << " ns\n";
+}
+
+//A ship banking through the field, one state per server tick
+static Replication::ShipState
+ShipAt(uint32_t tick)
+{
+	const float t = float(tick) * Tick::Seconds;
+	Replication::ShipState state;
+	state.intervalMs = 16;
+	state.position = glm::vec3(std::sin(t * 0.3f) * 200.0f, std::cos(t * 0.2f) * 50.0f, t * 4.0f - 500.0f);
+	state.velocity = glm::vec3(std::cos(t * 0.3f) * 60.0f, -std::sin(t * 0.2f) * 10.0f, 4.0f);
+	state.orientation = glm::normalize(glm::quat(glm::vec3(std::sin(t) * 0.5f, t * 0.3f, std::cos(t * 0.7f) * 0.2f)));
+	return state;
+}
+
+static Player
+PlayerOf(uint32_t uuid, const Replication::ShipState& state)
+{
+	return Player(uuid, Vec3(state.position.x, state.position.y, state.position.z), Vec3(state.velocity.x, state.velocity.y, state.velocity.z), Vec3(),
+		Vec4(state.orientation.x, state.orientation.y, state.orientation.z, state.orientation.w));
+}
+
+int
+main(int argc, const char** argv)
+{
+	const size_t count = argc > 1 ? size_t(std::max(1, std::atoi(argv[1]))) : 200000;
+	const uint32_t uuid = 7;
+	std::vector<Replication::ShipState> states(count);
+	std::vector<uint16_t> bitmaps(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		states[i] = ShipAt(uint32_t(i));
+		bitmaps[i] = uint16_t((i / 23) * 0x9E37 & 0x17F);
+	}
+
+	volatile float sink = 0.0f;
+	std::vector<Message> messages(count);
+	BitPack::BitWriter writer;
+
+	//SHIP UPDATES
+	Result flat;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < count; i++)
+	{
+		const Player player = PlayerOf(uuid, states[i]);
+		const FlatBufferBuilder fbb = packet::UpdatePlayerS2C(uint32_t(i), &player, states[i].intervalMs, uint16_t(i), 120);
+		messages[i].assign(fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize());
+	}
+	flat.encodeNs = ElapsedNs(start);
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < count; i++)
+	{
+		const UpdatePlayerS2C* update = GetPacketWrapper(messages[i].data())->packet_as_UpdatePlayerS2C();
+		const Player* player = update->player();
+		sink = sink + player->position().x() + player->velocity().y() + player->direction().w() + float(update->time() + update->interval_ms() + update->input_ack_seq());
+	}
+	flat.decodeNs = ElapsedNs(start);
+	for (const Message& message : messages) flat.bytes += double(message.size());
+
+	//Bit packed, full state (what a receiver gets first) and only the fields that changed on the wire since the previous tick
+	Result packed[2];
+	for (int delta = 0; delta < 2; delta++)
+	{
+		Result& result = packed[delta];
+		start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < count; i++)
+		{
+			Replication::ShipUpdateS2C update;
+			update.tick = uint32_t(i);
+			update.uuid = uuid;
+			update.state = states[i];
+			update.dirty = delta && i > 0 ? Replication::ShipSchema::Dirty(states[i], states[i - 1]) : Replication::ShipSchema::all;
+			update.ackSeq = uint16_t(i);
+			update.ackDelay = 120;
+			writer.Clear();
+			update.Write(writer);
+			messages[i].assign(writer.Data(), writer.Data() + writer.Size());
+		}
+		result.encodeNs = ElapsedNs(start);
+		start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < count; i++)
+		{
+			BitPack::BitReader reader(messages[i].data(), messages[i].size());
+			Replication::ShipUpdateS2C update;
+			if (BitPack::Type::Read(reader) != BitPack::MessageType_UpdatePlayerS2C || !update.Read(reader, uint32_t(i))) return 1;
+			sink = sink + update.state.position.x + update.state.velocity.y + update.state.orientation.w + float(update.tick + update.state.intervalMs + update.ackSeq);
+		}
+		result.decodeNs = ElapsedNs(start);
+		for (const Message& message : messages) result.bytes += double(message.size());
+	}
+
+	//INPUT (a shot every 23rd tick)
+	Result flatInput, packedInput;
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < count; i++)
+	{
+		const FlatBufferBuilder fbb = packet::InputC2S(uint32_t(i), bitmaps[i], i % 23 == 0 ? uint32_t(i) : 0, uint16_t(i));
+		messages[i].assign(fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize());
+	}
+	flatInput.encodeNs = ElapsedNs(start);
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < count; i++)
+	{
+		const InputC2S* input = GetPacketWrapper(messages[i].data())->packet_as_InputC2S();
+		sink = sink + float(input->time() + input->bitmap() + input->shot_seq() + input->input_seq());
+	}
+	flatInput.decodeNs = ElapsedNs(start);
+	for (const Message& message : messages) flatInput.bytes += double(message.size());
+
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < count; i++)
+	{
+		BitPack::InputC2S input;
+		input.tick = uint32_t(i);
+		input.bitmap = bitmaps[i];
+		input.shotSeq = i % 23 == 0 ? uint32_t(i) : 0;
+		input.seq = uint16_t(i);
+		writer.Clear();
+		input.Write(writer);
+		messages[i].assign(writer.Data(), writer.Data() + writer.Size());
+	}
+	packedInput.encodeNs = ElapsedNs(start);
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < count; i++)
+	{
+		BitPack::BitReader reader(messages[i].data(), messages[i].size());
+		BitPack::InputC2S input;
+		if (BitPack::Type::Read(reader) != BitPack::MessageType_InputC2S || !input.Read(reader, uint32_t(i))) return 1;
+		sink = sink + float(input.tick + input.bitmap + input.shotSeq + input.seq);
+	}
+	packedInput.decodeNs = ElapsedNs(start);
+	for (const Message& message : messages) packedInput.bytes += double(message.size());
+
+	std::cout << "BITPACKBENCH: " << count << " messages each (payload only, ENet adds its own headers)\n";
+	std::cout << "UpdatePlayerS2C\n";
+	Print("FlatBuffers", flat, count);
+	Print("bit packed, every field", packed[0], count);
+	Print("bit packed, dirty fields", packed[1], count);
+	std::cout << "InputC2S\n";
+	Print("FlatBuffers", flatInput, count);
+	Print("bit packed", packedInput, count);
+	return 0;
+}
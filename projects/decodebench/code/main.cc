@@ -0,0 +1,141 @@
+//------------------------------------------------------------------------------
+// main.cc
+// What a client spends decoding one second of server traffic at the snapshot rate:
+// UpdatePlayerS2C for every ship each tick plus laser spawns / despawns, read through the
+// object API (UnPack, what OnRecievepacket did before) and in place from the buffer (what it does now)
+// (decodebench [min seconds of traffic per ship count = 20])
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "network/network.h"
+#include "network/timer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+//Heap allocations made while decoding
+static size_t allocations = 0;
+
+void* operator new(size_t size)
+{
+	allocations++;
+	if (void* memory = std::malloc(size)) return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+static float Sum(const Vec3& v) { return v.x() + v.y() + v.z(); }
+static float Sum(const Vec4& v) { return v.x() + v.y() + v.z() + v.w(); }
+
+//Every field the client reads (ShipStateOf, SpawnLaser), so neither path can skip work
+static float Read(const Player& player) { return float(player.uuid()) + Sum(player.position()) + Sum(player.velocity()) + Sum(player.direction()); }
+static float Read(const Laser& laser) { return float(laser.uuid() + laser.start_time() + laser.end_time()) + Sum(laser.origin()) + Sum(laser.direction()); }
+
+static float DecodeUnpacked(const uint8_t* data)
+{
+	PacketWrapperT* unpacked = GetPacketWrapper(data)->UnPack();
+	float sink = 0.0f;
+	switch (unpacked->packet.type)
+	{
+		case PacketType_UpdatePlayerS2C: {
+			const UpdatePlayerS2CT* update = unpacked->packet.AsUpdatePlayerS2C();
+			sink = Read(*update->player) + float(update->time + update->interval_ms + update->input_ack_seq);
+			break;
+		}
+		case PacketType_SpawnLaserS2C: {
+			const SpawnLaserS2CT* spawn = unpacked->packet.AsSpawnLaserS2C();
+			sink = Read(*spawn->laser) + float(spawn->owner_id + spawn->shot_seq);
+			break;
+		}
+		case PacketType_DespawnLaserS2C:
+			sink = float(unpacked->packet.AsDespawnLaserS2C()->uuid);
+			break;
+		default:
+			break;
+	}
+	delete unpacked;
+	return sink;
+}
+
+static float DecodeInPlace(const uint8_t* data)
+{
+	const PacketWrapper* wrapper = GetPacketWrapper(data);
+	switch (wrapper->packet_type())
+	{
+		case PacketType_UpdatePlayerS2C: {
+			const UpdatePlayerS2C* update = wrapper->packet_as_UpdatePlayerS2C();
+			return Read(*update->player()) + float(update->time() + update->interval_ms() + update->input_ack_seq());
+		}
+		case PacketType_SpawnLaserS2C: {
+			const SpawnLaserS2C* spawn = wrapper->packet_as_SpawnLaserS2C();
+			return Read(*spawn->laser()) + float(spawn->owner_id() + spawn->shot_seq());
+		}
+		case PacketType_DespawnLaserS2C:
+			return float(wrapper->packet_as_DespawnLaserS2C()->uuid());
+		default:
+			return 0.0f;
+	}
+}
+
+//One second of what a client receives with ships in the match, every ship updated each tick and firing once a second
+static std::vector<std::vector<uint8_t>> RecordSecond(uint32_t ships)
+{
+	std::vector<std::vector<uint8_t>> packets;
+	auto keep = [&packets](const FlatBufferBuilder& fbb) { packets.emplace_back(fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize()); };
+	for (uint32_t tick = 0; tick < Tick::Rate; tick++)
+	{
+		for (uint32_t id = 1; id <= ships; id++)
+		{
+			const float t = float(tick) * Tick::Seconds;
+			const Player player(id, Vec3(float(id) + t, 2.0f * t, -float(id)), Vec3(0.0f, 1.0f, 10.0f), Vec3(), Vec4(0.0f, 0.0f, 0.0f, 1.0f));
+			keep(packet::UpdatePlayerS2C(tick, &player, 16, uint16_t(tick), 120));
+		}
+		for (uint32_t id = 1 + tick; id <= ships; id += Tick::Rate)
+		{
+			const Laser laser(id * 100 + tick, tick, tick + 150, Vec3(float(id), 0.0f, 1.0f), Vec4(0.0f, 0.0f, 0.0f, 1.0f));
+			keep(packet::SpawnLaserS2C(&laser, id, tick));
+			keep(packet::DespawnLaserS2C(id * 100 + tick));
+		}
+	}
+	return packets;
+}
+
+int
+main(int argc, const char** argv)
+{
+	const int seconds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+	const uint32_t shipCounts[] = { 2, 8, 32, 128 };
+
+	volatile float sink = 0.0f;
+	for (const uint32_t ships : shipCounts)
+	{
+		const std::vector<std::vector<uint8_t>> packets = RecordSecond(ships);
+		const int repeats = std::max(seconds, int(200000 / packets.size())); //Small matches replay more seconds, for stable numbers
+		double ns[2] = { 0, 0 };
+		size_t allocated[2] = { 0, 0 };
+		for (int inPlace = 0; inPlace < 2; inPlace++)
+		{
+			float sum = 0.0f;
+			allocations = 0;
+			const auto start = std::chrono::steady_clock::now();
+			for (int second = 0; second < repeats; second++)
+				for (const std::vector<uint8_t>& packet : packets)
+					sum += inPlace ? DecodeInPlace(packet.data()) : DecodeUnpacked(packet.data());
+			ns[inPlace] = double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+			allocated[inPlace] = allocations;
+			sink = sink + sum;
+		}
+
+		const double messages = double(packets.size()) * repeats;
+		std::cout << "DECODEBENCH: " << ships << " ships, " << packets.size() << " msgs/s: UnPack "
+			<< ns[0] / messages << " ns/msg (" << double(allocated[0]) / messages << " allocs, " << ns[0] / repeats / 1000.0 << " us per second of traffic), in place "
+			<< ns[1] / messages << " ns/msg (" << double(allocated[1]) / messages << " allocs, " << ns[1] / repeats / 1000.0 << " us per second of traffic)\n";
+	}
+	return 0;
+}
@@ -0,0 +1,78 @@
+//------------------------------------------------------------------------------
+// main.cc
+// Trains the snapshot compression dictionary from a capture of sent payloads
+// (run the host with sv_capture set, then: dicttrainer capture.bin [out.dict] [size])
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "network/compression.h"
+#include "network/proto.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+int
+main(int argc, const char** argv)
+{
+	if (argc < 2)
+	{
+		std::cout << "usage: dicttrainer <capture> [dictionary = " << Compression::DefaultDictionaryPath << "] [size = 8192]\n";
+		return 1;
+	}
+	const char* capturePath = argv[1];
+	const char* dictionaryPath = argc > 2 ? argv[2] : Compression::DefaultDictionaryPath;
+	const size_t dictionarySize = argc > 3 ? size_t(std::atoi(argv[3])) : 8192;
+
+	std::vector<std::vector<uint8_t>> samples;
+	if (!Compression::ReadCapture(capturePath, samples) || samples.empty())
+	{
+		std::cout << "DICTTRAINER: No samples in " << capturePath << "\n";
+		return 1;
+	}
+
+	//Every 7th sample is held out to check the dictionary on traffic it was not trained on
+	std::vector<std::vector<uint8_t>> training, holdout;
+	for (size_t i = 0; i < samples.size(); i++)
+		(i % 7 == 6 ? holdout : training).push_back(std::move(samples[i]));
+
+	const std::vector<uint8_t> dictionary = Compression::TrainDictionary(training, dictionarySize);
+	FILE* file = fopen(dictionaryPath, "wb");
+	if (file == nullptr || fwrite(dictionary.data(), 1, dictionary.size(), file) != dictionary.size())
+	{
+		std::cout << "DICTTRAINER: Could not write " << dictionaryPath << "\n";
+		if (file) fclose(file);
+		return 1;
+	}
+	fclose(file);
+	std::cout << "DICTTRAINER: " << training.size() << " samples -> " << dictionary.size() << " byte dictionary (id "
+		<< Compression::DictionaryID(dictionary) << ") in " << dictionaryPath << "\n";
+
+	//Ratio per message type on the held out samples, with and without the dictionary
+	struct Totals { size_t count = 0, raw = 0, plain = 0, trained = 0; double ns = 0; };
+	Totals totals[Protocol::PacketType_MAX + 1];
+	const std::vector<uint8_t> noDictionary;
+	std::vector<uint8_t> out;
+	for (const std::vector<uint8_t>& sample : holdout)
+	{
+		const int type = int(Protocol::GetPacketWrapper(sample.data())->packet_type());
+		if (type < 0 || type > Protocol::PacketType_MAX) continue;
+		out.resize(sample.size() * 2 + 16);
+		Totals& t = totals[type];
+		t.count++;
+		t.raw += sample.size();
+		t.plain += Compression::Compress(noDictionary, sample.data(), sample.size(), out.data(), out.size());
+		const auto start = std::chrono::steady_clock::now();
+		t.trained += Compression::Compress(dictionary, sample.data(), sample.size(), out.data(), out.size());
+		t.ns += double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+	}
+	for (int type = 0; type <= Protocol::PacketType_MAX; type++)
+	{
+		const Totals& t = totals[type];
+		if (t.count == 0) continue;
+		std::cout << "  " << Protocol::EnumNamePacketType(Protocol::PacketType(type)) << ": " << t.count << " msgs, avg " << t.raw / t.count
+			<< " B, ratio " << double(t.raw) / double(t.plain) << " plain / " << double(t.raw) / double(t.trained) << " dictionary, "
+			<< t.ns / double(t.count) / 1000.0 << " us per message\n";
+	}
+	return 0;
+}
@@ -0,0 +1,182 @@
+//------------------------------------------------------------------------------
+// main.cc
+// Server side ENet datagrams per second per core, sending (enet_host_flush to every client)
+// and receiving (draining one datagram from every client), once with the recvmmsg/sendmmsg
+// batch of ENET_BATCHED_IO and once with one syscall per datagram, over localhost
+// (run: enetbench [rounds = 2000] [clients = 64] [bytes per packet = 64])
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include <enet/enet.h>
+
+#include <time.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+static double
+ThreadCpuSeconds()
+{
+	timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+}
+
+static ENetHost*
+CreateHost(const ENetAddress* address, size_t peerCount, bool batched)
+{
+	ENetHost* host = enet_host_create(address, peerCount, 1, 0, 0);
+	if (host == nullptr) return nullptr;
+	//NULL batch is the one syscall per datagram path, same as a build without ENET_BATCHED_IO
+	if (!batched && host->socketBatch != nullptr)
+	{
+		enet_socket_batch_destroy(host->socketBatch);
+		host->socketBatch = nullptr;
+	}
+	return host;
+}
+
+//Services without waiting, returns the number of packets received
+static size_t
+Drain(ENetHost* host)
+{
+	size_t received = 0;
+	ENetEvent event;
+	while (enet_host_service(host, &event, 0) > 0)
+	{
+		if (event.type == ENET_EVENT_TYPE_RECEIVE)
+		{
+			received++;
+			enet_packet_destroy(event.packet);
+		}
+	}
+	return received;
+}
+
+struct Result
+{
+	double sendSeconds = 0, receiveSeconds = 0;
+	size_t datagramsSent = 0, datagramsReceived = 0;
+	size_t serverQueued = 0, serverDelivered = 0;
+	size_t clientsQueued = 0, clientsDelivered = 0;
+	bool batched = false;
+	bool connected = false;
+};
+
+static Result
+Run(bool batched, int rounds, size_t clientCount, size_t bytes)
+{
+	Result result;
+	ENetAddress address;
+	enet_address_set_host_ip(&address, "127.0.0.1");
+	address.port = 0;
+	ENetHost* server = CreateHost(&address, clientCount, batched);
+	if (server == nullptr) return result;
+	enet_socket_get_address(server->socket, &address);
+	result.batched = server->socketBatch != nullptr;
+
+	std::vector<ENetHost*> clients;
+	std::vector<ENetPeer*> serverPeers;
+	for (size_t i = 0; i < clientCount; i++)
+	{
+		ENetHost* client = CreateHost(nullptr, 1, batched);
+		if (client == nullptr) break;
+		clients.push_back(client);
+		enet_host_connect(client, &address, 1, 0);
+	}
+
+	//HANDSHAKE, EVERY CLIENT HAS TO BE CONNECTED BEFORE ANY TIMING
+	enet_uint32 deadline = enet_time_get() + 5000;
+	size_t clientsConnected = 0;
+	while (clients.size() == clientCount && (serverPeers.size() < clientCount || clientsConnected < clientCount) && enet_time_get() < deadline)
+	{
+		ENetEvent event;
+		while (enet_host_service(server, &event, 0) > 0)
+			if (event.type == ENET_EVENT_TYPE_CONNECT) serverPeers.push_back(event.peer);
+		for (ENetHost* client : clients)
+			while (enet_host_service(client, &event, 0) > 0)
+				if (event.type == ENET_EVENT_TYPE_CONNECT) clientsConnected++;
+	}
+	result.connected = serverPeers.size() == clientCount && clientsConnected == clientCount;
+
+	if (result.connected)
+	{
+		//Unreliable packets would otherwise be thinned out when the loopback rtt jitters
+		for (ENetPeer* peer : serverPeers) enet_peer_throttle_configure(peer, ENET_PEER_PACKET_THROTTLE_INTERVAL, ENET_PEER_PACKET_THROTTLE_SCALE, 0);
+		for (ENetHost* client : clients) enet_peer_throttle_configure(&client->peers[0], ENET_PEER_PACKET_THROTTLE_INTERVAL, ENET_PEER_PACKET_THROTTLE_SCALE, 0);
+
+		std::vector<enet_uint8> payload(bytes, 0x5a);
+		server->totalSentPackets = 0;
+		server->totalReceivedPackets = 0;
+		for (int round = 0; round < rounds; round++)
+		{
+			//SNAPSHOT SHAPE, ONE PACKET TO EVERY CLIENT AND A SINGLE FLUSH
+			for (ENetPeer* peer : serverPeers)
+				if (enet_peer_send(peer, 0, enet_packet_create(payload.data(), payload.size(), 0)) == 0)
+					result.serverQueued++;
+			double start = ThreadCpuSeconds();
+			enet_host_flush(server);
+			result.sendSeconds += ThreadCpuSeconds() - start;
+			for (ENetHost* client : clients)
+				result.serverDelivered += Drain(client);
+
+			//INPUT SHAPE, EVERY CLIENT SENDS ONE PACKET, THE SERVER DRAINS THEM ALL
+			for (ENetHost* client : clients)
+			{
+				if (enet_peer_send(&client->peers[0], 0, enet_packet_create(payload.data(), payload.size(), 0)) == 0)
+					result.clientsQueued++;
+				enet_host_flush(client);
+			}
+			start = ThreadCpuSeconds();
+			result.clientsDelivered += Drain(server);
+			result.receiveSeconds += ThreadCpuSeconds() - start;
+		}
+		result.datagramsSent = server->totalSentPackets;
+		result.datagramsReceived = server->totalReceivedPackets;
+	}
+
+	for (ENetHost* client : clients)
+		enet_host_destroy(client);
+	enet_host_destroy(server);
+	return result;
+}
+
+int
+main(int argc, const char** argv)
+{
+	const int rounds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000;
+	const size_t clientCount = argc > 2 ? size_t(std::max(1, std::atoi(argv[2]))) : 64;
+	const size_t bytes = argc > 3 ? size_t(std::clamp(std::atoi(argv[3]), 1, 1200)) : 64;
+
+	if (enet_initialize() != 0)
+	{
+		std::cout << "ENETBENCH: enet_initialize failed\n";
+		return 1;
+	}
+
+	//Alternating passes, localhost numbers on a busy machine move around a lot
+	bool failed = false;
+	for (int pass = 0; pass < 3; pass++)
+	{
+		for (int batched = 0; batched <= 1; batched++)
+		{
+			const Result result = Run(batched == 1, rounds, clientCount, bytes);
+			if (!result.connected)
+			{
+				std::cout << "ENETBENCH: " << clientCount << " clients failed to connect\n";
+				failed = true;
+				continue;
+			}
+			if (batched == 1 && !result.batched)
+				std::cout << "ENETBENCH: no socket batch, this pass runs one syscall per datagram\n";
+			std::cout << "ENETBENCH: " << (batched ? "batched" : "plain  ") << ", " << clientCount << " clients, " << bytes << " B: send "
+				<< double(result.datagramsSent) / result.sendSeconds / 1e6 << " M datagrams/s/core (" << result.datagramsSent << "), receive "
+				<< double(result.datagramsReceived) / result.receiveSeconds / 1e6 << " M datagrams/s/core (" << result.datagramsReceived << "), delivered "
+				<< result.serverDelivered << " of " << result.serverQueued << " to the clients, "
+				<< result.clientsDelivered << " of " << result.clientsQueued << " to the server\n";
+		}
+	}
+
+	enet_deinitialize();
+	return failed ? 1 : 0;
+}
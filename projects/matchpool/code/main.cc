@@ -0,0 +1,97 @@
+//------------------------------------------------------------------------------
+// main.cc
+// Match pool supervisor
+// (matchpool [warm children] [base port] [max matches], then "match" on stdin starts a match and prints its port,
+//  "status" lists the running ones, "quit" ends everything)
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "pool.h"
+#include "spaceship.h"
+#include "network/server.h"
+#include "network/timer.h"
+#include "core/random.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <poll.h>
+#include <unistd.h>
+
+//Same field as the hosting game builds (SpaceGameApp::Open), colliders only
+static void LoadAsteroids()
+{
+	const Physics::ColliderMeshId colliderMeshes[6] = {
+		Physics::LoadColliderMesh("assets/space/Asteroid_1_physics.glb"),
+		Physics::LoadColliderMesh("assets/space/Asteroid_2_physics.glb"),
+		Physics::LoadColliderMesh("assets/space/Asteroid_3_physics.glb"),
+		Physics::LoadColliderMesh("assets/space/Asteroid_4_physics.glb"),
+		Physics::LoadColliderMesh("assets/space/Asteroid_5_physics.glb"),
+		Physics::LoadColliderMesh("assets/space/Asteroid_6_physics.glb")
+	};
+
+	auto generateAsteroids = [&](int count, float span)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			const size_t resourceIndex = (size_t)(Core::FastRandom() % 6);
+			const glm::vec3 translation = glm::vec3(
+				Core::RandomFloatNTP() * span,
+				Core::RandomFloatNTP() * span,
+				Core::RandomFloatNTP() * span
+			);
+			const glm::vec3 rotationAxis = normalize(translation);
+			const float rotation = translation.x;
+
+			ServerAsteroid asteroid;
+			asteroid.transform = glm::rotate(rotation, rotationAxis) * glm::translate(translation);
+			asteroid.colliderID = Physics::CreateCollider(colliderMeshes[resourceIndex], asteroid.transform);
+			gameServer.SetAsteroid(asteroid);
+		}
+	};
+	generateAsteroids(100, 20.0f); //Near
+	generateAsteroids(50, 80.0f); //Far
+}
+
+int
+main(int argc, const char** argv)
+{
+	PoolSettings settings;
+	if (argc > 1) settings.warmChildren = std::max(0, std::atoi(argv[1]));
+	if (argc > 2) settings.basePort = uint16_t(std::atoi(argv[2]));
+	if (argc > 3) settings.maxMatches = std::max(1, std::atoi(argv[3]));
+
+	//Everything a match would load on its own, loaded once and shared copy on write by every child
+	const uint64_t start = Time::Now();
+	gameServer.LoadAssets();
+	LoadAsteroids();
+	std::cout << "POOL: Assets loaded in " << (Time::Now() - start) << "ms\n";
+
+	MatchPool pool;
+	if (!pool.Start(settings))
+	{
+		pool.Stop();
+		return 1;
+	}
+
+	std::string line;
+	while (true)
+	{
+		pool.Maintain();
+
+		pollfd input = { STDIN_FILENO, POLLIN, 0 };
+		if (poll(&input, 1, 500) <= 0) continue;
+		if (!std::getline(std::cin, line) || line == "quit")
+			break;
+		if (line == "match")
+			std::cout << pool.Allocate() << std::endl;
+		else if (line == "status")
+			std::cout << pool.Status() << std::endl;
+		else if (!line.empty())
+			std::cout << "commands: match, status, quit\n";
+	}
+
+	pool.Stop();
+	return 0;
+}
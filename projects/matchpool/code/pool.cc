@@ -0,0 +1,214 @@
+//------------------------------------------------------------------------------
+// pool.cc
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "pool.h"
+#include "spaceship.h"
+#include "network/server.h"
+#include "network/timer.h"
+
+#include <algorithm>
+#include <csignal>
+#include <iostream>
+#include <sstream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void OnTerminate(int)
+{
+	stopRequested = 1;
+}
+
+//Child side, never returns
+static void ServeMatch(int control, uint32_t idleTimeoutMs)
+{
+	struct sigaction terminate = {};
+	terminate.sa_handler = OnTerminate; //No SA_RESTART, a blocked read returns
+	sigaction(SIGTERM, &terminate, nullptr);
+
+	//Warm: nothing but the inherited assets until the supervisor sends a port (or goes away)
+	uint16_t port = 0;
+	if (read(control, &port, sizeof(port)) != sizeof(port) || stopRequested)
+		_exit(0);
+
+	gameServer.StartServer(port);
+	const uint8_t ready = gameServer.Listening() ? 1 : 0;
+	if (write(control, &ready, sizeof(ready)) != sizeof(ready) || !ready)
+		_exit(1);
+	close(control);
+
+	//Ends once nobody played for idleTimeoutMs (counting from the claim, so an unused match goes away too)
+	uint64_t activeTime = Time::Now();
+	while (gameServer.live && !stopRequested)
+	{
+		gameServer.Run();
+		const uint64_t now = Time::Now();
+		if (!gameServer.Idle())
+			activeTime = now;
+		else if (now - activeTime >= idleTimeoutMs)
+			break;
+	}
+	gameServer.ShutdownServer();
+	_exit(0);
+}
+
+bool MatchPool::Start(const PoolSettings& poolSettings)
+{
+	settings = poolSettings;
+	signal(SIGPIPE, SIG_IGN); //A child that died between the claim and the write is handled by the failed write
+
+	for (int i = 0; i < settings.warmChildren; ++i)
+		if (!Fork()) return false;
+	std::cout << "POOL: " << settings.warmChildren << " warm match servers, ports " << settings.basePort << " - "
+		<< settings.basePort + settings.maxMatches - 1 << "\n";
+	return true;
+}
+
+void MatchPool::Stop()
+{
+	//Warm children see their control socket close, matches get SIGTERM
+	for (Child& child : children)
+	{
+		if (child.control >= 0) close(child.control);
+		kill(child.pid, SIGTERM);
+	}
+	for (Child& child : children)
+		waitpid(child.pid, nullptr, 0);
+	children.clear();
+}
+
+bool MatchPool::Fork()
+{
+	int pair[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+	{
+		std::cout << "POOL: socketpair failed\n";
+		return false;
+	}
+
+	const pid_t pid = fork();
+	if (pid < 0)
+	{
+		std::cout << "POOL: fork failed\n";
+		close(pair[0]);
+		close(pair[1]);
+		return false;
+	}
+	if (pid == 0)
+	{
+		//The other childrens control sockets are the supervisors business
+		close(pair[0]);
+		for (const Child& child : children)
+			if (child.control >= 0) close(child.control);
+		ServeMatch(pair[1], settings.idleTimeoutMs);
+	}
+
+	close(pair[1]);
+	Child child;
+	child.pid = pid;
+	child.control = pair[0];
+	children.push_back(child);
+	return true;
+}
+
+int MatchPool::FreePort() const
+{
+	for (int i = 0; i < settings.maxMatches; ++i)
+	{
+		const int port = settings.basePort + i;
+		bool used = false;
+		for (const Child& child : children)
+			used = used || child.port == port;
+		if (!used) return port;
+	}
+	return -1;
+}
+
+int MatchPool::Allocate()
+{
+	Reap();
+	const int port = FreePort();
+	if (port < 0)
+	{
+		std::cout << "POOL: All " << settings.maxMatches << " matches are running\n";
+		return -1;
+	}
+
+	//Normally a warm child is waiting, a drained pool forks one on the spot (still no asset loading)
+	auto warm = std::find_if(children.begin(), children.end(), [](const Child& child) { return child.port == 0; });
+	if (warm == children.end())
+	{
+		if (!Fork()) return -1;
+		warm = children.end() - 1;
+	}
+
+	const uint64_t start = Time::Now();
+	const uint16_t claim = uint16_t(port);
+	uint8_t ready = 0;
+	pollfd wait = { warm->control, POLLIN, 0 };
+	const bool claimed = write(warm->control, &claim, sizeof(claim)) == sizeof(claim) &&
+		poll(&wait, 1, 2000) > 0 && read(warm->control, &ready, sizeof(ready)) == sizeof(ready) && ready == 1;
+	if (!claimed)
+	{
+		std::cout << "POOL: Child " << warm->pid << " could not open port " << port << "\n";
+		//Not warm anymore, the next Allocate must not wait on it again and Maintain forks its replacement
+		close(warm->control);
+		warm->control = -1;
+		warm->port = -1;
+		kill(warm->pid, SIGTERM);
+		return -1; //Reaped by the next Maintain
+	}
+
+	warm->port = port;
+	std::cout << "POOL: Match on port " << port << " (pid " << warm->pid << ") ready in " << (Time::Now() - start) << "ms\n";
+	Maintain();
+	return port;
+}
+
+void MatchPool::Maintain()
+{
+	Reap();
+	int warmCount = 0;
+	for (const Child& child : children)
+		warmCount += child.port == 0 ? 1 : 0;
+	for (; warmCount < settings.warmChildren; ++warmCount)
+		if (!Fork()) break;
+}
+
+void MatchPool::Reap()
+{
+	int status = 0;
+	pid_t pid;
+	while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+	{
+		for (auto it = children.begin(); it != children.end(); it++)
+		{
+			if (it->pid != pid) continue;
+			if (it->port > 0)
+				std::cout << "POOL: Match on port " << it->port << " ended\n";
+			if (it->control >= 0) close(it->control);
+			children.erase(it);
+			break;
+		}
+	}
+}
+
+std::string MatchPool::Status() const
+{
+	std::ostringstream out;
+	int warmCount = 0, matchCount = 0;
+	for (const Child& child : children)
+	{
+		warmCount += child.port == 0 ? 1 : 0;
+		matchCount += child.port > 0 ? 1 : 0;
+	}
+	out << warmCount << " warm, " << matchCount << " matches";
+	for (const Child& child : children)
+		if (child.port > 0) out << " [" << child.port << " pid " << child.pid << "]";
+	return out.str();
+}
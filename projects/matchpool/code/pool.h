@@ -0,0 +1,51 @@
+#pragma once
+//------------------------------------------------------------------------------
+// pool.h
+// Match pool: a supervisor that loads the server assets once and keeps
+// fork()ed, ready to serve GameServer children waiting for a match
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+struct PoolSettings
+{
+	int warmChildren = 4; //Forked children kept waiting for a match
+	int maxMatches = 16; //Running matches at most (one port each)
+	uint16_t basePort = 1234; //Matches get the first free port from here
+	uint32_t idleTimeoutMs = 60000; //A match without players (none joined yet or all left) for this long ends
+};
+
+/*
+* MATCH POOL
+*	- THE SUPERVISOR LOADS EVERY COLLIDER MESH AND BUILDS THE ASTEROID FIELD, THEN FORKS: CHILDREN SHARE THOSE PAGES COPY ON WRITE
+*	- A WARM CHILD BLOCKS ON ITS CONTROL SOCKET, NO ENET HOST OR THREAD EXISTS BEFORE IT IS CLAIMED
+*	- CLAIMING SENDS THE PORT, THE CHILD OPENS IT (StartServer), ACKS AND RUNS THE MATCH UNTIL IT IS IDLE
+*	- THE SUPERVISOR NEVER STARTS A THREAD (FORK ONLY COPIES THE CALLING ONE)
+*/
+class MatchPool
+{
+public:
+	bool Start(const PoolSettings& settings); //Call after the assets are loaded
+	void Stop(); //Ends warm children and matches (SIGTERM, matches write their checkpoint if enabled)
+	int Allocate(); //Port of a new match, -1 when no match could be started
+	void Maintain(); //Reaps ended matches and forks children back up to warmChildren
+	std::string Status() const;
+
+private:
+	struct Child
+	{
+		pid_t pid = -1;
+		int control = -1; //Supervisor end of the socket pair
+		int port = 0; //0 = warm, waiting for a claim, -1 = failed its claim and is ending (never claimable, Reap removes it)
+	};
+
+	bool Fork();
+	void Reap();
+	int FreePort() const;
+
+	PoolSettings settings;
+	std::vector<Child> children;
+};
@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------
+// main.cc
+// Raycast cost over asteroid fields of growing size, with the collider tree (phys_bvh 1)
+// and with the plain loop over every collider (phys_bvh 0), results of both are compared
+// (run from bin: physicsbench [rays per field = 200000])
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "physics/physics.h"
+#include "core/cvar.h"
+#include "core/random.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+static double
+ElapsedNs(std::chrono::steady_clock::time_point start)
+{
+	return double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+static glm::vec3
+RandomDirection()
+{
+	glm::vec3 dir;
+	do dir = glm::vec3(Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP());
+	while (glm::dot(dir, dir) < 0.01f || glm::dot(dir, dir) > 1.0f);
+	return glm::normalize(dir);
+}
+
+struct Ray
+{
+	glm::vec3 start;
+	glm::vec3 dir;
+	float length;
+};
+
+//Total ns for the first count rays
+static double
+CastAll(std::vector<Ray> const& rays, size_t count, std::vector<Physics::RaycastPayload>& results)
+{
+	results.resize(count);
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < count; i++)
+		results[i] = Physics::Raycast(rays[i].start, rays[i].dir, rays[i].length);
+	return ElapsedNs(start);
+}
+
+int
+main(int argc, const char** argv)
+{
+	const size_t rayCount = argc > 1 ? size_t(std::max(1, std::atoi(argv[1]))) : 200000;
+	const size_t fieldSizes[] = { 150, 1000, 10000, 100000 };
+	const size_t shipCount = 64;
+	const int ticks = 300;
+
+	const Physics::ColliderMeshId colliderMeshes[6] = {
+		Physics::LoadColliderMesh("assets/space/Asteroid_1_physics.glb"),
+		Physics::LoadColliderMesh("assets/space/Asteroid_2_physics.glb"),
+		Physics::LoadColliderMesh("assets/space/Asteroid_3_physics.glb"),
+		Physics::LoadColliderMesh("assets/space/Asteroid_4_physics.glb"),
+		Physics::LoadColliderMesh("assets/space/Asteroid_5_physics.glb"),
+		Physics::LoadColliderMesh("assets/space/Asteroid_6_physics.glb")
+	};
+	const Physics::ColliderMeshId shipMesh = Physics::LoadColliderMesh("assets/space/spaceship_physics.glb");
+	Physics::Raycast(glm::vec3(0), glm::vec3(0, 0, 1), 1.0f); //Creates phys_bvh
+	Core::CVar* phys_bvh = Core::CVarGet("phys_bvh");
+
+	for (const size_t fieldSize : fieldSizes)
+	{
+		//Same density as the near field the game builds (100 asteroids in a 40 unit cube)
+		const float span = 20.0f * std::cbrt(float(fieldSize) / 100.0f);
+		Core::CVarWriteInt(phys_bvh, 1);
+		auto start = std::chrono::steady_clock::now();
+		std::vector<Physics::ColliderId> field;
+		for (size_t i = 0; i < fieldSize; i++)
+		{
+			const glm::vec3 translation = glm::vec3(Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP()) * span;
+			const glm::mat4 transform = glm::translate(translation) * glm::rotate(translation.x, RandomDirection());
+			field.push_back(Physics::CreateCollider(colliderMeshes[Core::FastRandom() % 6], transform));
+		}
+
+		//Inserted one by one, or built by the first raycast when the tree was invalidated
+		Physics::Raycast(glm::vec3(0), glm::vec3(0, 0, 1), 1.0f);
+		const double setupMs = ElapsedNs(start) / 1e6;
+
+		//Laser and ship probe sized rays (about a unit) anywhere in the field
+		std::vector<Ray> rays(rayCount);
+		for (Ray& ray : rays)
+			ray = { glm::vec3(Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP()) * span, RandomDirection(), 0.5f + Core::RandomFloat() };
+
+		//The loop over every collider gets a budget of ~200M collider tests
+		const size_t bruteCount = std::min(rayCount, std::max<size_t>(1000, 200000000 / fieldSize));
+		std::vector<Physics::RaycastPayload> treeResults, bruteResults;
+		const double treeNs = CastAll(rays, rayCount, treeResults);
+		Core::CVarWriteInt(phys_bvh, 0);
+		const double bruteNs = CastAll(rays, bruteCount, bruteResults);
+
+		size_t hits = 0, mismatches = 0;
+		for (size_t i = 0; i < bruteCount; i++)
+		{
+			hits += bruteResults[i].hit;
+			if (treeResults[i].hit != bruteResults[i].hit || (treeResults[i].hit && treeResults[i].hitDistance != bruteResults[i].hitDistance))
+				mismatches++;
+		}
+
+		//Server tick shape: every ship moves (SetTransform refits the tree) and casts its 8 collision probes
+		std::vector<Physics::ColliderId> ships;
+		std::vector<glm::vec3> positions, velocities;
+		for (size_t i = 0; i < shipCount; i++)
+		{
+			positions.push_back(glm::vec3(Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP()) * span);
+			velocities.push_back(RandomDirection() * 0.5f);
+			ships.push_back(Physics::CreateCollider(shipMesh, glm::translate(positions.back())));
+		}
+		double tickNs[2] = { 0, 0 };
+		for (int bvh = 1; bvh >= 0; bvh--)
+		{
+			if (bvh == 0 && fieldSize > 10000) break; //Minutes of runtime, the ray numbers above already tell
+			Core::CVarWriteInt(phys_bvh, bvh);
+			start = std::chrono::steady_clock::now();
+			for (int tick = 0; tick < ticks; tick++)
+			{
+				for (size_t i = 0; i < shipCount; i++)
+				{
+					positions[i] += velocities[i];
+					Physics::SetTransform(ships[i], glm::translate(positions[i]));
+				}
+				for (size_t i = 0; i < shipCount; i++)
+					for (int probe = 0; probe < 8; probe++)
+						Physics::Raycast(positions[i], RandomDirection(), 1.0f);
+			}
+			tickNs[bvh] = ElapsedNs(start) / ticks;
+		}
+
+		std::cout << "PHYSICSBENCH: " << fieldSize << " colliders, created in " << setupMs << " ms, "
+			<< treeNs / double(rayCount) << " ns per ray with the tree / " << bruteNs / double(bruteCount) << " ns every collider ("
+			<< hits << " of " << bruteCount << " hit, " << mismatches << " mismatches), "
+			<< shipCount << " ship tick " << tickNs[1] / 1000.0 << " us / ";
+		if (tickNs[0] > 0) std::cout << tickNs[0] / 1000.0 << " us\n";
+		else std::cout << "skipped\n";
+
+		for (const Physics::ColliderId& ship : ships)
+			Physics::DestroyCollider(ship);
+		for (const Physics::ColliderId& asteroid : field)
+			Physics::DestroyCollider(asteroid);
+	}
+	return 0;
+}
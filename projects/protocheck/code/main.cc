@@ -0,0 +1,99 @@
+//------------------------------------------------------------------------------
+// main.cc
+// Builds every packet the server and clients send with zero and non zero field values
+// (defaults are left out of the table, which moves the fields after them) and runs each through
+// the verifier ingress uses, SpawnLaserS2C fields also have to read back unchanged
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "network/network.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static size_t failures = 0;
+
+static const PacketWrapper*
+Verified(const FlatBufferBuilder& fbb, const std::string& name)
+{
+	Verifier verifier(fbb.GetBufferPointer(), fbb.GetSize());
+	if (VerifyPacketWrapperBuffer(verifier)) return GetPacketWrapper(fbb.GetBufferPointer());
+	std::cout << "PROTOCHECK: " << name << " (" << fbb.GetSize() << " bytes) fails verification\n";
+	failures++;
+	return nullptr;
+}
+
+static bool
+SameBytes(const Laser& a, const Laser& b)
+{
+	return std::memcmp(&a, &b, sizeof(Laser)) == 0;
+}
+
+int
+main()
+{
+	const uint32_t values[] = { 0, 1, 0x7FFFFFFF, 0xFFFFFFFF };
+	const std::vector<Laser> lasers = {
+		Laser(),
+		Laser(1, 0, 150, Vec3(1.0f, -2.0f, 3.5f), Vec4(0.0f, 0.0f, 0.0f, 1.0f)),
+		Laser(0xFFFFFFFF, 123456, 123606, Vec3(-1e6f, 0.25f, 1e-6f), Vec4(0.5f, -0.5f, 0.5f, -0.5f))
+	};
+	const std::vector<Player> players = {
+		Player(),
+		Player(7, Vec3(1.0f, 2.0f, 3.0f), Vec3(0.1f, 0.0f, -0.1f), Vec3(0.0f, 0.0f, 0.0f), Vec4(0.0f, 0.0f, 0.0f, 1.0f))
+	};
+
+	//SPAWN LASER, EVERY OWNER / SHOT COMBINATION
+	size_t spawnLasers = 0;
+	for (const Laser& laser : lasers)
+		for (const uint32_t ownerID : values)
+			for (const uint32_t shotSeq : values)
+			{
+				const std::string name = "SpawnLaserS2C(uuid " + std::to_string(laser.uuid()) + ", owner " + std::to_string(ownerID) + ", shot " + std::to_string(shotSeq) + ")";
+				const FlatBufferBuilder fbb = packet::SpawnLaserS2C(&laser, ownerID, shotSeq);
+				spawnLasers++;
+				const PacketWrapper* wrapper = Verified(fbb, name);
+				if (wrapper == nullptr) continue;
+				const SpawnLaserS2C* spawn = wrapper->packet_as_SpawnLaserS2C();
+				if (spawn == nullptr || spawn->laser() == nullptr || !SameBytes(*spawn->laser(), laser) || spawn->owner_id() != ownerID || spawn->shot_seq() != shotSeq)
+				{
+					std::cout << "PROTOCHECK: " << name << " reads back different fields\n";
+					failures++;
+				}
+			}
+
+	//EVERY OTHER BUILDER, ONCE WITH DEFAULTS AND ONCE WITH VALUES
+	size_t others = 0;
+	auto check = [&](const FlatBufferBuilder& fbb, const std::string& name) { others++; Verified(fbb, name); };
+	for (const uint32_t value : values)
+	{
+		const uint16_t value16 = uint16_t(value);
+		const std::string suffix = "(" + std::to_string(value) + ")";
+		ENetAddress address;
+		address.host = value;
+		address.port = value16;
+		check(packet::ClienConnectsS2C(value, value, value, uint8_t(value)), "ClienConnectsS2C" + suffix);
+		check(packet::GameStateS2C(value ? players : std::vector<Player>(), value ? lasers : std::vector<Laser>()), "GameStateS2C" + suffix);
+		check(packet::DespawnPlayerS2C(value), "DespawnPlayerS2C" + suffix);
+		check(packet::DespawnLaserS2C(value), "DespawnLaserS2C" + suffix);
+		check(packet::CollisionS2C(value, value), "CollisionS2C" + suffix);
+		check(packet::TextS2C(value ? "text" : ""), "TextS2C" + suffix);
+		check(packet::ZoneRedirectS2C(address, value), "ZoneRedirectS2C" + suffix);
+		check(packet::ZoneGhostsZ2Z(value, value ? players : std::vector<Player>()), "ZoneGhostsZ2Z" + suffix);
+		check(packet::InputC2S(value, value16, value, value16), "InputC2S" + suffix);
+		check(packet::TextC2S(value ? "text" : ""), "TextC2S" + suffix);
+		check(packet::ClientHelloC2S(value16), "ClientHelloC2S" + suffix);
+		check(packet::ResumeC2S(std::vector<uint32_t>(value % 5, value), std::vector<uint32_t>(value % 3, value)), "ResumeC2S" + suffix);
+		for (const Player& player : players)
+		{
+			check(packet::SpawnPlayerS2C(&player), "SpawnPlayerS2C" + suffix);
+			check(packet::UpdatePlayerS2C(value, &player, value16, value16, value16), "UpdatePlayerS2C" + suffix);
+			check(packet::TeleportPlayerS2C(value, &player), "TeleportPlayerS2C" + suffix);
+		}
+	}
+
+	std::cout << "PROTOCHECK: " << spawnLasers << " SpawnLaserS2C and " << others << " other packets, " << failures << " failures\n";
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,37 @@
+//------------------------------------------------------------------------------
+// main.cc
+// Spectator relay
+// (relay <server ip> [server port] [listen port] [delay ms] [compression], spectators connect to the listen port,
+//  another relay can use this one as its server)
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "relay.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+int
+main(int argc, const char** argv)
+{
+	RelaySettings settings;
+	if (argc < 2)
+	{
+		std::cout << "usage: relay <server ip> [server port = " << settings.upstreamPort << "] [listen port = " << settings.listenPort
+			<< "] [delay ms = 0] [compression = 0 (0 off, 1 range coder, 2 dictionary)]\n";
+		return 1;
+	}
+	settings.upstreamHost = argv[1];
+	if (argc > 2) settings.upstreamPort = uint16_t(std::atoi(argv[2]));
+	if (argc > 3) settings.listenPort = uint16_t(std::atoi(argv[3]));
+	if (argc > 4) settings.delayMs = uint32_t(std::max(0, std::atoi(argv[4])));
+	if (argc > 5) settings.compression = CompressionMode(std::clamp(std::atoi(argv[5]), int(CompressionMode_Off), int(CompressionMode_Dictionary)));
+
+	SpectatorRelay relay;
+	if (!relay.Start(settings))
+		return 1;
+
+	while (true)
+		relay.Service(5);
+}
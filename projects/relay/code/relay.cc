@@ -0,0 +1,336 @@
+//------------------------------------------------------------------------------
+// relay.cc
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "relay.h"
+#include "network/timer.h"
+
+#include <iostream>
+
+bool SpectatorRelay::Start(const RelaySettings& relaySettings)
+{
+	settings = relaySettings;
+
+	ENetAddress address;
+	address.host = ENET_HOST_ANY;
+	address.port = settings.listenPort;
+	downstream = enet_host_create(&address, settings.maxSpectators, BitPack::ChannelCount, 0, 0);
+	upstreamHost = enet_host_create(nullptr, 1, 1, 0, 0);
+	if (downstream == nullptr || upstreamHost == nullptr)
+	{
+		std::cout << "RELAY: Failed to create ENet hosts (port " << settings.listenPort << ")\n";
+		Stop();
+		return false;
+	}
+	net_instance.SetCompression(downstream, settings.compression);
+	net_instance.EnableDecompression(upstreamHost);
+
+	ConnectUpstream();
+	std::cout << "RELAY: Listening for spectators on port " << settings.listenPort << " (delay " << settings.delayMs << "ms)\n";
+	return true;
+}
+
+void SpectatorRelay::Stop()
+{
+	if (upstream != nullptr)
+	{
+		enet_peer_disconnect_now(upstream, 0);
+		upstream = nullptr;
+	}
+	for (ENetHost** host : { &downstream, &upstreamHost })
+	{
+		if (*host == nullptr) continue;
+		net_instance.ForgetHost(*host);
+		enet_host_destroy(*host);
+		*host = nullptr;
+	}
+	spectators.clear();
+	congested.clear();
+	delayed.clear();
+	players.clear();
+	lasers.clear();
+	subscribed = false;
+}
+
+void SpectatorRelay::Service(uint32_t timeoutMs)
+{
+	if (downstream == nullptr) return;
+
+	if (upstream == nullptr && Time::Now() >= nextConnectAttempt)
+		ConnectUpstream();
+
+	//UPSTREAM (server or the next relay up the chain)
+	ENetEvent event;
+	while (enet_host_service(upstreamHost, &event, 0) > 0)
+	{
+		switch (event.type)
+		{
+			case ENET_EVENT_TYPE_CONNECT:
+				std::cout << "RELAY: Connected upstream, waiting for the subscription\n";
+				break;
+
+			case ENET_EVENT_TYPE_RECEIVE:
+				OnUpstreamPacket(event.packet->data, event.packet->dataLength);
+				enet_packet_destroy(event.packet);
+				break;
+
+			case ENET_EVENT_TYPE_DISCONNECT:
+				std::cout << "RELAY: Lost upstream (" << (subscribed ? "was subscribed" : "refused or unreachable") << ")\n";
+				upstream = nullptr;
+				subscribed = false;
+				nextConnectAttempt = Time::Now() + reconnectDelay;
+				ClearWorld();
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	ReleaseDelayed();
+	MonitorSpectators();
+
+	//SPECTATORS (game clients or relays further down)
+	int result = enet_host_service(downstream, &event, timeoutMs);
+	while (result > 0)
+	{
+		switch (event.type)
+		{
+			case ENET_EVENT_TYPE_CONNECT:
+				OnSpectatorConnect(event.peer);
+				break;
+
+			case ENET_EVENT_TYPE_RECEIVE:
+				if (event.channelID == 0)
+					OnSpectatorPacket(event.peer, event.packet->data, event.packet->dataLength);
+				enet_packet_destroy(event.packet);
+				break;
+
+			case ENET_EVENT_TYPE_DISCONNECT:
+				spectators.erase(event.peer);
+				congested.erase(event.peer);
+				net_instance.ForgetPeer(event.peer);
+				break;
+
+			default:
+				break;
+		}
+		result = enet_host_service(downstream, &event, 0);
+	}
+}
+
+void SpectatorRelay::ConnectUpstream()
+{
+	ENetAddress address;
+	enet_address_set_host(&address, settings.upstreamHost.c_str());
+	address.port = settings.upstreamPort;
+	upstream = enet_host_connect(upstreamHost, &address, 1, SpectatorConnectData);
+	nextConnectAttempt = Time::Now() + reconnectDelay;
+	if (upstream == nullptr)
+		std::cout << "RELAY: Could not start a connection to " << settings.upstreamHost << ":" << settings.upstreamPort << "\n";
+}
+
+void SpectatorRelay::OnUpstreamPacket(const uint8_t* data, size_t size)
+{
+	if (Compression::IsCompressed(data, size))
+	{
+		if (!net_instance.Decompress(data, size, decompressBuffer)) return;
+		data = decompressBuffer.data();
+		size = decompressBuffer.size();
+	}
+	Verifier verifier(data, size);
+	if (!VerifyPacketWrapperBuffer(verifier)) return;
+
+	//The subscription itself is ours, every spectator gets its own ClientConnectS2C
+	const PacketWrapper* wrapper = GetPacketWrapper(data);
+	if (wrapper->packet_type() == PacketType_ClientConnectS2C)
+	{
+		syncTick = wrapper->packet_as_ClientConnectS2C()->time();
+		syncTime = Time::Now();
+		subscribed = true;
+		net_instance.SendToServer(upstream, packet::ClientHelloC2S(NetworkManager::Compressor().DictionaryID()));
+		std::cout << "RELAY: Subscribed to the spectator stream\n";
+
+		//Waiting spectators get their first clock, the others a new one (a renewed subscription may be a restarted server)
+		//The world cache is empty here, it reaches everyone through the stream that follows
+		for (ENetPeer* peer : spectators)
+			SendConnect(peer);
+		return;
+	}
+
+	DelayedPayload entry;
+	entry.releaseTime = Time::Now() + settings.delayMs;
+	entry.payload.assign(data, data + size);
+	delayed.push_back(std::move(entry));
+}
+
+void SpectatorRelay::ReleaseDelayed()
+{
+	const uint64_t now = Time::Now();
+	while (!delayed.empty() && delayed.front().releaseTime <= now)
+	{
+		Release(delayed.front().payload);
+		delayed.pop_front();
+	}
+}
+
+void SpectatorRelay::Release(const std::vector<uint8_t>& payload)
+{
+	const PacketWrapper* wrapper = GetPacketWrapper(payload.data());
+	PacketPriority priority = PacketPriority_Normal;
+
+	switch (wrapper->packet_type())
+	{
+		case PacketType_GameStateS2C: {
+			const auto gameState = wrapper->packet_as_GameStateS2C();
+			if (gameState->players()) for (const Player* player : *gameState->players())
+				players[player->uuid()] = *player;
+			if (gameState->lasers()) for (const Laser* laser : *gameState->lasers())
+				lasers[laser->uuid()] = *laser;
+			break;
+		}
+		case PacketType_SpawnPlayerS2C: {
+			const Player* player = wrapper->packet_as_SpawnPlayerS2C()->player();
+			if (player) players[player->uuid()] = *player;
+			break;
+		}
+		case PacketType_UpdatePlayerS2C: {
+			const Player* player = wrapper->packet_as_UpdatePlayerS2C()->player();
+			if (player && players.contains(player->uuid())) players[player->uuid()] = *player;
+			break;
+		}
+		case PacketType_TeleportPlayerS2C: {
+			const Player* player = wrapper->packet_as_TeleportPlayerS2C()->player();
+			if (player && players.contains(player->uuid())) players[player->uuid()] = *player;
+			break;
+		}
+		case PacketType_DespawnPlayerS2C:
+			players.erase(wrapper->packet_as_DespawnPlayerS2C()->uuid());
+			break;
+		case PacketType_SpawnLaserS2C: {
+			const Laser* laser = wrapper->packet_as_SpawnLaserS2C()->laser();
+			if (laser) lasers[laser->uuid()] = *laser;
+			priority = PacketPriority_Low; //Same as the server, short lived and cosmetic
+			break;
+		}
+		case PacketType_DespawnLaserS2C:
+			lasers.erase(wrapper->packet_as_DespawnLaserS2C()->uuid());
+			break;
+		default:
+			break;
+	}
+
+	net_instance.BroadcastOnHost(downstream, payload.data(), payload.size(), priority);
+}
+
+void SpectatorRelay::OnSpectatorConnect(ENetPeer* peer)
+{
+	spectators.insert(peer);
+	if (!subscribed)
+	{
+		//Without a subscription there is no server tick to hand out, the subscription sends it
+		std::cout << "RELAY: Spectator joined, waiting for the subscription (" << spectators.size() << " watching)\n";
+		return;
+	}
+
+	SendConnect(peer);
+	SendWorld(peer);
+	std::cout << "RELAY: Spectator joined (" << spectators.size() << " watching)\n";
+}
+
+void SpectatorRelay::SendConnect(ENetPeer* peer)
+{
+	//Player id 0: the client has no ship of its own, the stream tick already includes the delay
+	auto fbb = packet::ClienConnectsS2C(0, StreamTick());
+	net_instance.SendPacket(peer, 0, fbb.GetBufferPointer(), fbb.GetSize());
+}
+
+void SpectatorRelay::OnSpectatorPacket(ENetPeer* peer, const uint8_t* data, size_t size)
+{
+	Verifier verifier(data, size);
+	if (!VerifyPacketWrapperBuffer(verifier)) return;
+
+	//Inputs of spectating game clients are ignored, only the dictionary they can decode matters
+	const PacketWrapper* wrapper = GetPacketWrapper(data);
+	if (wrapper->packet_type() == PacketType_ClientHelloC2S)
+		net_instance.SetPeerDictionary(peer, wrapper->packet_as_ClientHelloC2S()->dictionary_id());
+}
+
+void SpectatorRelay::SendWorld(ENetPeer* peer)
+{
+	//Small chunks like the servers join stream, the spectator skips entities a later chunk or spawn repeats
+	std::vector<Player> playerChunk;
+	std::vector<Laser> laserChunk;
+	auto flush = [&]()
+	{
+		if (playerChunk.empty() && laserChunk.empty()) return;
+		auto fbb = packet::GameStateS2C(playerChunk, laserChunk);
+		net_instance.SendPacket(peer, 0, fbb.GetBufferPointer(), fbb.GetSize());
+		playerChunk.clear();
+		laserChunk.clear();
+	};
+	for (const auto& [id, player] : players)
+	{
+		playerChunk.push_back(player);
+		if (playerChunk.size() == joinChunk) flush();
+	}
+	flush();
+	for (const auto& [id, laser] : lasers)
+	{
+		laserChunk.push_back(laser);
+		if (laserChunk.size() == joinChunk) flush();
+	}
+	flush();
+}
+
+void SpectatorRelay::ClearWorld()
+{
+	//The next subscription streams the world again
+	for (const auto& [id, player] : players)
+	{
+		auto fbb = packet::DespawnPlayerS2C(id);
+		net_instance.BroadcastOnHost(downstream, fbb.GetBufferPointer(), fbb.GetSize(), PacketPriority_Normal);
+	}
+	for (const auto& [id, laser] : lasers)
+	{
+		auto fbb = packet::DespawnLaserS2C(id);
+		net_instance.BroadcastOnHost(downstream, fbb.GetBufferPointer(), fbb.GetSize(), PacketPriority_Normal);
+	}
+	players.clear();
+	lasers.clear();
+	delayed.clear();
+}
+
+void SpectatorRelay::MonitorSpectators()
+{
+	std::vector<ENetPeer*> overloaded;
+	for (ENetPeer* peer : spectators)
+	{
+		const size_t bytes = NetworkManager::OutstandingBytes(peer, backlogHard);
+		const bool isCongested = bytes > backlogSoft || (congested.contains(peer) && bytes > backlogSoft / 2);
+		if (isCongested != congested.contains(peer))
+		{
+			if (isCongested) congested.insert(peer); else congested.erase(peer);
+			net_instance.SetPeerCongested(peer, isCongested);
+		}
+		if (bytes > backlogHard)
+			overloaded.push_back(peer);
+	}
+
+	//A spectator this far behind would only ever show an old world, it can reconnect and get the cache
+	for (ENetPeer* peer : overloaded)
+	{
+		std::cout << "RELAY: Spectator stayed above " << backlogHard << " outstanding bytes, dropping it\n";
+		enet_peer_disconnect_now(peer, 0);
+		spectators.erase(peer);
+		congested.erase(peer);
+		net_instance.ForgetPeer(peer);
+	}
+}
+
+uint32_t SpectatorRelay::StreamTick() const
+{
+	const int64_t elapsedMs = int64_t(Time::Now() - syncTime) - int64_t(settings.delayMs);
+	return syncTick + uint32_t(int32_t(double(elapsedMs) / Tick::Ms));
+}
@@ -0,0 +1,79 @@
+#pragma once
+//------------------------------------------------------------------------------
+// relay.h
+// Spectator relay: subscribes to a game server (or another relay) as one peer
+// and fans the spectator stream out to any number of spectators
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "network/network.h"
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+struct RelaySettings
+{
+	std::string upstreamHost = "127.0.0.1";
+	uint16_t upstreamPort = 1234;
+	uint16_t listenPort = 1240;
+	size_t maxSpectators = 256;
+	uint32_t delayMs = 0; //Stream is held back this long before it goes out (casters, anti ghosting)
+	CompressionMode compression = CompressionMode_Off; //Towards the spectators, upstream follows the servers sv_compression
+};
+
+/*
+* SPECTATOR RELAY
+*	- THE SERVER SEES ONE PEER (SpectatorConnectData) AND STREAMS IT THE WORLD LIKE A PLAYER WITHOUT A SHIP
+*	- EVERY PAYLOAD IS FORWARDED AS IS, A WORLD CACHE (PLAYERS / LASERS AS RELEASED) IS KEPT FOR LATE JOINERS
+*	- SPECTATORS ARE ORDINARY GAME CLIENTS (PLAYER ID 0), A RELAY CAN SUBSCRIBE TO ANOTHER RELAY (CHAINS)
+*	- NO CLOCK WITHOUT A SUBSCRIPTION: SPECTATORS JOINING BEFORE IT WAIT, EVERY (RENEWED) SUBSCRIPTION RESYNCS ALL OF THEM
+*/
+class SpectatorRelay
+{
+public:
+	bool Start(const RelaySettings& settings);
+	void Stop();
+	void Service(uint32_t timeoutMs); //One pass: upstream, delayed stream, spectators
+	size_t SpectatorCount() const { return spectators.size(); }
+
+private:
+	void ConnectUpstream();
+	void OnUpstreamPacket(const uint8_t* data, size_t size);
+	void ReleaseDelayed();
+	void Release(const std::vector<uint8_t>& payload); //Updates the world cache and fans the payload out
+	void OnSpectatorConnect(ENetPeer* peer);
+	void SendConnect(ENetPeer* peer); //ClientConnectS2C carrying the stream tick, only valid while subscribed
+	void OnSpectatorPacket(ENetPeer* peer, const uint8_t* data, size_t size);
+	void SendWorld(ENetPeer* peer);
+	void ClearWorld(); //Upstream lost, spectators drop everything they were shown
+	void MonitorSpectators(); //Same backpressure as the server (see GameServer::MonitorBacklogs)
+	uint32_t StreamTick() const; //Server tick of the payloads going out now
+
+	RelaySettings settings;
+	ENetHost* upstreamHost = nullptr;
+	ENetPeer* upstream = nullptr;
+	ENetHost* downstream = nullptr;
+	bool subscribed = false;
+	uint64_t nextConnectAttempt = 0;
+	uint32_t syncTick = 0; //server tick in the ClientConnectS2C of the subscription
+	uint64_t syncTime = 0; //local time (ms) it arrived
+
+	struct DelayedPayload
+	{
+		uint64_t releaseTime = 0;
+		std::vector<uint8_t> payload;
+	};
+	std::deque<DelayedPayload> delayed;
+	std::vector<uint8_t> decompressBuffer;
+
+	std::unordered_map<uint32_t, Player> players;
+	std::unordered_map<uint32_t, Laser> lasers;
+	std::unordered_set<ENetPeer*> spectators;
+	std::unordered_set<ENetPeer*> congested;
+
+	static constexpr uint64_t reconnectDelay = 2000; //ms between subscription attempts
+	static constexpr size_t joinChunk = 16; //Entities per GameStateS2C sent to a late joiner
+	static constexpr size_t backlogSoft = 32768; //Outstanding bytes, same defaults as sv_backlog_soft / sv_backlog_hard
+	static constexpr size_t backlogHard = 262144;
+};
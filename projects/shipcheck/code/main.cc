@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------------
+// main.cc
+// Feeds one input stream through the server ship (ServerSpaceship::Update) and through the
+// client prediction (ClientSpaceship::Predict) and fails on the first tick where position,
+// orientation or velocity differ by a single bit
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "spaceship.h"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+//A minute of play: every key combination the input bitmap can hold, each kept for 1 to 40 ticks
+static std::vector<uint16_t> RecordInput(size_t ticks)
+{
+	std::vector<uint16_t> stream;
+	uint32_t state = 0x9E3779B9;
+	while (stream.size() < ticks)
+	{
+		state = state * 1664525u + 1013904223u;
+		const uint16_t bitmap = uint16_t((state >> 8) & 0x017F); //Movement bits 0-6 and boost (8), fire (7) does not steer
+		const size_t hold = 1 + (state >> 26) % 40;
+		for (size_t i = 0; i < hold && stream.size() < ticks; i++)
+			stream.push_back(bitmap);
+	}
+	return stream;
+}
+
+int
+main()
+{
+	const std::vector<uint16_t> stream = RecordInput(3600);
+
+	Game::ServerSpaceship server(1);
+	Game::ClientSpaceship client(1);
+	server.position = client.position = glm::vec3(12.5f, -3.0f, 40.25f);
+	server.orientation = client.orientation = glm::normalize(glm::quat(0.9f, 0.1f, -0.3f, 0.2f));
+
+	for (size_t tick = 0; tick < stream.size(); tick++)
+	{
+		//What GameServer::ApplyInput does with an InputC2S, then the fixed server tick
+		server.lastInputBitmap = stream[tick];
+		server.inputCooldown = 0;
+		server.Update(SHIP_FIXED_DT);
+
+		//What the client does with the same input in UpdateLocally
+		client.inputState.bitmap = stream[tick];
+		client.Predict(SHIP_FIXED_DT);
+
+		const bool position = memcmp(&server.position, &client.position, sizeof(glm::vec3)) == 0;
+		const bool orientation = memcmp(&server.orientation, &client.orientation, sizeof(glm::quat)) == 0;
+		const bool velocity = memcmp(&server.linearVelocity, &client.linearVelocity, sizeof(glm::vec3)) == 0;
+		if (!position || !orientation || !velocity)
+		{
+			std::cout << "SHIPCHECK: Prediction diverged at tick " << tick << " (input " << stream[tick] << "):"
+				<< (position ? "" : " position") << (orientation ? "" : " orientation") << (velocity ? "" : " velocity") << "\n";
+			return 1;
+		}
+	}
+
+	std::cout << "SHIPCHECK: " << stream.size() << " ticks, prediction matches the server bit for bit (final position "
+		<< server.position.x << ", " << server.position.y << ", " << server.position.z << ")\n";
+	return 0;
+}
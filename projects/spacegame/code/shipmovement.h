@@ -0,0 +1,90 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    Ship movement kernel
+
+    Shared by the server simulation, the client prediction and anything else
+    that drives a ship. Keep every float operation in here so both sides step
+    the exact same math for the same input stream.
+
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <vec3.hpp>
+#include "gtc/quaternion.hpp"
+
+//Fixed simulation step of the server (60 ticks / s), client prediction steps with it too
+#define SHIP_FIXED_DT 0.01667f
+
+namespace Game
+{
+
+// ==========================
+// Ship tuning
+// ==========================
+struct ShipTuning
+{
+    float normalSpeed = 1.0f;
+    float boostSpeed = 2.0f;
+    float velocityScale = 10.0f; //speed -> units / s
+    float accelerationFactor = 1.0f;
+    float rotationSpeed = 1.8f;
+    float rotationSmoothFactor = 10.0f;
+};
+
+// ==========================
+// Ship input (decoded input bitmap)
+// ==========================
+struct ShipInput
+{
+    bool forward = false;
+    bool boost = false;
+    float rotX = 0.0f, rotY = 0.0f, rotZ = 0.0f;
+
+    //Same bit layout as the one sent in InputC2S
+    static ShipInput FromBitmap(uint16_t bitmap)
+    {
+        ShipInput input;
+        input.forward = bitmap & (1 << 0);
+        input.boost = bitmap & (1 << 8);
+        input.rotX = (bitmap & (1 << 6)) ? -1.0f : (bitmap & (1 << 5)) ? 1.0f : 0.0f;
+        input.rotY = (bitmap & (1 << 4)) ? -1.0f : (bitmap & (1 << 3)) ? 1.0f : 0.0f;
+        input.rotZ = (bitmap & (1 << 1)) ? -1.0f : (bitmap & (1 << 2)) ? 1.0f : 0.0f;
+        return input;
+    }
+};
+
+//------------------------------------------------------------------------------
+/**
+    Integrates one step of ship movement.
+    SHIP_T needs position, orientation, linearVelocity, currentSpeed and rotXSmooth/rotYSmooth/rotZSmooth.
+*/
+template<typename SHIP_T>
+inline void
+IntegrateShip(SHIP_T& ship, const ShipInput& input, const ShipTuning& tuning, float dt)
+{
+    if (input.forward)
+        ship.currentSpeed = input.boost ? tuning.boostSpeed : tuning.normalSpeed;
+    else
+        ship.currentSpeed = 0.0f;
+
+    //Apply acceleration to velocity
+    glm::vec3 desiredVelocity = glm::vec3(0.0f, 0.0f, ship.currentSpeed * tuning.velocityScale);
+    desiredVelocity = ship.orientation * desiredVelocity; // Apply orientation to movement
+    ship.linearVelocity = glm::mix(ship.linearVelocity, desiredVelocity, dt * tuning.accelerationFactor);
+
+    //Update position
+    ship.position += ship.linearVelocity * dt;
+
+    //update rotation quat
+    const float rotationSpeed = tuning.rotationSpeed * dt;
+    ship.rotXSmooth = glm::mix(ship.rotXSmooth, input.rotX * rotationSpeed, dt * tuning.rotationSmoothFactor);
+    ship.rotYSmooth = glm::mix(ship.rotYSmooth, input.rotY * rotationSpeed, dt * tuning.rotationSmoothFactor);
+    ship.rotZSmooth = glm::mix(ship.rotZSmooth, input.rotZ * rotationSpeed, dt * tuning.rotationSmoothFactor);
+
+    const glm::quat localRotation = glm::quat(glm::vec3(-ship.rotYSmooth, ship.rotXSmooth, ship.rotZSmooth));
+    ship.orientation = glm::normalize(ship.orientation * localRotation);
+}
+
+} // namespace Game
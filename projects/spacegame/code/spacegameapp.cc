@@ -12,6 +12,7 @@
 #include "render/model.h"
 #include "render/cameramanager.h"
 #include "render/lightserver.h"
+#include "render/projectiles.h"
 #include "input/inputserver.h"
 
 #include <vector>
@@ -153,6 +154,7 @@ SpaceGameApp::Run()
     
     //INITALIZE THE LASER MODEL
     const ModelId laserMOD = LoadModel("assets/space/laser.glb");
+    ProjectileRenderer::Instance()->SetModel(laserMOD); //Every laser in one instanced draw, moved by the GPU
 
     float dt = 0.01667f; //frameTime
    // constexpr double targetFrameTime = 1.0f / 240.0f; // 60FPS
@@ -164,6 +166,8 @@ SpaceGameApp::Run()
 
       //  gameServer.Run();
         gameClient.Update();
+        gameClient.UpdatePlayback(dt);
+        const float simDt = gameClient.Playing() ? dt * gameClient.PlaybackRate() : dt; //Demos run at their own speed
     
 		glClear(GL_DEPTH_BUFFER_BIT);
 		glEnable(GL_DEPTH_TEST);
@@ -187,41 +191,41 @@ SpaceGameApp::Run()
         }
 
 
+        //Other players: interpolation only, one pass over a dense list
+        gameClient.UpdateRemoteShips(simDt);
+
         for(auto& ship : gameClient.spaceships)
         {
             //Make sure only apply camera, client prediction for this controlled client 
             if (ship.first == gameClient.myPlayerID)
             {
-                //update this current user controlled avatar
-                ship.second.ProcessInput(); //Handle input for local player
-                if (ship.second.inputState.bitmap != 0) //might  need to reroute this before using
-                    gameClient.SendInput(packet::InputC2S(ship.second.inputState.timeSet, ship.second.inputState.bitmap));
-                ship.second.UpdateLocally(dt); //Predict movement
+                //update this current user controlled avatar (a demo only follows the recorded player)
+                if (!gameClient.Playing())
+                {
+                    ship.second.ProcessInput(); //Handle input for local player
+                    uint32_t shotSeq = 0;
+                    if (ship.second.inputState.fire)
+                        shotSeq = gameClient.SpawnPredictedLaser(ship.second); //Visible now, reconciled by the SpawnLaserS2C echo
+                    if (ship.second.inputState.bitmap != 0) //might  need to reroute this before using
+                        gameClient.SendInput(ship.second.inputState.bitmap, shotSeq);
+                }
+                ship.second.UpdateLocally(simDt); //Predict movement
                 ship.second.UpdateCamera(dt); // only update the local player's camera
             }
-
-            else
-            {
-                //update the other connected users movements
-                ship.second.UpdateLocally(dt);
-            }
             RenderDevice::Draw(ship.second.model, ship.second.transform);
         }
 
-        for(auto& [id,laser] : gameClient.lasers)
-        {
-            glm::vec3 forward = laser.orientation * glm::vec3(0.0f, 0.0f, 1.0f); // or whatever your forward is
-
-            laser.updateLaserVisual(dt);
-            Debug::DrawLine(laser.position, laser.position + forward * 2.0f, 2.0f, glm::vec4(0, 0, 1, 1), glm::vec4(0, 0, 1, 1));
-            RenderDevice::Draw(laserMOD, laser.transform);
-        }
+        //Lasers are placed on the GPU from their flight path, only the clock is handed over (virtual during demos)
+        float tickFraction = 0.0f;
+        const uint32_t serverTick = gameClient.ServerTick(&tickFraction);
+        ProjectileRenderer::Instance()->SetTime(serverTick, tickFraction);
        
         // Execute the entire rendering pipeline
         RenderDevice::Render(this->window, dt);
 
 		// transfer new frame to window
 		this->window->SwapBuffers();
+        gameClient.OnFramePresented();
 
         auto timeEnd = std::chrono::steady_clock::now();
         dt = std::min(0.04f, std::chrono::duration<float>(timeEnd - timeStart).count());
@@ -276,11 +280,27 @@ SpaceGameApp::RenderUI()
 
         static bool connected = false;
         static char text[10000];
+        static char demoPath[256] = "match.demo";
         ImGui::Begin("Network Control");
         ImGui::InputText("Server IP", ipAddress, sizeof(ipAddress));
+        ImGui::InputText("Demo file", demoPath, sizeof(demoPath));
 
-        if(!connected)
+        if (gameClient.Playing())
+        {
+            //Seek jumps to the keyframe before the target and fast applies the rest
+            float seconds = gameClient.PlaybackTime() / 1000.0f;
+            if (ImGui::SliderFloat("Time", &seconds, 0.0f, gameClient.PlaybackDuration() / 1000.0f, "%.1f s"))
+                gameClient.SeekPlayback(uint32_t(seconds * 1000.0f));
+            ImGui::SliderFloat("Speed", &gameClient.playbackSpeed, 0.25f, 16.0f, "%.2fx", ImGuiSliderFlags_Logarithmic);
+            ImGui::Checkbox("Pause", &gameClient.playbackPaused);
+            if (ImGui::Button("Stop demo"))
+                gameClient.StopPlayback();
+        }
+        else if(!connected)
         {
+            if (ImGui::Button("Play demo"))
+                gameClient.StartPlayback(demoPath);
+
             if (ImGui::Button("Host"))
             {
                 gameServer.StartServer(1234);
@@ -291,8 +311,8 @@ SpaceGameApp::RenderUI()
                     });
                 serverThread.detach();
 
-                gameClient.Create();
-                if (gameClient.ConnectToServer(ipAddress, 1234))
+                //Our own player talks to the server in process, remote players use ENet
+                if (gameClient.ConnectLoopback())
                 {
                     //On success
                     connected = true;
@@ -316,20 +336,63 @@ SpaceGameApp::RenderUI()
                 ImGui::DragFloat4("Ship orientation", &ship.second.orientation[0]);
             }
 
+            if (!gameClient.Recording() && ImGui::Button("Record demo"))
+                gameClient.StartRecording(demoPath);
+            else if (gameClient.Recording() && ImGui::Button("Stop recording"))
+                gameClient.StopRecording();
+
             if (ImGui::Button("Disconnect"))
             {
                 std::cout << "GAMEAPP: CLIENT SEND A DISCONNECT REQUEST TO THE SERVER TO HANDLE\n";
+                gameClient.StopRecording();
                 gameClient.DisconnectFromServer();
-                for(auto& [id,ships] :gameClient.spaceships)
-                {
-                    ships.RemoveSpaceship();
-                }
-                gameClient.spaceships.clear();
+                gameClient.ClearWorld();
                 connected = false;
                 
             }
 
             ImGui::Text("FPS: %.1f (Frame Time: %.3f ms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+
+            //Compression ratio and cost per message type (sv_compression on the host, decode cost on clients)
+            if (ImGui::CollapsingHeader("Compression"))
+            {
+                CompressionStats& stats = NetworkManager::Compressor().stats;
+                ImGui::Text("Dictionary id: %u", NetworkManager::Compressor().DictionaryID());
+                for (int i = 0; i < CompressionStats::Slots; i++)
+                {
+                    const CompressionStats::Entry& e = stats.entries[i];
+                    const uint64_t messages = e.messages, decompressed = e.decompressed;
+                    if (messages == 0 && decompressed == 0) continue;
+                    const char* name = i == CompressionStats::DatagramSlot ? "ENet datagrams" : EnumNamePacketType(PacketType(i));
+                    const uint64_t raw = e.rawBytes, compressed = e.compressedBytes;
+                    ImGui::Text("%-18s ratio %.2f  %llu -> %llu B  enc %.2f us  dec %.2f us", name,
+                        compressed ? double(raw) / double(compressed) : 1.0, (unsigned long long)raw, (unsigned long long)compressed,
+                        messages ? double(e.compressNs) / double(messages) / 1000.0 : 0.0,
+                        decompressed ? double(e.decompressNs) / double(decompressed) / 1000.0 : 0.0);
+                }
+                if (ImGui::Button("Reset compression stats"))
+                    stats.Reset();
+            }
+
+            //Input to server ack / server side delay / input to the first frame showing the acked state
+            if (ImGui::CollapsingHeader("Latency"))
+            {
+                InputLatency& latency = gameClient.latency;
+                const std::pair<const char*, const LatencyHistogram*> histograms[] = {
+                    { "Input to ack", &latency.inputToAck },
+                    { "Server delay", &latency.serverDelay },
+                    { "Input to screen", &latency.inputToScreen } };
+                for (const auto& [name, histogram] : histograms)
+                {
+                    ImGui::Text("%-16s n %llu  mean %.1f  p50 %.0f  p95 %.0f  p99 %.0f  max %.1f ms", name,
+                        (unsigned long long)histogram->samples, histogram->MeanMs(), histogram->PercentileMs(0.5),
+                        histogram->PercentileMs(0.95), histogram->PercentileMs(0.99), histogram->MaxMs());
+                    ImGui::PlotHistogram(name, [](void* data, int i) { return float(static_cast<const LatencyHistogram*>(data)->counts[i]); },
+                        (void*)histogram, 150, 0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 60)); //0 - 150ms
+                }
+                if (ImGui::Button("Reset latency stats"))
+                    latency.Reset();
+            }
         }
 
         ImGui::End();
@@ -3,8 +3,8 @@
 #include "input/inputserver.h"
 #include "render/cameramanager.h"
 #include "render/particlesystem.h"
+#include "render/projectiles.h"
 
-#include "../engine/network/timer.h"
 #include "network/network.h"
 #include <chrono>
 #include <gtx/string_cast.hpp>
@@ -19,28 +19,43 @@ namespace Game
 #pragma region Synchronization (snapshot interpolator)
     void SnapshotInterpolator::SetTarget(const SnapShotState& state)
     {
-        previous = target;
+        //Blend from what is currently shown, updates arrive irregularly (only when the server sees drift)
+        previous = interpolated;
         target = state;
         interpolationTimer = 0.0f; //Reset the timer
         extrapolatedTime = 0.0f;
+        targetAge = 0.0f;
+    }
+
+    void SnapshotInterpolator::Reset(const SnapShotState& state)
+    {
+        previous = target = interpolated = state;
+        interpolationTimer = interpolationDuration;
+        extrapolatedTime = 0.0f;
+        targetAge = 0.0f;
     }
 
     void SnapshotInterpolator::Update(float dt)
     {
+        //Dead reckon the target, the server uses the same model to decide when to send an update
+        targetAge += dt;
+        const glm::vec3 targetPosition = target.position + target.velocity * targetAge;
+
         if(interpolationTimer < interpolationDuration)
         {
-            float t = interpolationTimer / interpolationDuration;
-            interpolated.position = glm::mix(previous.position, target.position,t);
+            interpolationTimer += dt;
+            float t = std::min(interpolationTimer / interpolationDuration, 1.0f);
+            interpolated.position = glm::mix(previous.position, targetPosition, t);
             interpolated.orientation = glm::slerp(previous.orientation, target.orientation, t);
             interpolated.velocity = glm::mix(previous.velocity, target.velocity,t);
-
-            interpolationTimer += dt;
         }
         else 
         {
             //Dead reckoning after interpolation window
             extrapolatedTime += dt;
-            interpolated.position += interpolated.velocity * dt;
+            interpolated.position = targetPosition;
+            interpolated.orientation = target.orientation;
+            interpolated.velocity = target.velocity;
         }
 
         //OLD
@@ -62,6 +77,21 @@ namespace Game
 
 #pragma region Laser
 
+    void ClientLaser::Show() const
+    {
+        Render::ProjectileInstance instance;
+        instance.origin = origin;
+        instance.startTick = startTime;
+        instance.velocity = (orientation * glm::vec3(0.0f, 0.0f, 1.0f)) * LASER_SPEED * Tick::Seconds; //Same path as PositionAt
+        instance.endTick = endTime;
+        Render::ProjectileRenderer::Instance()->Set(uuid, instance);
+    }
+
+    void ClientLaser::Hide() const
+    {
+        Render::ProjectileRenderer::Instance()->Remove(uuid);
+    }
+
     void ServerLaser::Update(float dt)
     {
         //previousPosition = position;
@@ -172,19 +202,6 @@ namespace Game
         Keyboard* kbd = Input::GetDefaultKeyboard();
         this->inputState.ResetInputHistory();
 
-        inputState.moveForward = kbd->held[Key::W];
-        inputState.boost = kbd->held[Key::Shift];
-        inputState.fire = kbd->pressed[Key::Space];
-
-        inputState.rotX = kbd->held[Key::Left] ? 1.0f :
-                          kbd->held[Key::Right] ? -1.0f : 0.0f;
-
-        inputState.rotY = kbd->held[Key::Up] ? -1.0f :
-                          kbd->held[Key::Down] ? 1.0f : 0.0f;
-
-        inputState.rotZ = kbd->held[Key::A] ? -1.0f : 
-                          kbd->held[Key::D] ? 1.0f : 0.0f;
-
         //Input bitmap
         unsigned short bitmap = 0;
         bitmap |= (kbd->held[Key::W] ? 1 << 0 : 0);
@@ -197,8 +214,15 @@ namespace Game
         bitmap |= (kbd->pressed[Key::Space] ? 1 << 7 : 0);
         bitmap |= (kbd->held[Key::Shift] ? 1 << 8 : 0);
 
-        //Timestamp (UNIX epoc in ms)
-        inputState.timeSet = Time::Now();
+        //Decode through the same path as the server so prediction sees the exact same input
+        const ShipInput input = ShipInput::FromBitmap(bitmap);
+        inputState.moveForward = input.forward;
+        inputState.boost = input.boost;
+        inputState.fire = kbd->pressed[Key::Space];
+        inputState.rotX = input.rotX;
+        inputState.rotY = input.rotY;
+        inputState.rotZ = input.rotZ;
+
         inputState.bitmap = bitmap;
     }
 
@@ -213,33 +237,21 @@ namespace Game
                 vec3(this->transform[1]));
     }
 
-    void ClientSpaceship::UpdateLocally(float dt)
+    void ClientSpaceship::Predict(float dt)
     {
-        // predict input based movement
-        if (inputState.moveForward) {
-            float targetSpeed = inputState.boost ? boostSpeed : normalSpeed;
-            currentSpeed = glm::mix(normalSpeed, targetSpeed, dt * accelerationFactor);
-        }
-        else {
-            currentSpeed = glm::mix(currentSpeed, 0.0f, dt * accelerationFactor);
+        // predict input based movement (fixed steps, same kernel and step as the server)
+        const ShipInput input = ShipInput::FromBitmap(inputState.bitmap);
+        predictionAccumulator += dt;
+        while (predictionAccumulator >= SHIP_FIXED_DT)
+        {
+            IntegrateShip(*this, input, tuning, SHIP_FIXED_DT);
+            predictionAccumulator -= SHIP_FIXED_DT;
         }
+    }
 
-        //Compute the predicted velocity
-        glm::vec3 desiredVelocity = glm::vec3(0.0f, 0.0f, this->currentSpeed) * 10.0f;
-        desiredVelocity = orientation * desiredVelocity;
-        linearVelocity = glm::mix(linearVelocity, desiredVelocity, dt * accelerationFactor);
-
-        //Apply the predicted position from input
-        position += linearVelocity * dt;
-
-        //Apply rotation input
-        float rotationSpeed = 1.8f * dt;
-        rotXSmooth = glm::mix(rotXSmooth, inputState.rotX * rotationSpeed, dt * cameraSmoothFactor);
-        rotYSmooth = glm::mix(rotYSmooth, inputState.rotY * rotationSpeed, dt * cameraSmoothFactor);
-        rotZSmooth = glm::mix(rotZSmooth, inputState.rotZ * rotationSpeed, dt * cameraSmoothFactor);
-
-        glm::quat localRotation = glm::quat(glm::vec3(-rotYSmooth, rotXSmooth, rotZSmooth));
-        orientation = normalize(orientation * localRotation);
+    void ClientSpaceship::UpdateLocally(float dt)
+    {
+        Predict(dt);
 
         //interpolator for correction 
         interpolator.Update(dt);
@@ -262,7 +274,7 @@ namespace Game
         this->particleEmitterRight->data.origin = glm::vec4(vec3(this->position + (vec3(this->transform[0]) * thrusterPosOffset)) + (vec3(this->transform[2]) * emitterOffset), 1);
         this->particleEmitterRight->data.dir = glm::vec4(glm::vec3(-this->transform[2]), 0);
 
-        float t = (currentSpeed / this->normalSpeed);
+        float t = (currentSpeed / this->tuning.normalSpeed);
         this->particleEmitterLeft->data.startSpeed = 1.2 + (3.0f * t);
         this->particleEmitterLeft->data.endSpeed = 0.0f + (3.0f * t);
         this->particleEmitterRight->data.startSpeed = 1.2 + (3.0f * t);
@@ -273,13 +285,52 @@ namespace Game
        // Debug::DrawLine(position, position + fwd * 1.5f, 2, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), glm::vec4(0.0f, 1.0f, 0.0f, 1.0f)); // forward direction (green)
     }
 
-    void ClientSpaceship::CorrectFromServer(glm::vec3 newPos, glm::quat newOrient, glm::vec3 newVel, uint64_t timestamp)
+    void UpdateRemoteShips(ClientSpaceship* const* ships, size_t count, float dt)
+    {
+        //Pose straight from the interpolation buffer
+        for (size_t i = 0; i < count; i++)
+        {
+            ClientSpaceship& ship = *ships[i];
+            ship.interpolator.Update(dt);
+            ship.position = ship.interpolator.GetPosition();
+            ship.orientation = ship.interpolator.GetOrientation();
+            ship.linearVelocity = ship.interpolator.GetVelocity();
+        }
+
+        //Render state: rotation + translation written directly, thrusters sized by the replicated speed
+        const float thrusterPosOffset = 0.365f;
+        for (size_t i = 0; i < count; i++)
+        {
+            ClientSpaceship& ship = *ships[i];
+            ship.transform = glm::mat4_cast(ship.orientation);
+            ship.transform[3] = glm::vec4(ship.position, 1.0f);
+            if (ship.particleEmitterLeft == nullptr || ship.particleEmitterRight == nullptr) continue;
+
+            const glm::vec3 right = glm::vec3(ship.transform[0]);
+            const glm::vec3 forward = glm::vec3(ship.transform[2]);
+            const glm::vec4 dir = glm::vec4(-forward, 0);
+            const float t = glm::length(ship.linearVelocity) / (ship.tuning.normalSpeed * ship.tuning.velocityScale);
+            ship.particleEmitterLeft->data.origin = glm::vec4(ship.position - right * thrusterPosOffset + forward * ship.emitterOffset, 1);
+            ship.particleEmitterRight->data.origin = glm::vec4(ship.position + right * thrusterPosOffset + forward * ship.emitterOffset, 1);
+            ship.particleEmitterLeft->data.dir = dir;
+            ship.particleEmitterRight->data.dir = dir;
+            ship.particleEmitterLeft->data.startSpeed = ship.particleEmitterRight->data.startSpeed = 1.2f + (3.0f * t);
+            ship.particleEmitterLeft->data.endSpeed = ship.particleEmitterRight->data.endSpeed = 3.0f * t;
+        }
+    }
+
+    void ClientSpaceship::ResetInterpolation()
+    {
+        interpolator.Reset({ position, orientation, linearVelocity, 0 });
+    }
+
+    void ClientSpaceship::CorrectFromServer(glm::vec3 newPos, glm::quat newOrient, glm::vec3 newVel, uint32_t tick)
     {
         interpolator.SetTarget({
                     newPos,
                     newOrient,
                     newVel,
-                    timestamp
+                    tick
             });
     }
 #pragma endregion
@@ -297,37 +348,7 @@ namespace Game
             lastInputTimeStamp = 0;
         }
 
-        //Movement input
-        bool forward = lastInputBitmap & (1 << 0);
-        bool boost = lastInputBitmap & (1 << 8);
-
-        // Rotation input
-        float rotX = (lastInputBitmap & (1 << 6)) ? -1.0f : (lastInputBitmap & (1 << 5)) ? 1.0f : 0.0f;
-        float rotY = (lastInputBitmap & (1 << 4)) ? -1.0f : (lastInputBitmap & (1 << 3)) ? 1.0f : 0.0f;
-        float rotZ = (lastInputBitmap & (1 << 1)) ? -1.0f : (lastInputBitmap & (1 << 2)) ? 1.0f : 0.0f;
-
-        if (forward)
-            currentSpeed = boost ? boostSpeed : normalSpeed;
-        else
-            currentSpeed = 0;
-
-        //Apply acceleration to velocity
-        glm::vec3 desiredVelocity = glm::vec3(0, 0, currentSpeed * 10.0f);
-        desiredVelocity = orientation * desiredVelocity; // Apply orientation to movement
-        linearVelocity = glm::mix(linearVelocity, desiredVelocity, dt * accelerationFactor);
-
-        //Update position
-        position += linearVelocity * dt;
-
-        //update rotation quat
-        float rotationSpeed = 1.8f * dt;
-        const float smoothFactor = 10;
-        rotXSmooth = glm::mix(rotXSmooth, rotX * rotationSpeed, dt * smoothFactor);
-        rotYSmooth = glm::mix(rotYSmooth, rotY * rotationSpeed, dt * smoothFactor);
-        rotZSmooth = glm::mix(rotZSmooth, rotZ * rotationSpeed, dt * smoothFactor);
-
-        glm::quat localRotation = glm::quat(glm::vec3(-rotYSmooth, rotXSmooth, rotZSmooth));
-        orientation = normalize(orientation * localRotation);
+        IntegrateShip(*this, ShipInput::FromBitmap(lastInputBitmap), tuning, dt);
 
         //Update transformation matrix
         transform = glm::translate(position) * glm::mat4_cast(orientation) * glm::scale(glm::vec3(1.0f));
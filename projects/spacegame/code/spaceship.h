@@ -2,6 +2,8 @@
 #include "render/model.h"
 #include "physics/physics.h"
 #include "render/debugrender.h"
+#include "shipmovement.h"
+#include "network/timer.h"
 
 #include <iostream>
 #include <vec3.hpp>
@@ -9,6 +11,7 @@
 
 //Constant
 #define LASER_SPEED 25.0f
+#define LASER_LIFETIME_TICKS 150 //2.5s at the 60hz server tick
 
 namespace Render
 {
@@ -27,7 +30,7 @@ struct SnapShotState
     glm::vec3 position = glm::vec3(0.0f);
     glm::quat orientation = glm::identity<glm::quat>();
     glm::vec3 velocity = glm::vec3(0.0f);
-    uint64_t timestamp = 0; //Server time of snapshot
+    uint32_t tick = 0; //Server tick of the snapshot
 };
 
 class SnapshotInterpolator
@@ -38,6 +41,10 @@ public:
 
     //Call this when receiving a new server update
     void SetTarget(const SnapShotState& state);
+    //Snap to a state without blending (spawn / join)
+    void Reset(const SnapShotState& state);
+    //Blend window follows the servers snapshot interval for this client
+    void SetDuration(float duration) { if (duration > 0.0f) interpolationDuration = duration; }
     void Update(float dt);
 
     const glm::vec3& GetPosition() const { return interpolated.position; }
@@ -53,6 +60,7 @@ private:
     float interpolationDuration = 0.0833f;
     float interpolationTimer = 0.0f;
     float extrapolatedTime = 0.0f; //time since the interpolated ended
+    float targetAge = 0.0f; //time since the target was received (target is dead reckoned by this)
 };
 
 // ==========================
@@ -65,7 +73,6 @@ struct InputState
     bool fire = false;
     float rotX = 0.0f, rotY = 0.0f, rotZ = 0.0f;
 
-    uint64_t timeSet; //The time this was pressed and send
     unsigned short bitmap = 0;
     
     void ResetInputHistory()
@@ -107,10 +114,9 @@ struct ClientSpaceship
     float rotXSmooth = 0.0f; 
     float rotYSmooth = 0.0f; 
     float rotZSmooth = 0.0f;
+    float predictionAccumulator = 0.0f; //frame time not yet stepped by the fixed movement kernel
 
-    const float normalSpeed = 10.0f;
-    const float boostSpeed = normalSpeed * 2.0f;
-    const float accelerationFactor = 1.0f;
+    ShipTuning tuning;
     const float camOffsetY = 1.0f;
     const float cameraSmoothFactor = 10.0f;
     
@@ -122,9 +128,15 @@ struct ClientSpaceship
     void ProcessInput();  // Handles input from player
     void UpdateCamera(float dt);  // Updates camera position
     void UpdateLocally(float dt); // Handles local client prediction
-    void CorrectFromServer(glm::vec3 newPos, glm::quat newOrient, glm::vec3 newVel,uint64_t timestamp);  // Fixes desync
+    void Predict(float dt); // Steps the movement kernel with the current input (fixed SHIP_FIXED_DT steps, as the server)
+    void ResetInterpolation(); // Seeds the interpolator with the current state (spawn / join)
+    void CorrectFromServer(glm::vec3 newPos, glm::quat newOrient, glm::vec3 newVel, uint32_t tick);  // Fixes desync
 };
 
+//Other players ships: no prediction (they have no input here) and no blending, only the interpolator is sampled
+//and the render state (transform, thruster emitters) written. ships is a dense list, see GameClient::UpdateRemoteShips
+void UpdateRemoteShips(ClientSpaceship* const* ships, size_t count, float dt);
+
 // ==========================
 // Server Spaceship
 // ==========================
@@ -144,12 +156,10 @@ struct ServerSpaceship
     float rotYSmooth = 0;
     float rotZSmooth = 0;
 
-    float normalSpeed = 1.0f;
-    float boostSpeed = normalSpeed * 2.0f;
-    float accelerationFactor = 1.0f;
+    ShipTuning tuning;
 
     uint16_t lastInputBitmap = 0;
-    uint64_t lastInputTimeStamp = 0;
+    uint32_t lastInputTimeStamp = 0; //tick stamp of the last applied input (the clients server tick estimate), 0 = none
     float inputCooldown = 0;
 
     const glm::vec3 colliderEndPoints[8] = {
@@ -176,23 +186,25 @@ struct ServerSpaceship
 struct ClientLaser
 {
     uint32_t uuid;
-    uint64_t startTime;
-    uint64_t endTime;
+    uint32_t startTime; //server tick
+    uint32_t endTime;
 
-    glm::vec3 position;
+    glm::vec3 origin; //position at startTime
     glm::quat orientation = glm::identity<glm::quat>();
-    glm::mat4 transform = glm::identity<glm::mat4>();
 
-    //TESTING THE SYNC LASER (CLIENT - SERVER TIME ) //WORK WITH THIS LATER WHEN TRYING ONLINE 
-    uint64_t clientRecievedTime = 0;
-    uint64_t serverSentTime = 0;
-    float elapsedTime = 0; //THE TIME CALCULATED BETWEEN THEM ms to sec
+    uint32_t ownerID = 0;
+    uint32_t shotSeq = 0; //shooters sequence, matches a predicted laser with its SpawnLaserS2C
+    bool predicted = false; //spawned locally, not yet confirmed by the server
+
+    //Rendering: the flight path goes to the instanced projectile renderer once, the GPU moves it from there (keyed by uuid)
+    void Show() const;
+    void Hide() const;
 
-    void updateLaserVisual(float dt)
+    //Position along the flight path at the given server tick (fraction = part of the next tick already elapsed)
+    glm::vec3 PositionAt(uint32_t tick, float fraction = 0.0f) const
     {
-        glm::vec3 forward = orientation * glm::vec3(0.0f, 0.0f, 1.0f);
-        position = position + forward * LASER_SPEED * dt;
-        transform = glm::translate(position) * glm::mat4_cast(orientation);
+        const float elapsed = std::max(0.0f, (float(Tick::Diff(tick, startTime)) + fraction) * Tick::Seconds);
+        return origin + (orientation * glm::vec3(0.0f, 0.0f, 1.0f)) * LASER_SPEED * elapsed;
     }
 };
 
@@ -201,9 +213,10 @@ struct ServerLaser
     uint32_t uuid;
     uint32_t ownerID; 
 
-    uint64_t startTime; //epoc ms when spawned
-    uint64_t endTime; //epoc ms when it should despawn
+    uint32_t startTime; //server tick it was spawned
+    uint32_t endTime; //server tick it despawns
 
+    glm::vec3 origin; //position at startTime
     glm::vec3 position; //start position
     glm::vec3 previousPosition; 
     glm::quat orientation = glm::identity<glm::quat>(); //Direction as quaternion
@@ -213,7 +226,7 @@ struct ServerLaser
     void Update(float dt);
     std::optional<uint32_t> CheckCollision(const std::unordered_map<uint32_t, Physics::ColliderId>& playerColliders);
 
-    bool isExpired(uint64_t now) const { return now >= endTime; }
+    bool isExpired(uint32_t tick) const { return Tick::Reached(tick, endTime); }
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+//------------------------------------------------------------------------------
+// main.cc
+// Zone server
+// (zoneserver <zone id> <zone count> [base port] [zone size] [zone hosts], zone i listens on base port + i,
+//  clients join any zone and are handed to its neighbours as their ship flies across)
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "spaceship.h"
+#include "network/server.h"
+#include "core/cvar.h"
+
+#include <cstdlib>
+#include <iostream>
+
+int
+main(int argc, const char** argv)
+{
+	if (argc < 3)
+	{
+		std::cout << "usage: zoneserver <zone id> <zone count> [base port = 1234] [zone size = 200] [zone hosts = host:port,... (default consecutive local ports)]\n";
+		return 1;
+	}
+	const int zoneID = std::atoi(argv[1]);
+	const int basePort = argc > 3 ? std::atoi(argv[3]) : 1234;
+
+	//Read by StartServer, created here first so they start with our values
+	Core::CVarWriteInt(Core::CVarCreate(Core::CVar_Int, "sv_zone_id", "0"), zoneID);
+	Core::CVarWriteInt(Core::CVarCreate(Core::CVar_Int, "sv_zone_count", "1"), std::atoi(argv[2]));
+	if (argc > 4) Core::CVarWriteFloat(Core::CVarCreate(Core::CVar_Float, "sv_zone_size", "200"), float(std::atof(argv[4])));
+	if (argc > 5) Core::CVarWriteString(Core::CVarCreate(Core::CVar_String, "sv_zone_hosts", ""), argv[5]);
+
+	gameServer.StartServer(uint16_t(basePort + zoneID));
+	while (gameServer.live)
+		gameServer.Run();
+	gameServer.ShutdownServer();
+}